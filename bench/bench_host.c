@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_kernels.h"
+#include "led_strip_spi_encoder.h"
+#include "led_strip_spi_reference.h"
+
+// Все ядра замеряются по кругу BENCH_RUNS раз, каждый замер не короче BENCH_MIN_NS. В зачёт идёт самый быстрый
+// замер ядра: остальные сбиты планировщиком и соседними процессами, а помеха на один круг не задевает другие
+#define BENCH_RUNS 7
+#define BENCH_MIN_NS 20000000LL
+// Допустимое замедление ядра относительно базового замера, в процентах
+#define BENCH_TOLERANCE_PCT 25
+// Лента из 60 пикселей RGBW
+#define BENCH_STRIP_BYTES (60 * 4)
+
+static volatile int host_sink;
+static uint8_t strip_colors[BENCH_STRIP_BYTES];
+static uint8_t strip_buffer[BENCH_STRIP_BYTES * LED_STRIP_SPI_BYTES_PER_COLOR_BYTE];
+
+static int bench_strip_lut(void) {
+    led_strip_spi_encode(strip_buffer, strip_colors, BENCH_STRIP_BYTES);
+    host_sink = strip_buffer[0];
+    return BENCH_STRIP_BYTES;
+}
+
+static int bench_strip_bits(void) {
+    for (int i = 0; i < BENCH_STRIP_BYTES; ++i) {
+        reference_spi_bit(strip_colors[i], strip_buffer + i * LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+    }
+    host_sink = strip_buffer[0];
+    return BENCH_STRIP_BYTES;
+}
+
+// Ядра драйвера ленты: компонент led_strip не виден из main, поэтому их нет в общей таблице
+static const bench_kernel_t host_kernels[] = {
+    {"led_strip_spi_lut", bench_strip_lut},
+    {"led_strip_spi_bits", bench_strip_bits},
+};
+
+#define HOST_KERNELS (int)(sizeof(host_kernels) / sizeof(host_kernels[0]))
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Время одной операции в одном замере, bytes_per_s - в том же замере
+static double measure(const bench_kernel_t* kernel, double* bytes_per_s) {
+    long long iterations = 0;
+    long long bytes = 0;
+    const long long start = now_ns();
+    long long elapsed;
+    for (long long batch = 1;; batch *= 2) {
+        for (long long i = 0; i < batch; ++i) {
+            bytes += kernel->kernel();
+        }
+        iterations += batch;
+        if ((elapsed = now_ns() - start) >= BENCH_MIN_NS) {
+            break;
+        }
+    }
+    *bytes_per_s = bytes * 1e9 / elapsed;
+    return (double)elapsed / iterations;
+}
+
+static char* read_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = malloc(size + 1);
+    if (text) {
+        text[fread(text, 1, size, file)] = 0;
+    }
+    fclose(file);
+    return text;
+}
+
+// ns_per_op ядра name в JSON, записанном этой программой. 0 - ядра нет в базовом замере
+static double baseline_ns(const char* json, const char* name) {
+    char key[64];
+    snprintf(key, sizeof(key), "\"name\":\"%s\"", name);
+    const char* at = json ? strstr(json, key) : NULL;
+    if (!at) {
+        return 0;
+    }
+    at = strstr(at, "\"ns_per_op\":");
+    return at ? strtod(at + strlen("\"ns_per_op\":"), NULL) : 0;
+}
+
+// bench_host [--baseline <файл>] [--output <файл>] [--tolerance <проценты>]
+// Без --output JSON печатается в stdout. Код возврата 1 - есть ядро медленнее базового замера больше допуска
+int main(const int argc, char** argv) {
+    const char* baseline_path = NULL;
+    const char* output_path = NULL;
+    int tolerance_pct = BENCH_TOLERANCE_PCT;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance_pct = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Использование: %s [--baseline <файл>] [--output <файл>] [--tolerance <проценты>]\n", argv[0]);
+            return 2;
+        }
+    }
+    char* baseline = NULL;
+    if (baseline_path && !(baseline = read_file(baseline_path))) {
+        fprintf(stderr, "Не удалось прочитать базовый замер %s\n", baseline_path);
+        return 2;
+    }
+    FILE* output = output_path ? fopen(output_path, "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "Не удалось открыть %s\n", output_path);
+        return 2;
+    }
+
+    bench_prepare();
+    for (int i = 0; i < BENCH_STRIP_BYTES; ++i) {
+        strip_colors[i] = (uint8_t)(i * 71 + 5);
+    }
+
+    const int total = bench_kernel_count + HOST_KERNELS;
+    double best_ns[total];
+    double best_bytes_per_s[total];
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        for (int k = 0; k < total; ++k) {
+            const bench_kernel_t* kernel = k < bench_kernel_count ? &bench_kernels[k] : &host_kernels[k - bench_kernel_count];
+            double bytes_per_s;
+            const double ns_per_op = measure(kernel, &bytes_per_s);
+            if (run == 0 || ns_per_op < best_ns[k]) {
+                best_ns[k] = ns_per_op;
+                best_bytes_per_s[k] = bytes_per_s;
+            }
+        }
+    }
+
+    int pass = 1;
+    fprintf(output, "{\n  \"kernels\": [\n");
+    for (int k = 0; k < total; ++k) {
+        const char* name = k < bench_kernel_count ? bench_kernels[k].name : host_kernels[k - bench_kernel_count].name;
+        const double base = baseline_ns(baseline, name);
+        const int regressed = base > 0 && best_ns[k] > base * (100 + tolerance_pct) / 100;
+        pass &= !regressed;
+        fprintf(output, "    {\"name\":\"%s\",\"ns_per_op\":%.1f,\"bytes_per_s\":%.0f", name, best_ns[k], best_bytes_per_s[k]);
+        if (baseline) {
+            fprintf(output, ",\"baseline_ns\":%.1f,\"regressed\":%s", base, regressed ? "true" : "false");
+        }
+        fprintf(output, "}%s\n", k + 1 < total ? "," : "");
+        if (regressed) {
+            fprintf(stderr, "%s: %.1f ns/op, baseline %.1f ns/op (+%d%% allowed)\n", name, best_ns[k], base, tolerance_pct);
+        }
+    }
+    // Итог сравнения есть только в отчёте, базовый замер хранит одни замеры
+    if (baseline) {
+        fprintf(output, "  ],\n  \"tolerance_pct\": %d,\n  \"pass\": %s\n}\n", tolerance_pct, pass ? "true" : "false");
+    } else {
+        fprintf(output, "  ]\n}\n");
+    }
+    if (output != stdout) {
+        fclose(output);
+    }
+    free(baseline);
+    return !pass;
+}
@@ -0,0 +1,266 @@
+#include "arq.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "utils.h"
+
+// Размер подтверждения: номер ожидаемого кадра в заголовке, 32-битная карта принятых кадров после него
+// и ступень скорости для следующих кадров
+#define ARQ_ACK_PAYLOAD 5
+
+// Состояние кадра в окне отправителя
+typedef struct {
+    bool acked;
+    bool sent;
+    bool pending;       // Требует (повторной) передачи
+    bool retransmitted; // Передавался больше одного раза - по нему RTT не измеряется (алгоритм Карна)
+    int retries;
+    int64_t sent_at;
+} arq_slot_t;
+
+// Состояние приёмника сохраняется между кадрами
+typedef struct {
+    bool valid;
+    int len;
+    uint8_t data[ARQ_MAX_PAYLOAD];
+} arq_rx_slot_t;
+
+static uint8_t tx_transfer = 0;
+static int rx_transfer = -1;
+static uint8_t rx_expected = 0;
+static arq_rx_slot_t rx_slots[ARQ_MAX_WINDOW];
+
+static int build_frame(
+    uint8_t* frame, const uint8_t type, const uint8_t flags, const uint8_t seq,
+    const uint8_t* payload, const int len
+) {
+    frame[0] = type;
+    frame[1] = flags;
+    frame[2] = seq;
+    frame[3] = len;
+    memcpy(frame + ARQ_HEADER_SIZE, payload, len);
+    const uint16_t crc = crc16_ccitt(frame, ARQ_HEADER_SIZE + len);
+    frame[ARQ_HEADER_SIZE + len] = crc >> 8;
+    frame[ARQ_HEADER_SIZE + len + 1] = crc & 0xFF;
+    return ARQ_HEADER_SIZE + len + ARQ_CRC_SIZE;
+}
+
+// Проверка длины и CRC принятого кадра
+static bool frame_valid(const uint8_t* frame, const int len) {
+    if (len < ARQ_HEADER_SIZE + ARQ_CRC_SIZE) {
+        return false;
+    }
+    const int payload = frame[3];
+    if (payload > ARQ_MAX_PAYLOAD || ARQ_HEADER_SIZE + payload + ARQ_CRC_SIZE > len) {
+        return false;
+    }
+    const uint16_t crc = crc16_ccitt(frame, ARQ_HEADER_SIZE + payload);
+    return frame[ARQ_HEADER_SIZE + payload] == (crc >> 8) && frame[ARQ_HEADER_SIZE + payload + 1] == (crc & 0xFF);
+}
+
+static int clamp_window(const int window) {
+    if (window < 1) return 1;
+    if (window > ARQ_MAX_WINDOW) return ARQ_MAX_WINDOW;
+    return window;
+}
+
+static int64_t clamp_rto(const arq_config_t* config, const int64_t rto) {
+    if (rto < config->min_rto_us) return config->min_rto_us;
+    if (rto > config->max_rto_us) return config->max_rto_us;
+    return rto;
+}
+
+int arq_send(
+    const arq_link_t* link, const arq_config_t* config,
+    const uint8_t* data, const int len, arq_stats_t* stats
+) {
+    const int window = clamp_window(config->window);
+    const int total = (len + ARQ_MAX_PAYLOAD - 1) / ARQ_MAX_PAYLOAD;
+    arq_slot_t slots[ARQ_MAX_WINDOW];
+    uint8_t frame[ARQ_MAX_FRAME];
+
+    memset(stats, 0, sizeof(*stats));
+    tx_transfer = (tx_transfer + (1 << ARQ_TRANSFER_SHIFT)) & ARQ_TRANSFER_MASK;
+    const int64_t start = link->now_us();
+    // Оценки RTT по RFC 6298, 0 - измерений ещё не было
+    int64_t srtt = 0;
+    int64_t rttvar = 0;
+    int64_t rto = clamp_rto(config, config->initial_rto_us);
+
+    int base = 0;        // Первый неподтверждённый кадр
+    int initialized = 0; // Кадры до этого индекса уже заняли слот окна
+    int result = 0;
+    while (base < total) {
+        for (; initialized < total && initialized < base + window; ++initialized) {
+            arq_slot_t* slot = &slots[initialized % ARQ_MAX_WINDOW];
+            memset(slot, 0, sizeof(*slot));
+            slot->pending = true;
+        }
+
+        // Пачка: все ожидающие передачи кадры окна, последний - с запросом подтверждения
+        int last = -1;
+        for (int i = base; i < initialized; ++i) {
+            if (slots[i % ARQ_MAX_WINDOW].pending) {
+                last = i;
+            }
+        }
+        for (int i = base; i <= last; ++i) {
+            arq_slot_t* slot = &slots[i % ARQ_MAX_WINDOW];
+            if (!slot->pending) {
+                continue;
+            }
+            const int offset = i * ARQ_MAX_PAYLOAD;
+            const int payload = len - offset < ARQ_MAX_PAYLOAD ? len - offset : ARQ_MAX_PAYLOAD;
+            const uint8_t flags = tx_transfer | (i == last ? ARQ_FLAG_POLL : 0);
+            const int frame_len = build_frame(frame, ARQ_TYPE_DATA, flags, i & 0xFF, data + offset, payload);
+            link->send(frame, frame_len);
+            if (slot->sent) {
+                slot->retransmitted = true;
+                ++stats->retransmissions;
+            }
+            slot->sent = true;
+            slot->sent_at = link->now_us();
+            slot->pending = false;
+            ++stats->frames_sent;
+        }
+        const int64_t poll_sent_at = slots[last % ARQ_MAX_WINDOW].sent_at;
+        const bool poll_retransmitted = slots[last % ARQ_MAX_WINDOW].retransmitted;
+
+        // Ожидание подтверждения на запрос
+        const int received = link->receive(frame, ARQ_MAX_FRAME, rto);
+        const bool ack_valid = received > 0 && frame_valid(frame, received) &&
+                               frame[0] == ARQ_TYPE_ACK && (frame[1] & ARQ_TRANSFER_MASK) == tx_transfer &&
+                               frame[3] == ARQ_ACK_PAYLOAD;
+        const int cumulative = ack_valid ? (frame[2] - base) & 0xFF : 0;
+        if (ack_valid && cumulative <= initialized - base) {
+            ++stats->acks;
+            if (!poll_retransmitted) {
+                const int64_t rtt = link->now_us() - poll_sent_at;
+                if (srtt == 0) {
+                    srtt = rtt;
+                    rttvar = rtt / 2;
+                } else {
+                    const int64_t delta = srtt > rtt ? srtt - rtt : rtt - srtt;
+                    rttvar = (3 * rttvar + delta) / 4;
+                    srtt = (7 * srtt + rtt) / 8;
+                }
+                rto = clamp_rto(config, srtt + 4 * rttvar);
+            }
+            const uint32_t sack = (uint32_t)frame[4] << 24 | (uint32_t)frame[5] << 16 |
+                                  (uint32_t)frame[6] << 8 | frame[7];
+            for (int i = base; i < initialized; ++i) {
+                const int after = i - (base + cumulative) - 1;
+                if (i < base + cumulative || (after >= 0 && after < 32 && (sack >> after) & 1)) {
+                    slots[i % ARQ_MAX_WINDOW].acked = true;
+                }
+            }
+            if (link->rate_apply && frame[8] != ARQ_RATE_KEEP) {
+                link->rate_apply(frame[8]);
+            }
+        } else {
+            ++stats->timeouts;
+            rto = clamp_rto(config, rto * 2);
+            // Подтверждения не слышно - возможно, стороны разошлись по скорости
+            if (link->rate_timeout) {
+                link->rate_timeout();
+            }
+        }
+
+        // Всё отправленное до запроса и не подтверждённое считается потерянным
+        for (int i = base; i < initialized; ++i) {
+            arq_slot_t* slot = &slots[i % ARQ_MAX_WINDOW];
+            if (!slot->acked && !slot->pending) {
+                slot->pending = true;
+                if (++slot->retries > config->max_retries) {
+                    result = -1;
+                }
+            }
+        }
+        if (result != 0) {
+            break;
+        }
+        while (base < initialized && slots[base % ARQ_MAX_WINDOW].acked) {
+            ++base;
+        }
+    }
+
+    stats->bytes = result == 0 ? len : (base * ARQ_MAX_PAYLOAD < len ? base * ARQ_MAX_PAYLOAD : len);
+    stats->elapsed_us = link->now_us() - start;
+    stats->srtt_us = srtt;
+    stats->rto_us = rto;
+    return result;
+}
+
+void arq_receiver_reset(void) {
+    rx_expected = 0;
+    memset(rx_slots, 0, sizeof(rx_slots));
+}
+
+static void send_ack(const arq_link_t* link, const int window, const uint8_t rate) {
+    // Бит i - принят кадр rx_expected + 1 + i
+    uint32_t sack = 0;
+    for (int i = 0; i < window - 1; ++i) {
+        if (rx_slots[(rx_expected + 1 + i) % ARQ_MAX_WINDOW].valid) {
+            sack |= 1u << i;
+        }
+    }
+    const uint8_t payload[ARQ_ACK_PAYLOAD] = {sack >> 24, sack >> 16, sack >> 8, sack, rate};
+    uint8_t frame[ARQ_HEADER_SIZE + ARQ_ACK_PAYLOAD + ARQ_CRC_SIZE];
+    const int len = build_frame(frame, ARQ_TYPE_ACK, rx_transfer, rx_expected, payload, ARQ_ACK_PAYLOAD);
+    link->send(frame, len);
+}
+
+int arq_receive_step(const arq_link_t* link, const arq_config_t* config, const int64_t timeout_us) {
+    const int window = clamp_window(config->window);
+    uint8_t frame[ARQ_MAX_FRAME];
+    const int received = link->receive(frame, ARQ_MAX_FRAME, timeout_us);
+    if (received < 0) {
+        return -1;
+    }
+    const bool valid = frame_valid(frame, received) && frame[0] == ARQ_TYPE_DATA;
+    if (link->rate_observe) {
+        link->rate_observe(valid);
+    }
+    if (!valid) {
+        return 0;
+    }
+
+    const uint8_t flags = frame[1];
+    if (rx_transfer != (flags & ARQ_TRANSFER_MASK)) {
+        // Новая передача: нумерация начинается заново
+        arq_receiver_reset();
+        rx_transfer = flags & ARQ_TRANSFER_MASK;
+    }
+
+    // Кадры вне окна - повторы уже выданных, их достаточно подтвердить
+    const uint8_t seq = frame[2];
+    const int offset = (uint8_t)(seq - rx_expected);
+    if (offset < window) {
+        arq_rx_slot_t* slot = &rx_slots[seq % ARQ_MAX_WINDOW];
+        if (!slot->valid) {
+            slot->valid = true;
+            slot->len = frame[3];
+            memcpy(slot->data, frame + ARQ_HEADER_SIZE, slot->len);
+        }
+    }
+
+    int delivered = 0;
+    while (rx_slots[rx_expected % ARQ_MAX_WINDOW].valid) {
+        arq_rx_slot_t* slot = &rx_slots[rx_expected % ARQ_MAX_WINDOW];
+        link->deliver(slot->data, slot->len);
+        delivered += slot->len;
+        slot->valid = false;
+        ++rx_expected;
+    }
+
+    if (flags & ARQ_FLAG_POLL) {
+        // Подтверждение уходит на текущей скорости, новая действует с кадров после него
+        const uint8_t rate = link->rate_advice ? link->rate_advice() : ARQ_RATE_KEEP;
+        send_ack(link, window, rate);
+        if (link->rate_apply && rate != ARQ_RATE_KEEP) {
+            link->rate_apply(rate);
+        }
+    }
+    return delivered;
+}
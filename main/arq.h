@@ -0,0 +1,80 @@
+#ifndef ARQ_H
+#define ARQ_H
+
+#include <stdint.h>
+
+// Максимальное окно (должно делить 256 и быть не больше ширины битовой карты подтверждений)
+#define ARQ_MAX_WINDOW 32
+// Максимальный размер полезной нагрузки одного кадра
+#define ARQ_MAX_PAYLOAD 64
+// Заголовок кадра: тип, флаги, номер, длина
+#define ARQ_HEADER_SIZE 4
+#define ARQ_CRC_SIZE 2
+#define ARQ_MAX_FRAME (ARQ_HEADER_SIZE + ARQ_MAX_PAYLOAD + ARQ_CRC_SIZE)
+
+#define ARQ_TYPE_DATA 'D'
+#define ARQ_TYPE_ACK 'A'
+
+// Запрос подтверждения: последний кадр пачки, после него отправитель слушает канал
+#define ARQ_FLAG_POLL 0x01
+// Номер передачи в старших семи битах флагов: растёт с каждым вызовом arq_send(), по его смене приёмник
+// узнаёт начало новой передачи. Одного бита мало: после двух подряд не дошедших передач номер совпадал
+// с последним увиденным, и первые кадры новой передачи подтверждались как повторы старой
+#define ARQ_TRANSFER_SHIFT 1
+#define ARQ_TRANSFER_MASK 0xFE
+
+// Ступень скорости в подтверждении: оставить текущую
+#define ARQ_RATE_KEEP 0xFF
+
+// Канал, по которому ходят кадры. В прошивке - оптический полудуплекс, но протокол от него не зависит
+typedef struct {
+    // Передача кадра целиком
+    void (*send)(const uint8_t* frame, int len);
+    // Приём кадра, -1 если за timeout_us ничего не пришло
+    int (*receive)(uint8_t* frame, int max_len, int64_t timeout_us);
+    // Монотонное время в микросекундах
+    int64_t (*now_us)(void);
+    // Выдача принятых по порядку данных
+    void (*deliver)(const uint8_t* data, int len);
+
+    // Адаптация скорости, необязательно (NULL - скорость постоянна)
+    // Приёмник: учёт каждого кадра, для которого найдена синхропоследовательность
+    void (*rate_observe)(int frame_valid);
+    // Приёмник: ступень скорости, которую подтверждение предлагает отправителю
+    uint8_t (*rate_advice)(void);
+    // Обе стороны: переход на ступень после подтверждения
+    void (*rate_apply)(uint8_t level);
+    // Отправитель: подтверждение не пришло за время таймера повтора
+    void (*rate_timeout)(void);
+} arq_link_t;
+
+typedef struct {
+    int window;             // Размер окна в кадрах, 1..ARQ_MAX_WINDOW
+    int max_retries;        // Число повторов одного кадра до отказа
+    int64_t initial_rto_us; // Таймер повтора до первого измерения RTT
+    int64_t min_rto_us;
+    int64_t max_rto_us;
+} arq_config_t;
+
+typedef struct {
+    int bytes;           // Доставленная полезная нагрузка
+    int frames_sent;     // Все переданные кадры данных, включая повторы
+    int retransmissions; // Повторно переданные кадры
+    int timeouts;        // Истечения таймера без подтверждения
+    int acks;            // Принятые подтверждения
+    int64_t elapsed_us;  // Время всей передачи
+    int64_t srtt_us;     // Сглаженное RTT
+    int64_t rto_us;      // Таймер повтора в конце передачи
+} arq_stats_t;
+
+// Надёжная передача буфера с выборочным повтором (selective repeat)
+// Возвращает 0 при успешной доставке, -1 если кадр исчерпал число повторов
+int arq_send(const arq_link_t* link, const arq_config_t* config, const uint8_t* data, int len, arq_stats_t* stats);
+
+// Приём одного кадра: буферизация вне порядка, выдача по порядку, подтверждение по запросу
+// Возвращает число выданных байт или -1, если за timeout_us кадра не было
+int arq_receive_step(const arq_link_t* link, const arq_config_t* config, int64_t timeout_us);
+
+void arq_receiver_reset(void);
+
+#endif //ARQ_H
@@ -0,0 +1,45 @@
+#include "bench.h"
+
+#include <esp_timer.h>
+#include <rtc_wdt.h>
+#include <stdio.h>
+#include <rom/ets_sys.h>
+
+#include "bench_kernels.h"
+#include "console.h"
+
+// Каждое ядро повторяется, пока замер не займёт столько времени
+#define BENCH_MIN_US 200000
+
+void bench_run(const uart_port_t uart_port) {
+    bench_prepare();
+
+    char line[160];
+    int len = snprintf(line, sizeof(line), "{\"cpu_mhz\":%lu,\"kernels\":[", (unsigned long)ets_get_cpu_frequency());
+    console_write(uart_port, line, len);
+    for (int k = 0; k < bench_kernel_count; ++k) {
+        // Серии удваиваются: время читается и сторожевой таймер сбрасывается между сериями, а не на каждой операции
+        int iterations = 0;
+        int64_t bytes = 0;
+        const int64_t start = esp_timer_get_time();
+        int64_t elapsed;
+        for (int batch = 1;; batch *= 2) {
+            for (int i = 0; i < batch; ++i) {
+                bytes += bench_kernels[k].kernel();
+            }
+            iterations += batch;
+            rtc_wdt_feed();
+            if ((elapsed = esp_timer_get_time() - start) >= BENCH_MIN_US) {
+                break;
+            }
+        }
+        const uint32_t ns_per_op = elapsed * 1000 / iterations;
+        const uint64_t bytes_per_s = bytes * 1000000 / elapsed;
+        len = snprintf(
+            line, sizeof(line), "%s{\"name\":\"%s\",\"ns_per_op\":%lu,\"bytes_per_s\":%llu}", k ? "," : "",
+            bench_kernels[k].name, (unsigned long)ns_per_op, (unsigned long long)bytes_per_s
+        );
+        console_write(uart_port, line, len);
+    }
+    console_write(uart_port, "]}\r\n", 4);
+}
@@ -0,0 +1,10 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <hal/uart_types.h>
+
+// Замер всех ядер bench_kernels на плате, результат одной строкой JSON.
+// Регрессии отслеживает замер на хосте (bench/) по сохранённому в репозитории базовому замеру
+void bench_run(uart_port_t uart_port);
+
+#endif //BENCH_H
@@ -0,0 +1,280 @@
+#include "bench_kernels.h"
+
+#include <string.h>
+
+#include "eq.h"
+#include "fec.h"
+#include "fft.h"
+#include "lzss.h"
+#include "manchester.h"
+#include "prbs.h"
+#include "rxfsm.h"
+#include "synchronizer.h"
+#include "utils.h"
+
+// Полупериод синхропоследовательности: пауза в её конце длится два полупериода
+#define BENCH_SYNC_HALF_US (SYNC_TAIL_US / 2)
+#define BENCH_PAIRS 256
+#define BENCH_ENCODE_BYTES 256
+#define BENCH_MEDIAN_SIZE 15
+#define BENCH_AVG_SIZE 10
+#define BENCH_CRC_BYTES 64
+#define BENCH_PRBS_BYTES 256
+#define BENCH_EQ_SAMPLES 256
+#define BENCH_LZSS_BYTES 1024
+// Размер БПФ символа OFDM
+#define BENCH_FFT_LOG2 6
+#define BENCH_FFT_SIZE (1 << BENCH_FFT_LOG2)
+// Кадр непрерывного приёма: синхропоследовательность, метка скорости и данные, отсчёт АЦП занимает BENCH_ADC_US
+#define BENCH_FRAME_BYTES 32
+#define BENCH_FRAME_FREQUENCY 10000
+#define BENCH_FRAME_HALF_US (500000 / BENCH_FRAME_FREQUENCY)
+#define BENCH_FRAME_HALVES (16 * (BENCH_FRAME_BYTES + 1))
+#define BENCH_ADC_US 10
+#define BENCH_THRESHOLD 800
+
+// Результаты ядер складываются сюда, чтобы компилятор не выбросил вычисления
+static volatile int bench_sink;
+
+static double bench_pairs[2 * BENCH_PAIRS];
+static float bench_halves[2 * BENCH_PAIRS];
+static uint16_t bench_encoded[BENCH_ENCODE_BYTES];
+static int bench_samples[BENCH_EQ_SAMPLES];
+static uint8_t bench_data[BENCH_LZSS_BYTES];
+static uint8_t bench_coded[FEC_CODED_SIZE(FEC_MAX_DATA)];
+static int8_t bench_soft[FEC_CODED_SIZE(FEC_MAX_DATA) * 8];
+static uint8_t bench_packed[BENCH_LZSS_BYTES + LZSS_HEADER_SIZE];
+static int bench_packed_len = 0;
+static uint8_t bench_out[BENCH_LZSS_BYTES + LZSS_MAX_MATCH];
+static fft_complex_t bench_fft_input[BENCH_FFT_SIZE];
+static fft_complex_t bench_fft_buffer[BENCH_FFT_SIZE];
+static uint8_t bench_stream[2 * BENCH_PRBS_BYTES];
+static prbs_checker_t bench_locked;
+static prbs_checker_t bench_checker;
+static double bench_sync_buffer[SYNC_BUFFER_LENGTH];
+static uint8_t bench_frame_halves[BENCH_FRAME_HALVES];
+static uint8_t bench_frame_out[BENCH_FRAME_BYTES];
+static rxfsm_t bench_fsm;
+
+// Уровень кадра в момент t: синхропоследовательность send_sync_seq(), пауза, метка и данные
+static int bench_frame_level(const int64_t t) {
+    const int64_t sync_end = 16 * BENCH_SYNC_HALF_US;
+    if (t < sync_end) {
+        return (manchester_encode_byte(0x0F) >> (15 - t / BENCH_SYNC_HALF_US)) & 1;
+    }
+    const int64_t data = t - sync_end - SYNC_TAIL_US;
+    if (data < 0 || data >= BENCH_FRAME_HALVES * BENCH_FRAME_HALF_US) {
+        return 0;
+    }
+    return bench_frame_halves[data / BENCH_FRAME_HALF_US];
+}
+
+// Входные данные: полубиты с шумом, текст со словарными повторами, мягкие решения закодированного блока
+void bench_prepare(void) {
+    prbs_gen_t gen;
+    prbs_init(&gen, PRBS_15);
+    for (int i = 0; i < BENCH_PAIRS; ++i) {
+        const int bit = prbs_next_bit(&gen);
+        const double noise = (prbs_next_bit(&gen) - 0.5) * 0.2;
+        bench_pairs[2 * i] = (bit ? 0.6 : 1.4) + noise;
+        bench_pairs[2 * i + 1] = (bit ? 1.4 : 0.6) - noise;
+        bench_halves[2 * i] = bench_pairs[2 * i];
+        bench_halves[2 * i + 1] = bench_pairs[2 * i + 1];
+    }
+    for (int i = 0; i < BENCH_EQ_SAMPLES; ++i) {
+        bench_samples[i] = (i / 8) % 2 ? 2000 + (i * 37) % 200 : 300 + (i * 53) % 200;
+    }
+    static const char words[] = "light modulation frame sync manchester ";
+    for (int i = 0; i < BENCH_LZSS_BYTES; ++i) {
+        bench_data[i] = prbs_next_bit(&gen) && prbs_next_bit(&gen) ? 'A' + i % 26 : words[i % (sizeof(words) - 1)];
+    }
+    bench_packed_len = lzss_pack_frame(bench_data, BENCH_LZSS_BYTES, bench_packed);
+    const int coded_len = fec_encode(bench_data, FEC_MAX_DATA, bench_coded);
+    for (int i = 0; i < coded_len * 8; ++i) {
+        bench_soft[i] = (bench_coded[i / 8] >> (7 - i % 8)) & 1 ? 100 : -100;
+    }
+    fft_init();
+    for (int i = 0; i < BENCH_FFT_SIZE; ++i) {
+        bench_fft_input[i].re = (int16_t)(bench_samples[i] * 8 - 9000);
+        bench_fft_input[i].im = 0;
+    }
+    // Проверка замеряется в синхронизме: первая половина потока захватывает его, вторая проверяется каждый раз
+    prbs_init(&gen, PRBS_31);
+    prbs_fill(&gen, bench_stream, sizeof(bench_stream));
+    prbs_checker_init(&bench_locked, PRBS_31);
+    prbs_check(&bench_locked, bench_stream, BENCH_PRBS_BYTES);
+    // Совпадающая синхропоследовательность: проверка проходит весь буфер
+    for (int i = 0; i < SYNC_BUFFER_LENGTH; ++i) {
+        bench_sync_buffer[i] = (RXFSM_SYNC_PATTERN >> (SYNC_BUFFER_LENGTH - 1 - i)) & 1;
+    }
+    for (int i = 0; i < BENCH_FRAME_HALVES; ++i) {
+        const uint8_t byte = i < 16 ? RATE_MARKER : bench_data[i / 16 - 1];
+        bench_frame_halves[i] = (manchester_encode_byte(byte) >> (15 - i % 16)) & 1;
+    }
+}
+
+// Ядро выполняет одну операцию и возвращает число обработанных байт входа
+static int bench_manchester_pairs(void) {
+    int sum = 0;
+    for (int i = 0; i < BENCH_PAIRS; ++i) {
+        sum += decode_manchester_pair(bench_pairs[2 * i], bench_pairs[2 * i + 1]);
+    }
+    bench_sink = sum;
+    return BENCH_PAIRS / 8;
+}
+
+// Тот же поток пар словами: 32 полубита за раз, неразличимых пар во входе нет
+static int bench_manchester_words(void) {
+    int sum = 0;
+    for (int i = 0; i < 2 * BENCH_PAIRS; i += 32) {
+        uint16_t valid;
+        sum += manchester_decode_word(manchester_pack_halves(bench_halves + i, 32), &valid);
+        sum += valid;
+    }
+    bench_sink = sum;
+    return BENCH_PAIRS / 8;
+}
+
+// Кодирование по битам, как до словных ядер: бит выделяется сдвигом, пара полубитов выбирается ветвлением
+static int bench_manchester_encode_bits(void) {
+    for (int i = 0; i < BENCH_ENCODE_BYTES; ++i) {
+        uint16_t halves = 0;
+        for (int bit = 7; bit >= 0; --bit) {
+            if ((bench_data[i] >> bit) & 1) {
+                halves = halves << 2 | 0x1;
+            } else {
+                halves = halves << 2 | 0x2;
+            }
+        }
+        bench_encoded[i] = halves;
+    }
+    bench_sink = bench_encoded[BENCH_ENCODE_BYTES - 1];
+    return BENCH_ENCODE_BYTES;
+}
+
+static int bench_manchester_encode(void) {
+    for (int i = 0; i < BENCH_ENCODE_BYTES; ++i) {
+        bench_encoded[i] = manchester_encode_byte(bench_data[i]);
+    }
+    bench_sink = bench_encoded[BENCH_ENCODE_BYTES - 1];
+    return BENCH_ENCODE_BYTES;
+}
+
+static int bench_median(void) {
+    bench_sink = calc_median(bench_samples, BENCH_MEDIAN_SIZE);
+    return BENCH_MEDIAN_SIZE * sizeof(int);
+}
+
+static int bench_avg_bin(void) {
+    bench_sink = avg_bin_of_buffer(bench_samples, BENCH_AVG_SIZE, 1100) >= 1;
+    return BENCH_AVG_SIZE * sizeof(int);
+}
+
+static int bench_check_buffers(void) {
+    bench_sink = match_sync_pattern(bench_sync_buffer);
+    return 0;
+}
+
+static int bench_crc16(void) {
+    bench_sink = crc16_ccitt(bench_data, BENCH_CRC_BYTES);
+    return BENCH_CRC_BYTES;
+}
+
+static int bench_fec_encode(void) {
+    bench_sink = fec_encode(bench_data, FEC_MAX_DATA, bench_coded);
+    return FEC_MAX_DATA;
+}
+
+static int bench_fec_decode(void) {
+    bench_sink = fec_decode(bench_soft, FEC_CODED_SIZE(FEC_MAX_DATA) * 8, bench_out, FEC_MAX_DATA);
+    return FEC_MAX_DATA;
+}
+
+static int bench_lzss_pack(void) {
+    bench_sink = lzss_pack_frame(bench_data, BENCH_LZSS_BYTES, bench_packed);
+    return BENCH_LZSS_BYTES;
+}
+
+static int bench_lzss_unpack(void) {
+    lzss_decoder_t decoder;
+    lzss_decoder_reset(&decoder, bench_packed[0]);
+    int total = 0;
+    for (int i = LZSS_HEADER_SIZE; i < bench_packed_len; ++i) {
+        total += lzss_decoder_feed(&decoder, bench_packed[i], bench_out);
+    }
+    bench_sink = total;
+    return BENCH_LZSS_BYTES;
+}
+
+static int bench_prbs_fill(void) {
+    prbs_gen_t gen;
+    prbs_init(&gen, PRBS_31);
+    prbs_fill(&gen, bench_out, BENCH_PRBS_BYTES);
+    bench_sink = bench_out[BENCH_PRBS_BYTES - 1];
+    return BENCH_PRBS_BYTES;
+}
+
+static int bench_prbs_check(void) {
+    bench_checker = bench_locked;
+    prbs_check(&bench_checker, bench_stream + BENCH_PRBS_BYTES, BENCH_PRBS_BYTES);
+    bench_sink = bench_checker.locked;
+    return BENCH_PRBS_BYTES;
+}
+
+static int bench_eq_apply(void) {
+    eq_t eq;
+    eq_reset(&eq);
+    eq.c0 = EQ_ONE * 3;
+    eq.c1 = -EQ_ONE * 2;
+    eq_start(&eq, bench_samples[0]);
+    int sum = 0;
+    for (int i = 0; i < BENCH_EQ_SAMPLES; ++i) {
+        sum += eq_apply(&eq, bench_samples[i]);
+    }
+    bench_sink = sum;
+    return BENCH_EQ_SAMPLES * sizeof(int);
+}
+
+static int bench_fft64(void) {
+    memcpy(bench_fft_buffer, bench_fft_input, sizeof(bench_fft_buffer));
+    fft_q15(bench_fft_buffer, BENCH_FFT_LOG2, 0);
+    bench_sink = bench_fft_buffer[1].re;
+    return sizeof(bench_fft_buffer);
+}
+
+// Приём одного кадра автоматом от поиска синхропоследовательности до последнего байта
+static int bench_rxfsm_frame(void) {
+    const rxfsm_config_t config = {.threshold = BENCH_THRESHOLD, .frequency = BENCH_FRAME_FREQUENCY};
+    rxfsm_init(&bench_fsm, &config);
+    rxfsm_set_output(&bench_fsm, bench_frame_out, sizeof(bench_frame_out));
+    int len = -1;
+    for (int64_t t = 0; len < 0 && t < 2 * SYNC_TAIL_US + 16 * BENCH_SYNC_HALF_US + BENCH_FRAME_HALVES * BENCH_FRAME_HALF_US;
+         t += BENCH_ADC_US + rxfsm_sample_delay_us(&bench_fsm)) {
+        const int raw = bench_frame_level(t) ? 1500 + (int)(t * 37 % 97) : 100 + (int)(t * 53 % 89);
+        len = rxfsm_feed(&bench_fsm, t, raw);
+    }
+    bench_sink = len;
+    return BENCH_FRAME_BYTES;
+}
+
+const bench_kernel_t bench_kernels[] = {
+    {"manchester_pairs", bench_manchester_pairs},
+    {"manchester_words", bench_manchester_words},
+    {"manchester_encode_bits", bench_manchester_encode_bits},
+    {"manchester_encode", bench_manchester_encode},
+    {"median", bench_median},
+    {"avg_bin", bench_avg_bin},
+    {"check_buffers", bench_check_buffers},
+    {"crc16", bench_crc16},
+    {"fec_encode", bench_fec_encode},
+    {"fec_decode", bench_fec_decode},
+    {"lzss_pack", bench_lzss_pack},
+    {"lzss_unpack", bench_lzss_unpack},
+    {"prbs_fill", bench_prbs_fill},
+    {"prbs_check", bench_prbs_check},
+    {"eq_apply", bench_eq_apply},
+    {"fft64", bench_fft64},
+    {"rxfsm_frame", bench_rxfsm_frame},
+};
+
+const int bench_kernel_count = sizeof(bench_kernels) / sizeof(bench_kernels[0]);
@@ -0,0 +1,19 @@
+#ifndef BENCH_KERNELS_H
+#define BENCH_KERNELS_H
+
+// Ядра замера кодеков и обработки сигнала без обращения к периферии: общие для #BENCH на плате
+// и для замера на хосте (bench/)
+
+typedef struct {
+    const char* name;
+    // Одна операция ядра. Возвращает число обработанных байт входа
+    int (*kernel)(void);
+} bench_kernel_t;
+
+extern const bench_kernel_t bench_kernels[];
+extern const int bench_kernel_count;
+
+// Входные данные всех ядер, вызывается перед замером
+void bench_prepare(void);
+
+#endif //BENCH_KERNELS_H
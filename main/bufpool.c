@@ -0,0 +1,62 @@
+#include "bufpool.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#if BUFPOOL_BLOCKS > 32
+#error "CONFIG_LIFI_POOL_BLOCKS is limited by the 32-bit free mask"
+#endif
+
+static bufpool_frame_t pool_frames[BUFPOOL_BLOCKS];
+// Бит i - блок i свободен
+static uint32_t pool_free = BUFPOOL_BLOCKS == 32 ? 0xFFFFFFFFu : (1u << BUFPOOL_BLOCKS) - 1;
+static bufpool_stats_t pool_stats = {0};
+static portMUX_TYPE pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+bufpool_frame_t* bufpool_acquire(void) {
+    bufpool_frame_t* frame = NULL;
+    taskENTER_CRITICAL(&pool_lock);
+    if (pool_free) {
+        const int index = __builtin_ctz(pool_free);
+        pool_free &= ~(1u << index);
+        frame = &pool_frames[index];
+        ++pool_stats.acquired;
+        if (++pool_stats.in_use > pool_stats.high_water) {
+            pool_stats.high_water = pool_stats.in_use;
+        }
+    } else {
+        ++pool_stats.failures;
+    }
+    taskEXIT_CRITICAL(&pool_lock);
+    if (frame) {
+        frame->len = 0;
+    }
+    return frame;
+}
+
+void bufpool_release(bufpool_frame_t* frame) {
+    if (!frame) {
+        return;
+    }
+    const int index = frame - pool_frames;
+    taskENTER_CRITICAL(&pool_lock);
+    if (!(pool_free & (1u << index))) {
+        pool_free |= 1u << index;
+        --pool_stats.in_use;
+    }
+    taskEXIT_CRITICAL(&pool_lock);
+}
+
+void bufpool_get_stats(bufpool_stats_t* stats) {
+    taskENTER_CRITICAL(&pool_lock);
+    *stats = pool_stats;
+    taskEXIT_CRITICAL(&pool_lock);
+}
+
+void bufpool_reset_stats(void) {
+    taskENTER_CRITICAL(&pool_lock);
+    pool_stats.high_water = pool_stats.in_use;
+    pool_stats.acquired = 0;
+    pool_stats.failures = 0;
+    taskEXIT_CRITICAL(&pool_lock);
+}
@@ -0,0 +1,36 @@
+#ifndef BUFPOOL_H
+#define BUFPOOL_H
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+// Пул блоков под кадры: ввод UART, кодирование, передача, декодирование и вывод передают блок
+// друг другу вместе с владением, данные не копируются между этапами
+#define BUFPOOL_BLOCKS CONFIG_LIFI_POOL_BLOCKS
+#define BUFPOOL_BLOCK_SIZE CONFIG_LIFI_POOL_BLOCK_SIZE
+
+typedef struct {
+    int len;
+    uint8_t data[BUFPOOL_BLOCK_SIZE];
+} bufpool_frame_t;
+
+typedef struct {
+    uint32_t in_use;     // Занято сейчас
+    uint32_t high_water; // Наибольшее число одновременно занятых блоков
+    uint32_t acquired;   // Выдано блоков всего
+    uint32_t failures;   // Запросы, когда свободных блоков не было
+} bufpool_stats_t;
+
+// Свободный блок с нулевой длиной, NULL если пул исчерпан. Владелец обязан вернуть блок bufpool_release()
+bufpool_frame_t* bufpool_acquire(void);
+
+// Возврат блока в пул, NULL допускается
+void bufpool_release(bufpool_frame_t* frame);
+
+void bufpool_get_stats(bufpool_stats_t* stats);
+
+// Сброс счётчиков, высшая отметка начинается с текущей занятости
+void bufpool_reset_stats(void);
+
+#endif //BUFPOOL_H
@@ -0,0 +1,76 @@
+#include "calib.h"
+
+#include <string.h>
+
+// Середина корзины в отсчётах АЦП
+#define BUCKET_CENTER(mean) ((int)((mean) * (1 << CALIB_BUCKET_SHIFT)) + (1 << CALIB_BUCKET_SHIFT) / 2)
+
+void calib_reset(calib_histogram_t* histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+int calib_otsu(const calib_histogram_t* histogram, calib_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    const uint32_t total = histogram->total;
+    if (total == 0) {
+        return -1;
+    }
+    uint64_t sum = 0;
+    uint64_t sum_squares = 0;
+    for (int i = 0; i < CALIB_BUCKETS; ++i) {
+        sum += (uint64_t)histogram->counts[i] * i;
+        sum_squares += (uint64_t)histogram->counts[i] * i * i;
+    }
+    const float mean = (float)sum / total;
+    const float variance = (float)sum_squares / total - mean * mean;
+
+    // Нижний класс - корзины 0..i. Суммы целые, поэтому на пустых корзинах дисперсия не меняется точно
+    uint32_t low_count = 0;
+    uint64_t low_sum = 0;
+    float best = -1.0f;
+    int first = 0;
+    int last = 0;
+    for (int i = 0; i < CALIB_BUCKETS - 1; ++i) {
+        low_count += histogram->counts[i];
+        low_sum += (uint64_t)histogram->counts[i] * i;
+        if (low_count == 0) {
+            continue;
+        }
+        if (low_count == total) {
+            break;
+        }
+        const float low_mean = (float)low_sum / low_count;
+        const float high_mean = (float)(sum - low_sum) / (total - low_count);
+        const float diff = high_mean - low_mean;
+        const float between = (float)low_count * (total - low_count) * diff * diff;
+        if (between > best) {
+            best = between;
+            first = last = i;
+        } else if (between == best && last == i - 1) {
+            last = i;
+        }
+    }
+    if (best < 0) {
+        // Все отсчёты в одной корзине
+        result->low = result->high = result->threshold = BUCKET_CENTER(mean);
+        return -1;
+    }
+
+    // Граница - середина промежутка от конца нижнего уровня до начала верхнего
+    result->threshold = ((first + last) / 2 + 1) << CALIB_BUCKET_SHIFT;
+    uint32_t count = 0;
+    uint64_t weighted = 0;
+    for (int i = 0; i <= first; ++i) {
+        count += histogram->counts[i];
+        weighted += (uint64_t)histogram->counts[i] * i;
+    }
+    result->low = BUCKET_CENTER((float)weighted / count);
+    result->high = BUCKET_CENTER((float)(sum - weighted) / (total - count));
+    const float between_variance = best / ((float)total * total);
+    result->separability_pct = variance > 0 ? (int)(100.0f * between_variance / variance) : 0;
+
+    if (result->high - result->low < CALIB_MIN_SEPARATION || result->separability_pct < CALIB_MIN_SEPARABILITY_PCT) {
+        return -1;
+    }
+    return 0;
+}
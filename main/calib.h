@@ -0,0 +1,47 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+#include <stdint.h>
+
+// Калибровка порога за один проход: гистограмма отсчётов АЦП и порог по методу Оцу.
+// Во время калибровки передатчик должен мигать (#BLINK), чтобы в выборке были оба уровня
+#define CALIB_ADC_BITS 12
+// Ширина корзины гистограммы - 8 отсчётов АЦП
+#define CALIB_BUCKET_SHIFT 3
+#define CALIB_BUCKETS ((1 << CALIB_ADC_BITS) >> CALIB_BUCKET_SHIFT)
+// Отсчётов за калибровку, счётчики корзин 16-битные
+#define CALIB_SAMPLES 4096
+// Наименьшее расстояние между средними уровнями, отсчётов АЦП
+#define CALIB_MIN_SEPARATION 16
+// Наименьшая доля межклассовой дисперсии в общей. У одного гауссова уровня без мигания метод Оцу даёт около 64%
+#define CALIB_MIN_SEPARABILITY_PCT 75
+
+typedef struct {
+    uint16_t counts[CALIB_BUCKETS];
+    uint32_t total;
+} calib_histogram_t;
+
+typedef struct {
+    int threshold;        // Отсчёты от порога и выше - светодиод включён
+    int low;              // Средний уровень без света передатчика - фоновая засветка
+    int high;             // Средний уровень со светом передатчика
+    int separability_pct; // Доля межклассовой дисперсии в общей
+} calib_result_t;
+
+void calib_reset(calib_histogram_t* histogram);
+
+static inline void calib_add(calib_histogram_t* histogram, int raw) {
+    if (raw < 0) raw = 0;
+    if (raw >= 1 << CALIB_ADC_BITS) raw = (1 << CALIB_ADC_BITS) - 1;
+    if (histogram->total < UINT16_MAX) {
+        ++histogram->counts[raw >> CALIB_BUCKET_SHIFT];
+        ++histogram->total;
+    }
+}
+
+// Порог, максимизирующий межклассовую дисперсию. Если максимум на пустом промежутке между уровнями,
+// порог ставится в его середину. Возвращает 0 или -1, если в выборке нет двух различимых уровней
+// (результат при этом всё равно заполнен - для вывода)
+int calib_otsu(const calib_histogram_t* histogram, calib_result_t* result);
+
+#endif //CALIB_H
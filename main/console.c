@@ -0,0 +1,46 @@
+#include "console.h"
+
+#include <driver/uart.h>
+
+static console_stats_t console_stats = {
+    .min_free = CONSOLE_TX_BUFFER_SIZE,
+};
+
+// Хост не успевает забирать вывод: ждать нельзя, иначе приёмник пропустит кадр
+static int console_drop(const size_t len) {
+    console_stats.bytes_dropped += len;
+    ++console_stats.writes_dropped;
+    return 0;
+}
+
+int console_write(const uart_port_t uart_port, const void* data, const size_t len) {
+    size_t free_size = 0;
+    if (uart_get_tx_buffer_free_size(uart_port, &free_size) != ESP_OK) {
+        return console_drop(len);
+    }
+    // Отметка - наименьшее место, которое действительно оставалось в кольце. Отброс её не обнуляет,
+    // отброшенные сообщения видны только по счётчикам
+    const size_t free_after = free_size >= len ? free_size - len : free_size;
+    if (free_after < console_stats.min_free) {
+        console_stats.min_free = free_after;
+    }
+    if (free_size < len) {
+        return console_drop(len);
+    }
+    const int written = uart_write_bytes(uart_port, data, len);
+    if (written > 0) {
+        console_stats.bytes_written += written;
+    }
+    return written;
+}
+
+void console_get_stats(console_stats_t* stats) {
+    *stats = console_stats;
+}
+
+void console_reset_stats(void) {
+    console_stats.bytes_written = 0;
+    console_stats.bytes_dropped = 0;
+    console_stats.writes_dropped = 0;
+    console_stats.min_free = CONSOLE_TX_BUFFER_SIZE;
+}
@@ -0,0 +1,26 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <hal/uart_types.h>
+
+// Кольцевой буфер передачи драйвера UART: вывод уходит на линию из прерывания, пока идёт приём света
+#define CONSOLE_TX_BUFFER_SIZE 16384
+
+typedef struct {
+    uint32_t bytes_written;  // Поставлено в очередь передачи
+    uint32_t bytes_dropped;  // Отброшено из-за нехватки места в кольце
+    uint32_t writes_dropped; // Отброшенные сообщения целиком
+    uint32_t min_free;       // Наименьшее свободное место в кольце за всё время
+} console_stats_t;
+
+// Неблокирующая запись: сообщение целиком ставится в кольцо передачи или отбрасывается с учётом в статистике
+// Возвращает число записанных байт (0 если отброшено)
+int console_write(uart_port_t uart_port, const void* data, size_t len);
+
+void console_get_stats(console_stats_t* stats);
+
+void console_reset_stats(void);
+
+#endif //CONSOLE_H
@@ -0,0 +1,67 @@
+#include "coop.h"
+
+#include <string.h>
+
+#include "perf.h"
+
+void coop_init(coop_scheduler_t* scheduler, int64_t (*now_us)(void)) {
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->now_us = now_us;
+}
+
+int coop_add(coop_scheduler_t* scheduler, coop_task_t* task, const char* name, const coop_step_t step) {
+    if (scheduler->count >= COOP_MAX_TASKS) {
+        return -1;
+    }
+    memset(task, 0, sizeof(*task));
+    task->name = name;
+    task->step = step;
+    PT_INIT(&task->pt);
+    scheduler->tasks[scheduler->count++] = task;
+    return 0;
+}
+
+LIFI_HOT int coop_run_once(coop_scheduler_t* scheduler) {
+    int steps = 0;
+    for (int i = 0; i < scheduler->count; ++i) {
+        coop_task_t* task = scheduler->tasks[i];
+        if (task->ended) {
+            continue;
+        }
+        // Время берётся перед каждым шагом: предыдущие шаги прохода его уже сдвинули
+        const int64_t now = scheduler->now_us();
+        if (now < task->wake_us) {
+            continue;
+        }
+        if (now - task->wake_us > task->max_late_us) {
+            task->max_late_us = now - task->wake_us;
+        }
+        // Без явного сна поток получит следующий шаг в следующем проходе
+        task->wake_us = now;
+        if (task->step(task, now) >= PT_EXITED) {
+            task->ended = 1;
+        }
+        ++task->steps;
+        ++steps;
+    }
+    ++scheduler->passes;
+    return steps;
+}
+
+void coop_run(coop_scheduler_t* scheduler) {
+    scheduler->stop = 0;
+    while (!scheduler->stop) {
+        int alive = 0;
+        for (int i = 0; i < scheduler->count; ++i) {
+            alive |= !scheduler->tasks[i]->ended;
+        }
+        if (!alive) {
+            break;
+        }
+        coop_run_once(scheduler);
+    }
+}
+
+void coop_stop(coop_scheduler_t* scheduler) {
+    scheduler->stop = 1;
+}
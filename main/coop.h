@@ -0,0 +1,57 @@
+#ifndef COOP_H
+#define COOP_H
+
+#include <stdint.h>
+
+#include "pt.h"
+
+// Кооперативный планировщик протопотоков на одном ядре: движки делают короткий шаг и возвращают управление,
+// переключение - вызов функции без смены контекста задачи RTOS
+#define COOP_MAX_TASKS 8
+
+typedef struct coop_task coop_task_t;
+
+// Шаг потока в момент now_us, возвращает PT_WAITING, PT_YIELDED, PT_EXITED или PT_ENDED
+typedef int (*coop_step_t)(coop_task_t* task, int64_t now_us);
+
+struct coop_task {
+    const char* name;
+    coop_step_t step;
+    pt_t pt;
+    int64_t wake_us;     // Раньше этого момента шаг не вызывается
+    int ended;
+    uint32_t steps;
+    int64_t max_late_us; // Наибольшее опоздание шага относительно wake_us
+};
+
+// Сон до момента deadline_us: шаг заканчивается, следующий будет не раньше
+#define COOP_SLEEP_UNTIL(task, deadline_us) \
+    do {                                    \
+        (task)->wake_us = (deadline_us);    \
+        PT_YIELD(&(task)->pt);              \
+    } while (0)
+
+typedef struct {
+    coop_task_t* tasks[COOP_MAX_TASKS];
+    int count;
+    // Монотонное время в микросекундах
+    int64_t (*now_us)(void);
+    volatile int stop;
+    uint32_t passes;
+} coop_scheduler_t;
+
+void coop_init(coop_scheduler_t* scheduler, int64_t (*now_us)(void));
+
+// Подключение потока, порядок подключения - порядок шагов в проходе. -1, если места нет
+int coop_add(coop_scheduler_t* scheduler, coop_task_t* task, const char* name, coop_step_t step);
+
+// Один проход: шаг каждого потока, время которого наступило. Возвращает число сделанных шагов
+int coop_run_once(coop_scheduler_t* scheduler);
+
+// Проходы до завершения всех потоков или coop_stop()
+void coop_run(coop_scheduler_t* scheduler);
+
+// Остановка после текущего прохода, можно вызывать из шага потока
+void coop_stop(coop_scheduler_t* scheduler);
+
+#endif //COOP_H
@@ -0,0 +1,160 @@
+#include "csk.h"
+
+#include <string.h>
+
+// Отображение символов в цвета без обращения к ленте, передача - в csk_sender.c
+
+// Полная интенсивность канала, масштабируется до CONFIG_LIFI_CSK_MAX_LEVEL при выводе
+#define FULL CSK_FULL
+// Треть и две трети полной интенсивности для точек внутри треугольника RGB
+#define THIRD 85
+#define TWO_THIRDS 170
+
+// 4-CSK: вершины треугольника RGB и его центр. Сумма R+G+B постоянна - яркость не мерцает
+static const csk_color_t csk4_table[4] = {
+    {FULL, 0, 0, 0},
+    {0, FULL, 0, 0},
+    {0, 0, FULL, 0},
+    {THIRD, THIRD, THIRD, 0},
+};
+
+// 8-CSK: вершины и точки деления сторон на трети (одна точка сетки отброшена)
+// Соседние символы отличаются одним шагом сетки, сумма R+G+B постоянна
+static const csk_color_t csk8_table[8] = {
+    {FULL, 0, 0, 0},
+    {TWO_THIRDS, THIRD, 0, 0},
+    {THIRD, TWO_THIRDS, 0, 0},
+    {0, FULL, 0, 0},
+    {0, TWO_THIRDS, THIRD, 0},
+    {0, THIRD, TWO_THIRDS, 0},
+    {0, 0, FULL, 0},
+    {THIRD, 0, TWO_THIRDS, 0},
+};
+
+int csk_bits_per_symbol(const csk_mode_t mode) {
+    switch (mode) {
+        case CSK_MODE_RGB: return 3;
+        case CSK_MODE_RGBW: return 4;
+        case CSK_MODE_CSK4: return 2;
+        case CSK_MODE_CSK8: return 3;
+        default: return 0;
+    }
+}
+
+csk_color_t csk_map_symbol(const csk_mode_t mode, const uint8_t symbol) {
+    csk_color_t color = {0, 0, 0, 0};
+    switch (mode) {
+        case CSK_MODE_RGB:
+            // Бит 2 - красный, бит 1 - зелёный, бит 0 - синий
+            color.red = symbol & 0x4 ? FULL : 0;
+            color.green = symbol & 0x2 ? FULL : 0;
+            color.blue = symbol & 0x1 ? FULL : 0;
+            break;
+        case CSK_MODE_RGBW:
+            color.red = symbol & 0x8 ? FULL : 0;
+            color.green = symbol & 0x4 ? FULL : 0;
+            color.blue = symbol & 0x2 ? FULL : 0;
+            color.white = symbol & 0x1 ? FULL : 0;
+            break;
+        case CSK_MODE_CSK4:
+            color = csk4_table[symbol & 0x3];
+            break;
+        case CSK_MODE_CSK8:
+            color = csk8_table[symbol & 0x7];
+            break;
+        default:
+            break;
+    }
+    return color;
+}
+
+static int color_distance(const csk_color_t a, const csk_color_t b) {
+    const int dr = a.red - b.red;
+    const int dg = a.green - b.green;
+    const int db = a.blue - b.blue;
+    const int dw = a.white - b.white;
+    return dr * dr + dg * dg + db * db + dw * dw;
+}
+
+uint8_t csk_demap_color(const csk_mode_t mode, const csk_color_t color) {
+    switch (mode) {
+        case CSK_MODE_RGB:
+            return (color.red >= FULL / 2) << 2 | (color.green >= FULL / 2) << 1 | (color.blue >= FULL / 2);
+        case CSK_MODE_RGBW:
+            return (color.red >= FULL / 2) << 3 | (color.green >= FULL / 2) << 2 |
+                   (color.blue >= FULL / 2) << 1 | (color.white >= FULL / 2);
+        case CSK_MODE_CSK4:
+        case CSK_MODE_CSK8: {
+            // Поиск ближайшей точки созвездия
+            const int count = 1 << csk_bits_per_symbol(mode);
+            uint8_t best = 0;
+            int best_distance = -1;
+            for (int i = 0; i < count; ++i) {
+                const int distance = color_distance(color, csk_map_symbol(mode, i));
+                if (best_distance < 0 || distance < best_distance) {
+                    best_distance = distance;
+                    best = i;
+                }
+            }
+            return best;
+        }
+        default:
+            return 0;
+    }
+}
+
+int csk_pack_symbols(
+    const csk_mode_t mode, const uint8_t* data, const int len,
+    uint8_t* symbols, const int max_symbols
+) {
+    const int bits = csk_bits_per_symbol(mode);
+    if (bits == 0) {
+        return 0;
+    }
+    const uint8_t mask = (1 << bits) - 1;
+    uint32_t accumulator = 0;
+    int accumulated = 0;
+    int count = 0;
+    for (int i = 0; i < len; ++i) {
+        accumulator = (accumulator << 8) | data[i];
+        accumulated += 8;
+        while (accumulated >= bits && count < max_symbols) {
+            accumulated -= bits;
+            symbols[count++] = (accumulator >> accumulated) & mask;
+        }
+    }
+    // Остаток дополняем нулями справа
+    if (accumulated > 0 && count < max_symbols) {
+        symbols[count++] = (accumulator << (bits - accumulated)) & mask;
+    }
+    return count;
+}
+
+int csk_mode_from_name(const char* name) {
+    static const csk_mode_t modes[] = {CSK_MODE_OFF, CSK_MODE_RGB, CSK_MODE_RGBW, CSK_MODE_CSK4, CSK_MODE_CSK8};
+    // Пробелы и перевод строки вокруг имени отбрасываются, имя сравнивается целиком
+    while (*name == ' ' || *name == '\t') {
+        name++;
+    }
+    size_t len = strlen(name);
+    while (len > 0 && strchr(" \t\r\n", name[len - 1])) {
+        len--;
+    }
+    for (int i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); ++i) {
+        const char* candidate = csk_mode_name(modes[i]);
+        if (strlen(candidate) == len && strncmp(name, candidate, len) == 0) {
+            return modes[i];
+        }
+    }
+    return -1;
+}
+
+const char* csk_mode_name(const csk_mode_t mode) {
+    switch (mode) {
+        case CSK_MODE_RGB: return "RGB";
+        case CSK_MODE_RGBW: return "RGBW";
+        case CSK_MODE_CSK4: return "CSK4";
+        case CSK_MODE_CSK8: return "CSK8";
+        default: return "OFF";
+    }
+}
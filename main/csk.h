@@ -0,0 +1,52 @@
+#ifndef CSK_H
+#define CSK_H
+
+#include <stdint.h>
+
+// Режимы передачи через адресный RGB(W) светодиод
+typedef enum {
+    CSK_MODE_OFF = 0, // Обычная передача через GPIO светодиод
+    CSK_MODE_RGB,     // Три независимых OOK канала (R, G, B) - 3 бита на символ
+    CSK_MODE_RGBW,    // Четыре независимых OOK канала (R, G, B, W) - 4 бита на символ
+    CSK_MODE_CSK4,    // 4-CSK: цветовое созвездие с постоянной яркостью - 2 бита на символ
+    CSK_MODE_CSK8,    // 8-CSK: цветовое созвездие с постоянной яркостью - 3 бита на символ
+} csk_mode_t;
+
+// Полная интенсивность канала в цветах созвездия
+#define CSK_FULL 255
+
+// Цвет одного символа (интенсивности каналов 0..255)
+typedef struct {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint8_t white;
+} csk_color_t;
+
+// Число бит, переносимых одним обновлением светодиода
+int csk_bits_per_symbol(csk_mode_t mode);
+
+// Символ -> цвет по таблице созвездия
+csk_color_t csk_map_symbol(csk_mode_t mode, uint8_t symbol);
+
+// Цвет -> ближайший символ созвездия (обратное отображение)
+uint8_t csk_demap_color(csk_mode_t mode, csk_color_t color);
+
+// Разбиение байтов на символы (старшие биты первыми, последний символ дополняется нулями)
+// Возвращает число символов
+int csk_pack_symbols(csk_mode_t mode, const uint8_t* data, int len, uint8_t* symbols, int max_symbols);
+
+// Разбор имени режима команды "#CSK <режим>": имя целиком, без учёта пробелов вокруг. -1 при неизвестном имени
+int csk_mode_from_name(const char* name);
+
+const char* csk_mode_name(csk_mode_t mode);
+
+// Подготовка ленты к режиму: лента создаётся при первом включении CSK, а не при запуске,
+// пока CSK не используется, вывод BLINK_GPIO остаётся свободным.
+// -1, если режиму нужен белый канал, а лента собрана без CONFIG_LIFI_CSK_RGBW, -2, если ленту не удалось создать
+int csk_prepare(csk_mode_t mode);
+
+// Передача данных символами через адресный светодиод, по символу на одно обновление ленты
+void process_csk_data(const uint8_t* data, int len, double baseFrequency, csk_mode_t mode);
+
+#endif //CSK_H
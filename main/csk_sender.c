@@ -0,0 +1,141 @@
+#include "csk.h"
+
+#include <esp_timer.h>
+#include <rtc_wdt.h>
+#include <driver/uart.h>
+
+#include "console.h"
+#include "led_strip.h"
+#include "sdkconfig.h"
+
+// Передача символов CSK через адресную ленту
+
+// Период одного бита синхронизации, как в sender.c
+#define CSK_SYNC_HALF_PERIOD_US 20000
+
+// Порция байтов для разбиения на символы: 48 байт = 384 бита, делится на 2, 3 и 4 бита
+#define CSK_CHUNK_BYTES 48
+#define CSK_CHUNK_SYMBOLS (CSK_CHUNK_BYTES * 8 / 2)
+
+static led_strip_handle_t csk_strip = NULL;
+
+static void csk_create_strip(void) {
+    const led_strip_config_t strip_config = {
+        .strip_gpio_num = CONFIG_BLINK_GPIO,
+        .max_leds = CONFIG_LIFI_CSK_LED_COUNT,
+#if CONFIG_LIFI_CSK_RGBW
+        .led_pixel_format = LED_PIXEL_FORMAT_GRBW,
+        .led_model = LED_MODEL_SK6812,
+#else
+        .led_pixel_format = LED_PIXEL_FORMAT_GRB,
+        .led_model = LED_MODEL_WS2812,
+#endif
+        .flags.invert_out = false,
+    };
+#if CONFIG_BLINK_LED_STRIP_BACKEND_SPI
+    const led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+        .flags.with_dma = true,
+    };
+    if (led_strip_new_spi_device(&strip_config, &spi_config, &csk_strip) != ESP_OK) {
+        csk_strip = NULL;
+    }
+#else
+    const led_strip_rmt_config_t rmt_config = {
+        .resolution_hz = 10 * 1000 * 1000,
+        .flags.with_dma = false,
+    };
+    if (led_strip_new_rmt_device(&strip_config, &rmt_config, &csk_strip) != ESP_OK) {
+        csk_strip = NULL;
+    }
+#endif
+    if (csk_strip) {
+        led_strip_clear(csk_strip);
+    }
+}
+
+int csk_prepare(const csk_mode_t mode) {
+#if !CONFIG_LIFI_CSK_RGBW
+    // Без белого канала в формате пикселя csk_show() теряет младший бит каждого символа
+    if (mode == CSK_MODE_RGBW) {
+        return -1;
+    }
+#endif
+    if (!csk_strip) {
+        csk_create_strip();
+    }
+    return csk_strip ? 0 : -2;
+}
+
+// Вывод одного цвета на все светодиоды ленты. Обновление асинхронное:
+// следующий символ готовится, пока предыдущий ещё передаётся по линии ленты
+static void csk_show(const csk_color_t color) {
+    for (int i = 0; i < CONFIG_LIFI_CSK_LED_COUNT; ++i) {
+        const uint32_t red = color.red * CONFIG_LIFI_CSK_MAX_LEVEL / CSK_FULL;
+        const uint32_t green = color.green * CONFIG_LIFI_CSK_MAX_LEVEL / CSK_FULL;
+        const uint32_t blue = color.blue * CONFIG_LIFI_CSK_MAX_LEVEL / CSK_FULL;
+#if CONFIG_LIFI_CSK_RGBW
+        const uint32_t white = color.white * CONFIG_LIFI_CSK_MAX_LEVEL / CSK_FULL;
+        led_strip_set_pixel_rgbw(csk_strip, i, red, green, blue, white);
+#else
+        led_strip_set_pixel(csk_strip, i, red, green, blue);
+#endif
+    }
+    led_strip_refresh_async(csk_strip);
+}
+
+// Ожидание до абсолютного момента времени, чтобы длительность обновления ленты не накапливалась
+static void csk_wait_until(const int64_t deadline) {
+    while (esp_timer_get_time() < deadline) {
+    }
+}
+
+static void csk_send_level(const int on, const int duration_us) {
+    const int64_t start = esp_timer_get_time();
+    const csk_color_t white = {CSK_FULL, CSK_FULL, CSK_FULL, CSK_FULL};
+    const csk_color_t black = {0, 0, 0, 0};
+    csk_show(on ? white : black);
+    csk_wait_until(start + duration_us);
+}
+
+// Та же стартовая последовательность, что и в send_sync_seq(), но белым цветом ленты
+static void csk_send_sync_seq(void) {
+    for (int i = 0; i < 4; ++i) {
+        csk_send_level(1, CSK_SYNC_HALF_PERIOD_US);
+        csk_send_level(0, CSK_SYNC_HALF_PERIOD_US);
+    }
+    for (int i = 0; i < 4; ++i) {
+        csk_send_level(0, CSK_SYNC_HALF_PERIOD_US);
+        csk_send_level(1, CSK_SYNC_HALF_PERIOD_US);
+    }
+    csk_send_level(0, CSK_SYNC_HALF_PERIOD_US * 2);
+    rtc_wdt_feed();
+}
+
+void process_csk_data(const uint8_t* data, const int len, const double baseFrequency, const csk_mode_t mode) {
+    if (!csk_strip) {
+        console_write(UART_NUM_0, "LED strip is not available\n\0", 28);
+        return;
+    }
+    csk_send_sync_seq();
+
+    int symbol_period_us = (int)(1000000.0 / baseFrequency);
+    if (symbol_period_us < 1) symbol_period_us = 1;
+
+    uint8_t symbols[CSK_CHUNK_SYMBOLS];
+    int64_t deadline = esp_timer_get_time();
+    for (int offset = 0; offset < len; offset += CSK_CHUNK_BYTES) {
+        const int chunk = len - offset < CSK_CHUNK_BYTES ? len - offset : CSK_CHUNK_BYTES;
+        const int count = csk_pack_symbols(mode, data + offset, chunk, symbols, CSK_CHUNK_SYMBOLS);
+        for (int i = 0; i < count; ++i) {
+            csk_show(csk_map_symbol(mode, symbols[i]));
+            deadline += symbol_period_us;
+            csk_wait_until(deadline);
+        }
+        rtc_wdt_feed();
+    }
+
+    led_strip_wait_done(csk_strip, -1);
+    led_strip_clear(csk_strip);
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
+}
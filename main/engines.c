@@ -0,0 +1,174 @@
+#include "engines.h"
+
+#include <string.h>
+
+#include "manchester.h"
+#include "perf.h"
+#include "rates.h"
+
+// Поток - первое поле структуры движка, шаг получает движок приведением указателя
+
+void tx_engine_init(tx_engine_t* engine, const engine_io_t* io) {
+    memset(engine, 0, sizeof(*engine));
+    engine->io = io;
+}
+
+int tx_engine_send(tx_engine_t* engine, const uint8_t* data, const int len, const int frequency) {
+    if (engine->data) {
+        return -1;
+    }
+    engine->len = len;
+    engine->frequency = frequency;
+    engine->total = ENGINE_SYNC_HALF_BITS + 1 + (len + 1) * 16;
+    engine->data = data;
+    return 0;
+}
+
+int tx_engine_busy(const tx_engine_t* engine) {
+    return engine->data != NULL;
+}
+
+// Уровень полубита index: 8 бит синхропоследовательности (0000 1111), пауза, затем метка скорости и данные
+static LIFI_HOT int tx_half_level(const tx_engine_t* engine, const int index) {
+    if (index < ENGINE_SYNC_HALF_BITS) {
+        const int bit = index / 2 >= 4;
+        return bit ? index % 2 : !(index % 2);
+    }
+    if (index == ENGINE_SYNC_HALF_BITS) {
+        return 0;
+    }
+    const int half = index - ENGINE_SYNC_HALF_BITS - 1;
+    const uint8_t byte = half < 16 ? RATE_MARKER : engine->data[half / 16 - 1];
+    return (manchester_encode_byte(byte) >> (15 - half % 16)) & 1;
+}
+
+// Конец полубита index от начала кадра: моменты считаются от начала, ошибка шага не накапливается
+static LIFI_HOT int64_t tx_half_end(const tx_engine_t* engine, const int index) {
+    if (index < ENGINE_SYNC_HALF_BITS) {
+        return engine->start_us + (int64_t)(index + 1) * ENGINE_SYNC_HALF_PERIOD_US;
+    }
+    const int half = index - ENGINE_SYNC_HALF_BITS;
+    return engine->data_start_us + (int64_t)half * 500000 / engine->frequency;
+}
+
+LIFI_HOT int tx_engine_step(coop_task_t* task, const int64_t now_us) {
+    tx_engine_t* engine = (tx_engine_t*)task;
+    PT_BEGIN(&task->pt);
+    while (1) {
+        PT_WAIT_UNTIL(&task->pt, engine->data != NULL);
+        engine->start_us = now_us;
+        engine->data_start_us = now_us + (ENGINE_SYNC_HALF_BITS + 2) * ENGINE_SYNC_HALF_PERIOD_US;
+        for (engine->index = 0; engine->index < engine->total; ++engine->index) {
+            engine->io->led_set(tx_half_level(engine, engine->index));
+            COOP_SLEEP_UNTIL(task, tx_half_end(engine, engine->index));
+        }
+        engine->io->led_set(0);
+        ++engine->frames;
+        engine->data = NULL;
+    }
+    PT_END(&task->pt);
+}
+
+void rx_engine_init(
+    rx_engine_t* engine, const engine_io_t* io, const rxfsm_config_t* config,
+    void (*deliver)(const uint8_t* data, int len)
+) {
+    memset(engine, 0, sizeof(*engine));
+    engine->io = io;
+    engine->deliver = deliver;
+    rxfsm_init(&engine->fsm, config);
+    rxfsm_set_output(&engine->fsm, engine->frame, ENGINE_RX_MAX_FRAME);
+}
+
+void rx_engine_configure(rx_engine_t* engine, const rxfsm_config_t* config) {
+    engine->pending = *config;
+    engine->reconfigure = 1;
+}
+
+// Новая настройка между кадрами. Смена одного порога не сбрасывает начатый поиск синхропоследовательности
+static void rx_engine_apply(rx_engine_t* engine) {
+    const rxfsm_config_t* config = &engine->pending;
+    const rxfsm_config_t* current = &engine->fsm.config;
+    engine->reconfigure = 0;
+    if (config->frequency == current->frequency && config->autorate_max == current->autorate_max &&
+        config->integrate == current->integrate && config->eq == current->eq) {
+        engine->fsm.config.threshold = config->threshold;
+        return;
+    }
+    const rxfsm_stats_t stats = engine->fsm.stats;
+    rxfsm_init(&engine->fsm, config);
+    engine->fsm.stats = stats;
+    rxfsm_set_output(&engine->fsm, engine->frame, ENGINE_RX_MAX_FRAME);
+}
+
+LIFI_HOT int rx_engine_step(coop_task_t* task, const int64_t now_us) {
+    rx_engine_t* engine = (rx_engine_t*)task;
+    PT_BEGIN(&task->pt);
+    while (1) {
+        if (engine->reconfigure && engine->fsm.state == RXFSM_HUNT) {
+            rx_engine_apply(engine);
+        }
+        const int len = rxfsm_feed(&engine->fsm, now_us, engine->io->adc_read());
+        if (len >= 0) {
+            if (len > 0 && engine->deliver) {
+                engine->deliver(engine->frame, len);
+            }
+            rxfsm_set_output(&engine->fsm, engine->frame, ENGINE_RX_MAX_FRAME);
+        }
+        COOP_SLEEP_UNTIL(task, now_us + rxfsm_sample_delay_us(&engine->fsm));
+    }
+    PT_END(&task->pt);
+}
+
+void calib_engine_init(calib_engine_t* engine, const engine_io_t* io, void (*apply)(const calib_result_t* result)) {
+    memset(engine, 0, sizeof(*engine));
+    engine->io = io;
+    engine->apply = apply;
+}
+
+int calib_engine_step(coop_task_t* task, const int64_t now_us) {
+    calib_engine_t* engine = (calib_engine_t*)task;
+    PT_BEGIN(&task->pt);
+    while (1) {
+        calib_reset(&engine->histogram);
+        while (engine->histogram.total < CALIB_SAMPLES) {
+            calib_add(&engine->histogram, engine->io->adc_read());
+            COOP_SLEEP_UNTIL(task, now_us + ENGINE_CALIB_INTERVAL_US);
+        }
+        calib_result_t result;
+        if (calib_otsu(&engine->histogram, &result) == 0 && engine->apply) {
+            engine->apply(&result);
+            ++engine->updates;
+        }
+    }
+    PT_END(&task->pt);
+}
+
+// Опрос выключенного мигания
+#define BLINK_IDLE_POLL_US 10000
+
+void blink_engine_init(blink_engine_t* engine, const engine_io_t* io, const tx_engine_t* tx) {
+    memset(engine, 0, sizeof(*engine));
+    engine->io = io;
+    engine->tx = tx;
+}
+
+int blink_engine_step(coop_task_t* task, const int64_t now_us) {
+    blink_engine_t* engine = (blink_engine_t*)task;
+    PT_BEGIN(&task->pt);
+    while (1) {
+        if (engine->frequency <= 0 || tx_engine_busy(engine->tx)) {
+            // Светодиод отдан передатчику или гаснет после выключения мигания
+            if (engine->level && !tx_engine_busy(engine->tx)) {
+                engine->io->led_set(0);
+            }
+            engine->level = 0;
+            COOP_SLEEP_UNTIL(task, now_us + BLINK_IDLE_POLL_US);
+            continue;
+        }
+        engine->level = !engine->level;
+        engine->io->led_set(engine->level);
+        COOP_SLEEP_UNTIL(task, now_us + 500000 / engine->frequency);
+    }
+    PT_END(&task->pt);
+}
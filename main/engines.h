@@ -0,0 +1,89 @@
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <stdint.h>
+
+#include "calib.h"
+#include "coop.h"
+#include "rxfsm.h"
+
+// Движки передачи, приёма, калибровки и мигания как протопотоки планировщика coop.
+// Каждый шаг - один полубит, один отсчёт АЦП или одно переключение светодиода, ожидание - сон до момента,
+// поэтому движки чередуются на одном ядре с точностью до длительности шага
+
+// Доступ к оборудованию, в прошивке - АЦП и GPIO светодиода
+typedef struct {
+    int (*adc_read)(void);
+    void (*led_set)(int level);
+} engine_io_t;
+
+// Полупериод синхропоследовательности и пауза после неё, как в send_sync_seq()
+#define ENGINE_SYNC_HALF_PERIOD_US 20000
+#define ENGINE_SYNC_HALF_BITS 16
+// Наибольший кадр приёма: все полубиты автомата
+#define ENGINE_RX_MAX_FRAME (RXFSM_MAX_HALF_BITS / 16)
+// Шаг фоновой калибровки
+#define ENGINE_CALIB_INTERVAL_US 100
+
+// Передача манчестерского кадра: синхропоследовательность, метка скорости, данные
+typedef struct {
+    coop_task_t task;
+    const engine_io_t* io;
+    const uint8_t* data; // Кадр на передаче, NULL - передатчик свободен
+    int len;
+    int frequency;
+    int index; // Полубит кадра
+    int total;
+    int64_t start_us;
+    int64_t data_start_us;
+    uint32_t frames;
+} tx_engine_t;
+
+void tx_engine_init(tx_engine_t* engine, const engine_io_t* io);
+// Постановка кадра. Данные должны жить до конца передачи. -1, если передатчик занят
+int tx_engine_send(tx_engine_t* engine, const uint8_t* data, int len, int frequency);
+int tx_engine_busy(const tx_engine_t* engine);
+int tx_engine_step(coop_task_t* task, int64_t now_us);
+
+// Непрерывный приём автоматом rxfsm, отсчёт за шаг
+typedef struct {
+    coop_task_t task;
+    const engine_io_t* io;
+    rxfsm_t fsm;
+    rxfsm_config_t pending; // Новая настройка, применяется между кадрами
+    int reconfigure;
+    void (*deliver)(const uint8_t* data, int len);
+    uint8_t frame[ENGINE_RX_MAX_FRAME];
+} rx_engine_t;
+
+void rx_engine_init(rx_engine_t* engine, const engine_io_t* io, const rxfsm_config_t* config,
+                    void (*deliver)(const uint8_t* data, int len));
+void rx_engine_configure(rx_engine_t* engine, const rxfsm_config_t* config);
+int rx_engine_step(coop_task_t* task, int64_t now_us);
+
+// Фоновая калибровка: гистограмма по отсчёту за шаг, по заполнении - порог по методу Оцу.
+// Различимый результат передаётся в apply, выборка без двух уровней пропускается
+typedef struct {
+    coop_task_t task;
+    const engine_io_t* io;
+    calib_histogram_t histogram;
+    void (*apply)(const calib_result_t* result);
+    uint32_t updates;
+} calib_engine_t;
+
+void calib_engine_init(calib_engine_t* engine, const engine_io_t* io, void (*apply)(const calib_result_t* result));
+int calib_engine_step(coop_task_t* task, int64_t now_us);
+
+// Мигание с заданной частотой, пока передатчик свободен
+typedef struct {
+    coop_task_t task;
+    const engine_io_t* io;
+    const tx_engine_t* tx;
+    volatile int frequency; // 0 - выключено
+    int level;
+} blink_engine_t;
+
+void blink_engine_init(blink_engine_t* engine, const engine_io_t* io, const tx_engine_t* tx);
+int blink_engine_step(coop_task_t* task, int64_t now_us);
+
+#endif //ENGINES_H
@@ -0,0 +1,64 @@
+#include "eq.h"
+
+void eq_reset(eq_t* eq) {
+    eq->c0 = EQ_ONE;
+    eq->c1 = 0;
+    eq->pole = 0;
+    eq->previous = 0;
+}
+
+int eq_train(eq_t* eq, const int* samples, const int count) {
+    eq_reset(eq);
+    if (count < 8) {
+        return 0;
+    }
+    // Установившийся низкий уровень и дисперсия шума - по последней четверти окна
+    int64_t tail = 0;
+    int64_t tail_power = 0;
+    for (int i = count - count / 4; i < count; ++i) {
+        tail += samples[i];
+        tail_power += (int64_t)samples[i] * samples[i];
+    }
+    const int low = tail / (count / 4);
+    const int64_t noise_power = tail_power / (count / 4) - (int64_t)low * low;
+
+    // x[n] - L = a * (x[n-1] - L) по отсчётам, где спад ещё заметен
+    int64_t cross = 0;
+    int64_t power = 0;
+    int used = 0;
+    for (int i = 1; i < count; ++i) {
+        const int64_t before = samples[i - 1] - low;
+        if (before < EQ_MIN_STEP) {
+            break;
+        }
+        cross += before * (samples[i] - low);
+        power += before * before;
+        ++used;
+    }
+    if (used < 2 || power == 0 || cross <= 0) {
+        return 0;
+    }
+
+    int32_t pole = (int32_t)((cross << EQ_FRAC_BITS) / power);
+    if (pole > EQ_MAX_POLE_Q) {
+        pole = EQ_MAX_POLE_Q;
+    }
+    // Шум на выходе: sigma^2 * (1 + a^2) / (1 - a)^2
+    while (pole > 0) {
+        const int64_t numerator = ((int64_t)EQ_ONE * EQ_ONE + (int64_t)pole * pole) * noise_power;
+        const int64_t denominator = (int64_t)(EQ_ONE - pole) * (EQ_ONE - pole);
+        if (numerator <= denominator * EQ_MAX_NOISE * EQ_MAX_NOISE) {
+            break;
+        }
+        pole -= EQ_ONE / 32;
+    }
+    if (pole <= 0) {
+        return 0;
+    }
+    // Обращение однополюсного канала: c0 = 1 / (1 - a), c1 = -a / (1 - a)
+    const int32_t gain = EQ_ONE - pole;
+    eq->pole = pole;
+    eq->c0 = ((int64_t)EQ_ONE << EQ_FRAC_BITS) / gain;
+    eq->c1 = -(((int64_t)pole << EQ_FRAC_BITS) / gain);
+    return 1;
+}
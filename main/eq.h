@@ -0,0 +1,45 @@
+#ifndef EQ_H
+#define EQ_H
+
+#include <stdint.h>
+
+// Дробных бит в коэффициентах фильтра
+#define EQ_FRAC_BITS 12
+#define EQ_ONE (1 << EQ_FRAC_BITS)
+// Наибольший полюс канала, который компенсируется полностью. Обратный фильтр усиливает шум в (1 + a) / (1 - a) раз,
+// поэтому более медленный спад компенсируется частично
+#define EQ_MAX_POLE_Q (EQ_ONE * 7 / 8)
+// Наибольший шум после эквалайзера (СКО в отсчётах АЦП), треть порога фронта в 300 отсчётов.
+// Если обращение канала усилит шум сильнее, полюс компенсируется частично
+#define EQ_MAX_NOISE 100
+// Отсчёты спада, отличающиеся от установившегося уровня меньше, считаются шумом и в оценку не идут
+#define EQ_MIN_STEP 24
+
+// Двухотводный КИХ-эквалайзер: y[n] = c0 * x[n] + c1 * x[n-1]. Светодиод и фотодиод с медленным спадом
+// ведут себя как однополюсный фильтр x[n] = a * x[n-1] + (1 - a) * s[n], эквалайзер - его обращение
+typedef struct {
+    int32_t c0;
+    int32_t c1;
+    int32_t pole;  // Оценка полюса канала, Q EQ_FRAC_BITS
+    int previous;  // x[n-1]
+} eq_t;
+
+// Без коррекции: y = x
+void eq_reset(eq_t* eq);
+
+// Оценка полюса по спаду после последнего фронта синхропоследовательности (известный переход в низкий уровень)
+// методом наименьших квадратов и расчёт коэффициентов. Возвращает 1, если спад был заметен и фильтр обучен
+int eq_train(eq_t* eq, const int* samples, int count);
+
+// Начало кадра: история фильтра заполняется первым отсчётом
+static inline void eq_start(eq_t* eq, const int sample) {
+    eq->previous = sample;
+}
+
+static inline int eq_apply(eq_t* eq, const int sample) {
+    const int32_t y = (eq->c0 * sample + eq->c1 * eq->previous) >> EQ_FRAC_BITS;
+    eq->previous = sample;
+    return y > 0 ? y : 0;
+}
+
+#endif //EQ_H
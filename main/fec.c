@@ -0,0 +1,115 @@
+#include "fec.h"
+
+#include <string.h>
+
+#define FEC_POLY_A 0171
+#define FEC_POLY_B 0133
+#define FEC_STATES (1 << FEC_TAIL_BITS)
+#define FEC_MAX_STEPS (FEC_MAX_DATA * 8 + FEC_TAIL_BITS)
+
+// Решения ACS по шагам: бит s - в состояние s пришли из старшего предшественника
+static uint64_t decisions[FEC_MAX_STEPS];
+// Выход кодера при переходе из состояния j входным нулём (2 бита: A, B)
+static uint8_t butterfly_output[FEC_STATES / 2];
+static int tables_ready = 0;
+
+static int parity(unsigned value) {
+    value ^= value >> 4;
+    value ^= value >> 2;
+    value ^= value >> 1;
+    return value & 1;
+}
+
+// Выход кодера для 7-битного регистра (новый бит - младший)
+static uint8_t encoder_output(const unsigned reg) {
+    return parity(reg & FEC_POLY_A) << 1 | parity(reg & FEC_POLY_B);
+}
+
+static void init_tables(void) {
+    for (int j = 0; j < FEC_STATES / 2; ++j) {
+        butterfly_output[j] = encoder_output(j << 1);
+    }
+    tables_ready = 1;
+}
+
+int fec_encode(const uint8_t* data, const int len, uint8_t* coded) {
+    const int size = FEC_CODED_SIZE(len);
+    memset(coded, 0, size);
+    unsigned reg = 0;
+    int out = 0;
+    for (int i = 0; i < len * 8 + FEC_TAIL_BITS; ++i) {
+        const int bit = i < len * 8 ? (data[i / 8] >> (7 - i % 8)) & 1 : 0;
+        reg = ((reg << 1) | bit) & 0x7F;
+        const uint8_t symbol = encoder_output(reg);
+        coded[out / 8] |= (symbol >> 1) << (7 - out % 8);
+        ++out;
+        coded[out / 8] |= (symbol & 1) << (7 - out % 8);
+        ++out;
+    }
+    return size;
+}
+
+int fec_decode(const int8_t* soft, const int bits, uint8_t* data, const int max_len) {
+    if (!tables_ready) {
+        init_tables();
+    }
+    int steps = bits / 2;
+    if (steps > FEC_MAX_STEPS) {
+        steps = FEC_MAX_STEPS;
+    }
+    int len = (steps - FEC_TAIL_BITS) / 8;
+    if (len > max_len) {
+        len = max_len;
+    }
+    if (len <= 0) {
+        return 0;
+    }
+    steps = len * 8 + FEC_TAIL_BITS;
+
+    // Метрики путей (больше - лучше). Кодер стартует из нулевого состояния
+    int32_t metrics[2][FEC_STATES];
+    for (int s = 0; s < FEC_STATES; ++s) {
+        metrics[0][s] = s == 0 ? 0 : -(1 << 24);
+    }
+
+    for (int t = 0; t < steps; ++t) {
+        const int32_t* old = metrics[t & 1];
+        int32_t* new = metrics[(t + 1) & 1];
+        const int a = soft[2 * t];
+        const int b = soft[2 * t + 1];
+        // Корреляция с четырьмя возможными парами выходных битов
+        const int32_t branch[4] = {-a - b, -a + b, a - b, a + b};
+        uint64_t decision = 0;
+
+        // Бабочка: из j и j + 32 в 2j и 2j + 1. Старший бит регистра и новый бит входят в оба полинома,
+        // поэтому у остальных трёх переходов бабочки метрика ветви та же по модулю
+        for (int j = 0; j < FEC_STATES / 2; ++j) {
+            const int32_t bm = branch[butterfly_output[j]];
+            const int32_t low = old[j];
+            const int32_t high = old[j + FEC_STATES / 2];
+            const int32_t zero_low = low + bm;
+            const int32_t zero_high = high - bm;
+            const int32_t one_low = low - bm;
+            const int32_t one_high = high + bm;
+            const int zero_from_high = zero_high > zero_low;
+            const int one_from_high = one_high > one_low;
+            new[2 * j] = zero_from_high ? zero_high : zero_low;
+            new[2 * j + 1] = one_from_high ? one_high : one_low;
+            decision |= (uint64_t)zero_from_high << (2 * j);
+            decision |= (uint64_t)one_from_high << (2 * j + 1);
+        }
+        decisions[t] = decision;
+    }
+
+    // Хвост возвращает кодер в нулевое состояние - обратный проход начинается с него
+    memset(data, 0, len);
+    unsigned state = 0;
+    for (int t = steps - 1; t >= 0; --t) {
+        const int bit = state & 1;
+        if (t < len * 8) {
+            data[t / 8] |= bit << (7 - t % 8);
+        }
+        state = (state >> 1) | (unsigned)((decisions[t] >> state) & 1) << (FEC_TAIL_BITS - 1);
+    }
+    return len;
+}
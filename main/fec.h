@@ -0,0 +1,24 @@
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+
+// Свёрточный код скорости 1/2, длина ограничения K = 7, порождающие полиномы 171 и 133 (восьмеричные)
+#define FEC_CONSTRAINT 7
+#define FEC_TAIL_BITS (FEC_CONSTRAINT - 1)
+// Наибольший блок данных, кодируемый в одном кадре. Больше - разбивается на несколько кадров
+#define FEC_MAX_DATA 128
+// Размер кодированного блока в байтах: два бита на бит данных и хвост, дополненный до байта
+#define FEC_CODED_SIZE(len) (2 * (len) + 2)
+// Мягкое решение по биту: знак - значение (больше нуля - единица), модуль - уверенность
+#define FEC_SOFT_MAX 127
+
+// Кодирование блока (не более FEC_MAX_DATA байт), регистр в конце сбрасывается нулевым хвостом
+// Возвращает число байт кодированного блока
+int fec_encode(const uint8_t* data, int len, uint8_t* coded);
+
+// Декодирование Витерби по мягким решениям принятых кодированных битов
+// Возвращает число восстановленных байт
+int fec_decode(const int8_t* soft, int bits, uint8_t* data, int max_len);
+
+#endif //FEC_H
@@ -0,0 +1,61 @@
+#include "fft.h"
+
+#include <math.h>
+
+#include "perf.h"
+
+// cos и sin угла 2*pi*i/FFT_MAX_SIZE для первой половины оборота
+static LIFI_HOT_DATA int16_t twiddle_cos[FFT_MAX_SIZE / 2];
+static LIFI_HOT_DATA int16_t twiddle_sin[FFT_MAX_SIZE / 2];
+static int fft_ready = 0;
+
+void fft_init(void) {
+    if (fft_ready) {
+        return;
+    }
+    for (int i = 0; i < FFT_MAX_SIZE / 2; ++i) {
+        const double angle = 2 * M_PI * i / FFT_MAX_SIZE;
+        twiddle_cos[i] = (int16_t)lround(cos(angle) * 32767);
+        twiddle_sin[i] = (int16_t)lround(sin(angle) * 32767);
+    }
+    fft_ready = 1;
+}
+
+LIFI_HOT void fft_q15(fft_complex_t* data, const int log2n, const int inverse) {
+    const int n = 1 << log2n;
+
+    // Перестановка в бит-реверсном порядке
+    for (int i = 1, j = 0; i < n; ++i) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            const fft_complex_t tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    }
+
+    // Бабочки с прореживанием по времени: W = exp(-+2*pi*i*k/len), знак синуса задаёт направление
+    for (int len = 2, stride = FFT_MAX_SIZE / 2; len <= n; len <<= 1, stride >>= 1) {
+        const int half = len >> 1;
+        for (int start = 0; start < n; start += len) {
+            for (int k = 0; k < half; ++k) {
+                const int32_t wr = twiddle_cos[k * stride];
+                const int32_t wi = inverse ? twiddle_sin[k * stride] : -twiddle_sin[k * stride];
+                fft_complex_t* a = &data[start + k];
+                fft_complex_t* b = &data[start + k + half];
+                const int32_t tr = (b->re * wr - b->im * wi) >> 15;
+                const int32_t ti = (b->re * wi + b->im * wr) >> 15;
+                const int32_t ar = a->re;
+                const int32_t ai = a->im;
+                a->re = (ar + tr) >> 1;
+                a->im = (ai + ti) >> 1;
+                b->re = (ar - tr) >> 1;
+                b->im = (ai - ti) >> 1;
+            }
+        }
+    }
+}
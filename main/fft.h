@@ -0,0 +1,23 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+
+// Наибольший размер преобразования, под него строится таблица поворотных множителей
+#define FFT_MAX_LOG2 8
+#define FFT_MAX_SIZE (1 << FFT_MAX_LOG2)
+
+// Комплексный отсчёт в формате Q15
+typedef struct {
+    int16_t re;
+    int16_t im;
+} fft_complex_t;
+
+// Таблица поворотных множителей, вызывается один раз до первого преобразования
+void fft_init(void);
+
+// БПФ по основанию 2 на месте, размер 2^log2n. Каждый каскад делит результат на 2, чтобы не было переполнения,
+// поэтому прямое преобразование даёт DFT / n, обратное - ровно IDFT
+void fft_q15(fft_complex_t* data, int log2n, int inverse);
+
+#endif //FFT_H
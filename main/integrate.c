@@ -0,0 +1,95 @@
+#include "integrate.h"
+
+#include <string.h>
+
+#include "perf.h"
+
+void integrate_start(integrate_t* integrator, const int half_period_us, const int64_t start_us, const int level) {
+    memset(integrator, 0, sizeof(*integrator));
+    integrator->half_period_us = half_period_us;
+    integrator->window_start = start_us;
+    integrator->last_sample_us = start_us;
+    integrator->side = level;
+    integrator->cross_us = start_us;
+}
+
+// Закрытие окон, конец которых наступил к now_us. Окно без отсчётов повторяет предыдущее
+static LIFI_HOT void close_windows(integrate_t* integrator, const int64_t now_us) {
+    while (now_us >= integrator->window_start + integrator->half_period_us) {
+        float value;
+        if (integrator->count > 0) {
+            value = integrator->sum / integrator->count;
+        } else if (integrator->held_count > 0) {
+            value = integrator->held[integrator->held_count - 1];
+        } else {
+            value = 0;
+        }
+        if (integrator->held_count < INTEGRATE_HELD) {
+            integrator->held[integrator->held_count++] = value;
+        }
+        integrator->window_start += integrator->half_period_us;
+        integrator->sum = 0;
+        integrator->count = 0;
+    }
+}
+
+LIFI_HOT void integrate_sample(integrate_t* integrator, const int64_t now_us, const float value) {
+    close_windows(integrator, now_us);
+    const int side = value >= 1;
+    if (side != integrator->side) {
+        integrator->side = side;
+        integrator->cross_uncertainty_us = (int)(now_us - integrator->last_sample_us) / 2;
+        integrator->cross_us = now_us - integrator->cross_uncertainty_us;
+        integrator->side_sum = 0;
+        integrator->side_count = 0;
+    }
+    integrator->sum += value;
+    ++integrator->count;
+    integrator->side_sum += value;
+    ++integrator->side_count;
+    integrator->last_sample_us = now_us;
+}
+
+LIFI_HOT int integrate_edge(integrate_t* integrator, const int64_t now_us, const int level, float out[INTEGRATE_HELD]) {
+    // Отсчёты уже перешли порог - фронт на пересечении, иначе между прошлым отсчётом и этим
+    const int crossed = integrator->side == level;
+    int64_t edge_us;
+    int64_t uncertainty;
+    if (crossed) {
+        edge_us = integrator->cross_us;
+        uncertainty = integrator->cross_uncertainty_us;
+    } else {
+        uncertainty = (now_us - integrator->last_sample_us) / 2;
+        edge_us = now_us - uncertainty;
+    }
+    close_windows(integrator, edge_us);
+    const int64_t offset = edge_us - integrator->window_start;
+    const int64_t tolerance = integrator->half_period_us / INTEGRATE_EDGE_WINDOW_DIV + uncertainty;
+    const int boundary = offset < 0 ? -offset <= tolerance
+                                    : offset <= tolerance || offset >= integrator->half_period_us - tolerance;
+    // Фронт посреди окна - помеха, пока новый уровень не продержится полполупериода: тогда окна сбились с фазы
+    if (!boundary && now_us - edge_us < integrator->half_period_us / 2) {
+        return -1;
+    }
+    // Если окно закрылось отсчётами уже после фронта, начатое окно целиком от нового участка. Иначе окно,
+    // набранное больше чем наполовину, - последний полубит участка, а отсчёты до фронта из меньшей части
+    // отбрасываются
+    if (offset >= 0) {
+        const int before = integrator->count - (crossed ? integrator->side_count : 0);
+        if (offset > integrator->half_period_us / 2 && before > 0 && integrator->held_count < INTEGRATE_HELD) {
+            const float before_sum = integrator->sum - (crossed ? integrator->side_sum : 0);
+            integrator->held[integrator->held_count++] = before_sum / before;
+        }
+        integrator->sum = crossed ? integrator->side_sum : 0;
+        integrator->count = crossed ? integrator->side_count : 0;
+    }
+    integrator->window_start = edge_us;
+    const int count = integrator->held_count;
+    memcpy(out, integrator->held, count * sizeof(out[0]));
+    integrator->held_count = 0;
+    return count;
+}
+
+float integrate_tail(const integrate_t* integrator, const float fallback) {
+    return integrator->held_count > 0 ? integrator->held[0] : fallback;
+}
@@ -0,0 +1,46 @@
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+#include <stdint.h>
+
+// Интегрирование полубитов (integrate-and-dump): полубит - среднее отсчётов окна длиной в полупериод,
+// окна идут от последнего фронта метки. Фронт только подстраивает границу окон, поэтому длинный участок
+// делится на полубиты по полупериоду, а одиночная помеха внутри окна не добавляет полубитов
+
+// Фронт дальше такой доли полупериода от границы окна (плюс неопределённость момента между отсчётами) - помеха
+#define INTEGRATE_EDGE_WINDOW_DIV 4
+// Окна после последнего фронта: тишина после кадра длится RATE_MAX_DELAY_PERIOD_US, это 10 полупериодов
+#define INTEGRATE_HELD 16
+
+typedef struct {
+    int half_period_us;
+    int64_t window_start;
+    float sum;
+    int count;
+    int64_t last_sample_us;
+    // Пересечение порога: фронт подтверждается позже, когда отсчёт отойдёт от прошлого уровня на порог фронта,
+    // поэтому момент фронта и отсчёты нового уровня берутся с пересечения
+    int side;
+    int64_t cross_us;
+    int cross_uncertainty_us;
+    float side_sum;
+    int side_count;
+    // Закрытые окна после последнего фронта: становятся полубитами только на следующем фронте
+    float held[INTEGRATE_HELD];
+    int held_count;
+} integrate_t;
+
+void integrate_start(integrate_t* integrator, int half_period_us, int64_t start_us, int level);
+
+// Отсчёт value (в долях порога) в момент now_us
+void integrate_sample(integrate_t* integrator, int64_t now_us, float value);
+
+// Фронт к уровню level, подтверждённый отсчётом now_us до его integrate_sample(). Возвращает -1, если фронт дальше
+// допуска от границы окна и новый уровень держится меньше полполупериода (помеха), иначе граница переносится
+// на фронт, а придержанные окна - полубиты участка до фронта - копируются в out
+int integrate_edge(integrate_t* integrator, int64_t now_us, int level, float out[INTEGRATE_HELD]);
+
+// Первое окно после последнего фронта - последний полубит кадра, слившийся с паузой; fallback - если окон нет
+float integrate_tail(const integrate_t* integrator, float fallback);
+
+#endif //INTEGRATE_H
@@ -0,0 +1,134 @@
+#include "lzss.h"
+
+#include <string.h>
+
+enum {
+    LZSS_STATE_FLAGS = 0,
+    LZSS_STATE_ITEM,
+    LZSS_STATE_LENGTH,
+};
+
+int lzss_compress(const uint8_t* data, const int len, uint8_t* out, const int max_out) {
+    int in = 0;
+    int size = 0;
+    int flags_at = -1;
+    int items = 8;
+    while (in < len) {
+        if (items == 8) {
+            if (size >= max_out) {
+                return -1;
+            }
+            flags_at = size++;
+            out[flags_at] = 0;
+            items = 0;
+        }
+
+        // Поиск самого длинного совпадения в окне, ближайшее - при равной длине
+        int best_length = 0;
+        int best_distance = 0;
+        const int max_length = len - in < LZSS_MAX_MATCH ? len - in : LZSS_MAX_MATCH;
+        if (max_length >= LZSS_MIN_MATCH) {
+            const int window = in < LZSS_WINDOW ? in : LZSS_WINDOW;
+            for (int distance = 1; distance <= window; ++distance) {
+                const uint8_t* candidate = data + in - distance;
+                if (candidate[0] != data[in] || candidate[best_length] != data[in + best_length]) {
+                    continue;
+                }
+                int length = 1;
+                // Совпадение может заходить на ещё не выданные байты (повторы коротких последовательностей)
+                while (length < max_length && candidate[length] == data[in + length]) {
+                    ++length;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = distance;
+                    if (length == max_length) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (best_length >= LZSS_MIN_MATCH) {
+            if (size + 2 > max_out) {
+                return -1;
+            }
+            out[size++] = best_distance - 1;
+            out[size++] = best_length - LZSS_MIN_MATCH;
+            in += best_length;
+        } else {
+            if (size >= max_out) {
+                return -1;
+            }
+            out[flags_at] |= 1 << items;
+            out[size++] = data[in++];
+        }
+        ++items;
+    }
+    return size;
+}
+
+int lzss_pack_frame(const uint8_t* data, const int len, uint8_t* out) {
+    // Сжатые данные должны быть строго короче исходных, иначе кадр уходит без сжатия
+    const int compressed = lzss_compress(data, len, out + LZSS_HEADER_SIZE, len - 1);
+    if (compressed > 0) {
+        out[0] = LZSS_FLAG_COMPRESSED;
+        return compressed + LZSS_HEADER_SIZE;
+    }
+    out[0] = 0;
+    memcpy(out + LZSS_HEADER_SIZE, data, len);
+    return len + LZSS_HEADER_SIZE;
+}
+
+void lzss_decoder_reset(lzss_decoder_t* decoder, const uint8_t flags) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->raw = !(flags & LZSS_FLAG_COMPRESSED);
+    decoder->state = LZSS_STATE_FLAGS;
+}
+
+static void emit(lzss_decoder_t* decoder, const uint8_t byte, uint8_t* out, int* count) {
+    decoder->window[decoder->position++] = byte;
+    out[(*count)++] = byte;
+}
+
+int lzss_decoder_feed(lzss_decoder_t* decoder, const uint8_t byte, uint8_t* out) {
+    int count = 0;
+    if (decoder->raw) {
+        out[count++] = byte;
+        return count;
+    }
+    switch (decoder->state) {
+        case LZSS_STATE_FLAGS:
+            decoder->flags = byte;
+            decoder->items = 8;
+            decoder->state = LZSS_STATE_ITEM;
+            break;
+        case LZSS_STATE_ITEM:
+            if (decoder->flags & 1) {
+                emit(decoder, byte, out, &count);
+            } else {
+                decoder->offset = byte;
+                decoder->state = LZSS_STATE_LENGTH;
+                break;
+            }
+            decoder->flags >>= 1;
+            if (--decoder->items == 0) {
+                decoder->state = LZSS_STATE_FLAGS;
+            }
+            break;
+        case LZSS_STATE_LENGTH: {
+            // Копирование побайтно: источник может перекрываться с только что записанными байтами
+            const int length = byte + LZSS_MIN_MATCH;
+            const uint8_t distance = decoder->offset + 1;
+            for (int i = 0; i < length; ++i) {
+                emit(decoder, decoder->window[(uint8_t)(decoder->position - distance)], out, &count);
+            }
+            decoder->flags >>= 1;
+            decoder->state = --decoder->items == 0 ? LZSS_STATE_FLAGS : LZSS_STATE_ITEM;
+            break;
+        }
+        default:
+            break;
+    }
+    return count;
+}
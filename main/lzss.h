@@ -0,0 +1,43 @@
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stdint.h>
+
+// Окно словаря: ссылка кодируется одним байтом смещения
+#define LZSS_WINDOW 256
+// Совпадение короче не выгоднее литералов, длина кодируется одним байтом от этого минимума
+#define LZSS_MIN_MATCH 3
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + 255)
+
+// Заголовок кадра: один байт флагов перед полезной нагрузкой
+#define LZSS_HEADER_SIZE 1
+#define LZSS_FLAG_COMPRESSED 0x01
+
+// Сжатие блока: группы из байта флагов (1 - литерал, 0 - ссылка) и до 8 элементов,
+// ссылка - два байта: смещение назад - 1 и длина - LZSS_MIN_MATCH
+// Возвращает размер сжатых данных или -1, если они не помещаются в max_out
+int lzss_compress(const uint8_t* data, int len, uint8_t* out, int max_out);
+
+// Кадр для передачи: заголовок и сжатые данные, либо исходные данные, если сжатие не уменьшает размер
+// out должен вмещать len + LZSS_HEADER_SIZE байт. Возвращает размер кадра
+int lzss_pack_frame(const uint8_t* data, int len, uint8_t* out);
+
+// Потоковый распаковщик: данные подаются по байту по мере декодирования, окно хранится внутри
+typedef struct {
+    uint8_t window[LZSS_WINDOW];
+    uint8_t position; // Следующая позиция записи в окне (переполняется по модулю 256)
+    uint8_t flags;    // Флаги текущей группы
+    uint8_t items;    // Сколько элементов группы осталось
+    uint8_t offset;   // Смещение ссылки, ожидающей байта длины
+    uint8_t state;
+    uint8_t raw;      // Кадр без сжатия - байты выдаются как есть
+} lzss_decoder_t;
+
+// Начало кадра: flags - байт заголовка
+void lzss_decoder_reset(lzss_decoder_t* decoder, uint8_t flags);
+
+// Подача одного принятого байта. out должен вмещать LZSS_MAX_MATCH байт
+// Возвращает число распакованных байт
+int lzss_decoder_feed(lzss_decoder_t* decoder, uint8_t byte, uint8_t* out);
+
+#endif //LZSS_H
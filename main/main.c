@@ -1,15 +1,34 @@
+#include <arq.h>
+#include <bench.h>
+#include <bufpool.h>
+#include <calib.h>
+#include <console.h>
+#include <coop.h>
+#include <csk.h>
+#include <engines.h>
+#include <prbs.h>
+#include <rates.h>
+#include <ratectl.h>
 #include <esp_log.h>
 #include <esp_log_level.h>
 #include <esp_task_wdt.h>
+#include <ofdm.h>
 #include <receiver.h>
 #include <rtc_wdt.h>
+#include <perf.h>
+#include <ppm.h>
 #include <sender.h>
+#include <tdma.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include "esp_random.h"
+#include "esp_system.h"
 #include "esp_timer.h"
+#include "nvs_flash.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,11 +48,18 @@
 #define MAX_FREQ         500000
 #define BLINK_TIME_SECS 2
 
+// Пространство имён NVS для сохранённой калибровки
+#define CALIB_NVS_NAMESPACE "lifi"
+// Отсчётов для проверки фона при старте
+#define CALIB_AMBIENT_CHECK_SAMPLES 64
+
 // Глобальная переменная для частоты передачи (битовая частота в Гц)
 // Может быть изменена командой вида "#FREQ <значение>"
 volatile int frequency = 100;
 volatile int blink_frequency = 100;
 volatile int threshold = 110;
+// Средний отсчёт без света передатчика по последней калибровке, -1 - неизвестен
+volatile int ambient_level = -1;
 volatile bool normalRead = 0;
 volatile bool rawRead = 0;
 volatile bool binRead = 0;
@@ -41,45 +67,469 @@ volatile bool readMode = 0;
 volatile bool blinkMode = 0;
 volatile bool duplexMode = 0;
 volatile bool infTest = 0;
+volatile bool arqMode = 0;
+// Измерение ошибок по псевдослучайной последовательности, команда "#PRBS TX|RX <7|15|31>"
+volatile bool prbsTx = 0;
+volatile bool prbsRx = 0;
+// Разделение канала по времени между несколькими передатчиками, команды "#NODE <адрес>", "#COORD [слот мс]", "#TDMA"
+volatile bool tdmaCoordinator = 0;
+volatile bool tdmaNode = 0;
+volatile int node_address = 1;
+// Модуляция передачи через адресный светодиод, меняется командой "#CSK <режим>"
+volatile csk_mode_t cskMode = CSK_MODE_OFF;
+
+// Импульсно-позиционная модуляция вместо манчестерского кода, команда "#PPM 4|8|16|OFF" (0 - выключена)
+volatile int ppmOrder = 0;
+
+// Экспериментальная DCO-OFDM через ЦАП, отсчётов в секунду - частота #FREQ. Команда "#OFDM ON|OFF|LOAD <биты>"
+volatile bool ofdmMode = 0;
+// Бит на поднесущую при передаче, по умолчанию QPSK на всех
+static ofdm_loading_t ofdm_loading;
+
+// Свёрточное кодирование передачи и декодирование Витерби при приёме, команда "#FEC 1|0"
+volatile bool fecMode = 0;
+// Сжатие кадров перед передачей и распаковка при приёме, команда "#LZ 1|0"
+volatile bool lzssMode = 0;
+// Объединение мелких записей UART в один кадр, команда "#BATCH <байт> <мс>|OFF"
+volatile bool batchMode = 0;
+
+// Передача, приём, фоновая калибровка, мигание и UART протопотоками одного планировщика на одном ядре,
+// команда "#COOP ON|OFF|BLINK <Гц>"
+volatile bool coopMode = 0;
+volatile int coop_blink_frequency = 0;
+
+// Параметры надёжной передачи, окно меняется командой "#WIN <кадров>"
+#define ARQ_DEFAULT_WINDOW 8
+#define ARQ_MAX_RETRIES 10
+// Сколько приёмник ARQ слушает канал, прежде чем вернуться к опросу UART
+#define ARQ_LISTEN_TIMEOUT_US 200000
+volatile int arq_window = ARQ_DEFAULT_WINDOW;
+
+// Адаптация скорости в режиме ARQ, команда "#RATE AUTO [ppm]|OFF". Включается на обеих сторонах с одной базовой скоростью
+volatile bool autoRate = 0;
+static ratectl_t rate_control;
+
+// Сброс всех режимов работы перед включением нового
+static void reset_modes(void) {
+    rawRead = 0;
+    binRead = 0;
+    normalRead = 0;
+    readMode = 0;
+    blinkMode = 0;
+    duplexMode = 0;
+    infTest = 0;
+    arqMode = 0;
+    prbsTx = 0;
+    prbsRx = 0;
+    tdmaCoordinator = 0;
+    tdmaNode = 0;
+    coopMode = 0;
+}
 
-void found_threshold(void) {
-    printf("Scanning min and max value\n");
-    int max;
-    int min = max = adc1_get_raw(ADC1_CHANNEL_4);
-    for (int i = 0; i <= 4096; i++) {
-        const int v = adc1_get_raw(ADC1_CHANNEL_4);
-        if (max < v) {
-            max = v;
+// Калибровка порога за один проход по гистограмме. Порог меняется только при успехе
+bool found_threshold(void) {
+    static calib_histogram_t histogram;
+    calib_reset(&histogram);
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < CALIB_SAMPLES; i++) {
+        calib_add(&histogram, adc1_get_raw(ADC1_CHANNEL_4));
+        ets_delay_us(1);
+    }
+    calib_result_t result;
+    const int status = calib_otsu(&histogram, &result);
+    printf(
+        "Low: %d, High: %d, separability %d%%, %d samples in %lld ms\n", result.low, result.high,
+        result.separability_pct, CALIB_SAMPLES, (long long)((esp_timer_get_time() - start) / 1000)
+    );
+    if (status != 0) {
+        printf("Уровни не различаются, порог не изменён: включите мигание передатчика (#BLINK)\n");
+        return false;
+    }
+    threshold = result.threshold;
+    ambient_level = result.low;
+    printf("Set THR to %d\n", threshold);
+    return true;
+}
+
+// Сохранение порога и фоновой засветки, чтобы после перезагрузки приём работал сразу
+static void calibration_save(void) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(CALIB_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_i32(handle, "threshold", threshold);
+        if (err == ESP_OK) {
+            err = nvs_set_i32(handle, "ambient", ambient_level);
         }
-        if (min > v) {
-            min = v;
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
         }
-        ets_delay_us(1);
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        printf("Не удалось сохранить порог в NVS: 0x%x\n", err);
     }
-    const int middle = (min + max) / 2;
-    printf("Min: %d, Max: %d, Middle point: %d\nScanning for AVG low and high\n", min, max, middle);
-
-    long long int sum_low = 0;
-    int count_low = 0;
-    long long int sum_high = 0;
-    int count_high = 0;
-    for (int i = 0; i <= 50000; i++) {
-        const int v = adc1_get_raw(ADC1_CHANNEL_4);
-        if (v < middle) {
-            sum_low += v;
-            count_low++;
-        } else if (v > middle) {
-            sum_high += v;
-            count_high++;
+}
+
+static void calibration_load(void) {
+    nvs_handle_t handle;
+    if (nvs_open(CALIB_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    int32_t stored_threshold;
+    int32_t stored_ambient;
+    if (nvs_get_i32(handle, "threshold", &stored_threshold) == ESP_OK && stored_threshold > 0 &&
+        stored_threshold < 4096) {
+        threshold = stored_threshold;
+        if (nvs_get_i32(handle, "ambient", &stored_ambient) == ESP_OK) {
+            ambient_level = stored_ambient;
         }
-        ets_delay_us(1);
+        printf("Threshold %d loaded, ambient level %d\n", threshold, ambient_level);
+    }
+    nvs_close(handle);
+    if (ambient_level < 0 || ambient_level >= threshold) {
+        return;
     }
 
-    const int middle_low = (sum_low / count_low);
-    const int middle_high = (sum_high / count_high);
-    printf("Low: %d, High: %d\n", middle_low, middle_high);
-    threshold = (middle_low + 0.5 * (middle_high - middle_low));
-    printf("Set THR to %d\n", threshold);
+    // Фон мог измениться с момента калибровки: средний отсчёт ближе к порогу, чем к сохранённому фону
+    long long sum = 0;
+    for (int i = 0; i < CALIB_AMBIENT_CHECK_SAMPLES; i++) {
+        sum += adc1_get_raw(ADC1_CHANNEL_4);
+    }
+    const int current = sum / CALIB_AMBIENT_CHECK_SAMPLES;
+    if (current > ambient_level + (threshold - ambient_level) / 2 || current < ambient_level / 2) {
+        printf("Фоновая засветка %d вместо %d, выполните #ATHR\n", current, ambient_level);
+    }
+}
+
+// Оптический полудуплексный канал для ARQ поверх манчестерских кадров
+static void optical_send(const uint8_t* frame, const int len) {
+    send_manchester_frame(frame, len, frequency);
+}
+
+static int optical_receive(uint8_t* frame, const int max_len, const int64_t timeout_us) {
+    return receive_manchester_frame(threshold, frequency, frame, max_len, timeout_us);
+}
+
+static int64_t optical_now(void) {
+    return esp_timer_get_time();
+}
+
+static void uart_deliver(const uint8_t* data, const int len) {
+    console_write(UART_PORT_NUM, data, len);
+}
+
+static void optical_rate_observe(const int frame_valid) {
+    if (!autoRate) {
+        return;
+    }
+    int pairs;
+    int invalid;
+    receiver_last_frame_quality(&pairs, &invalid);
+    if (ratectl_observe(&rate_control, frame_valid, pairs, invalid)) {
+        frequency = ratectl_frequency(&rate_control);
+    }
+}
+
+static uint8_t optical_rate_advice(void) {
+    return autoRate ? ratectl_advise(&rate_control) : ARQ_RATE_KEEP;
+}
+
+static void optical_rate_apply(const uint8_t level) {
+    if (!autoRate) {
+        return;
+    }
+    ratectl_set_level(&rate_control, level);
+    frequency = ratectl_frequency(&rate_control);
+}
+
+static void optical_rate_timeout(void) {
+    if (autoRate && ratectl_timeout(&rate_control)) {
+        frequency = ratectl_frequency(&rate_control);
+    }
+}
+
+static const arq_link_t optical_link = {
+    .send = optical_send,
+    .receive = optical_receive,
+    .now_us = optical_now,
+    .deliver = uart_deliver,
+    .rate_observe = optical_rate_observe,
+    .rate_advice = optical_rate_advice,
+    .rate_apply = optical_rate_apply,
+    .rate_timeout = optical_rate_timeout,
+};
+
+static arq_config_t arq_current_config(void) {
+    // Первый таймер повтора: два кадра подтверждения с синхропоследовательностью и запас на обработку
+    const int64_t ack_us = FRAME_PREAMBLE_US(frequency) + (int64_t)ARQ_MAX_FRAME * 8 * 1000000 / frequency;
+    const arq_config_t config = {
+        .window = arq_window,
+        .max_retries = ARQ_MAX_RETRIES,
+        .initial_rto_us = 2 * ack_us + 500000,
+        .min_rto_us = ack_us,
+        .max_rto_us = 10 * (2 * ack_us + 500000),
+    };
+    return config;
+}
+
+static void process_arq_data(const uint8_t* data, const int len) {
+    const arq_config_t config = arq_current_config();
+    arq_stats_t stats;
+    const int result = arq_send(&optical_link, &config, data, len, &stats);
+    const int64_t elapsed_ms = stats.elapsed_us / 1000;
+    printf(
+        "%s: %d bytes in %lld ms, goodput %lld B/s, %d frames, %d retransmitted, %d timeouts, RTO %lld ms\n",
+        result == 0 ? "Data delivered" : "Delivery failed", stats.bytes, (long long)elapsed_ms,
+        elapsed_ms > 0 ? (long long)stats.bytes * 1000 / elapsed_ms : 0LL,
+        stats.frames_sent, stats.retransmissions, stats.timeouts, (long long)(stats.rto_us / 1000)
+    );
+}
+
+// Последовательность идёт блоками по кадру, генератор продолжается из кадра в кадр
+#define PRBS_BLOCK_BYTES 256
+#define PRBS_LISTEN_TIMEOUT_US 200000
+#define PRBS_REPORT_US 2000000
+
+static prbs_gen_t prbs_generator;
+static prbs_checker_t prbs_checker;
+static int64_t prbs_started_at = 0;
+static int64_t prbs_reported_at = 0;
+
+static void process_prbs_tx(void) {
+    uint8_t block[PRBS_BLOCK_BYTES];
+    prbs_fill(&prbs_generator, block, PRBS_BLOCK_BYTES);
+    send_manchester_frame(block, PRBS_BLOCK_BYTES, frequency);
+}
+
+static void prbs_report(void) {
+    const prbs_stats_t* stats = &prbs_checker.stats;
+    const int64_t elapsed_us = esp_timer_get_time() - prbs_started_at;
+    printf(
+        "PRBS%d %s: %llu bits, %llu errors, BER %.2e, %lu bursts (max %lu bits), %lu slips, %lu sync losses, %lld bit/s\n",
+        prbs_checker.local.order, prbs_checker.locked ? "locked" : "hunting",
+        (unsigned long long)stats->bits, (unsigned long long)stats->errors,
+        stats->bits > 0 ? (double)stats->errors / stats->bits : 0.0,
+        (unsigned long)stats->bursts, (unsigned long)stats->max_burst,
+        (unsigned long)stats->slips, (unsigned long)stats->sync_losses,
+        elapsed_us > 0 ? (long long)(stats->bits * 1000000 / elapsed_us) : 0LL
+    );
+}
+
+static void process_prbs_rx(void) {
+    static uint8_t block[PRBS_BLOCK_BYTES];
+    const int len = receive_manchester_frame(threshold, frequency, block, PRBS_BLOCK_BYTES, PRBS_LISTEN_TIMEOUT_US);
+    if (len > 0) {
+        prbs_check(&prbs_checker, block, len);
+    }
+    const int64_t now = esp_timer_get_time();
+    if (now - prbs_reported_at >= PRBS_REPORT_US) {
+        prbs_reported_at = now;
+        prbs_report();
+    }
+}
+
+#define TDMA_DEFAULT_SLOT_MS 1000
+// Очередь данных узла до его слота
+#define TDMA_QUEUE_SIZE 1024
+
+static tdma_schedule_t tdma_schedule;
+static uint8_t tdma_queue[TDMA_QUEUE_SIZE];
+static int tdma_queued = 0;
+static uint32_t tdma_dropped = 0;
+
+// Ожидание начала слота: длинные интервалы отдаются планировщику, последние миллисекунды - точное ожидание
+static void tdma_wait_until(const int64_t deadline) {
+    int64_t now;
+    while ((now = esp_timer_get_time()) < deadline) {
+        rtc_wdt_feed();
+        if (deadline - now > 20000) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+}
+
+static void tdma_enqueue(const uint8_t* data, const int len) {
+    const int room = TDMA_QUEUE_SIZE - tdma_queued;
+    const int accepted = len < room ? len : room;
+    memcpy(tdma_queue + tdma_queued, data, accepted);
+    tdma_queued += accepted;
+    tdma_dropped += len - accepted;
+}
+
+// Один суперкадр координатора: маяк с расписанием, затем приём во всех слотах
+static void process_tdma_coordinator(void) {
+    uint8_t frame[TDMA_MAX_FRAME];
+    ++tdma_schedule.seq;
+    const int beacon_len = tdma_build_beacon(frame, node_address, &tdma_schedule);
+    send_manchester_frame(frame, beacon_len, frequency);
+    // Узлы отсчитывают слоты от момента, когда их приёмник обнаружил конец маяка по тишине
+    const int64_t start = esp_timer_get_time() + get_rate_timing(frequency).max_delay_period_us;
+    const int64_t end = start + tdma_superframe_us(&tdma_schedule);
+
+    int64_t now;
+    while ((now = esp_timer_get_time()) < end) {
+        const int received = receive_manchester_frame(threshold, frequency, frame, TDMA_MAX_FRAME, end - now);
+        tdma_frame_t parsed;
+        if (received <= 0 || !tdma_parse_frame(frame, received, &parsed)) {
+            continue;
+        }
+        if (parsed.type == TDMA_TYPE_JOIN && parsed.dst == node_address) {
+            // Слот вступит в силу со следующего маяка
+            const int slot = tdma_assign(&tdma_schedule, parsed.src);
+            printf("Node %d %s\n", parsed.src, slot > 0 ? "joined" : "rejected: no free slots");
+        } else if (parsed.type == TDMA_TYPE_DATA && (parsed.dst == node_address || parsed.dst == TDMA_BROADCAST)) {
+            char prefix[8];
+            const int prefix_len = snprintf(prefix, sizeof(prefix), "[%d] ", parsed.src);
+            console_write(UART_PORT_NUM, prefix, prefix_len);
+            console_write(UART_PORT_NUM, parsed.payload, parsed.len);
+            console_write(UART_PORT_NUM, "\r\n", 2);
+        }
+    }
+}
+
+// Один суперкадр узла: ожидание маяка, затем передача в своём слоте (или запрос слота в слоте 0)
+static void process_tdma_node(void) {
+    uint8_t frame[TDMA_MAX_FRAME];
+    const rate_timing_t timing = get_rate_timing(frequency);
+    const int64_t beacon_timeout = tdma_schedule.slot_us > 0
+        ? 2 * tdma_superframe_us(&tdma_schedule)
+        : (int64_t)(TDMA_MAX_SLOTS + 1) * TDMA_DEFAULT_SLOT_MS * 1000;
+    const int received = receive_manchester_frame(threshold, frequency, frame, TDMA_MAX_FRAME, beacon_timeout);
+    const int64_t start = esp_timer_get_time();
+    tdma_frame_t parsed;
+    if (received <= 0 || !tdma_parse_frame(frame, received, &parsed) || !tdma_parse_beacon(&parsed, &tdma_schedule)) {
+        return;
+    }
+    const uint8_t coordinator = parsed.src;
+
+    int slot = tdma_slot_of(&tdma_schedule, node_address);
+    int len;
+    if (slot < 0) {
+        // Слот 0 общий: новые узлы пропускают суперкадр с вероятностью 1/2, чтобы не сталкиваться каждый раз
+        if (esp_random() & 1) {
+            return;
+        }
+        slot = 0;
+        len = tdma_build_frame(frame, TDMA_TYPE_JOIN, node_address, coordinator, tdma_queue, 0);
+    } else {
+        const int capacity = tdma_slot_capacity(&tdma_schedule, frequency, FRAME_PREAMBLE_US(frequency), timing.max_delay_period_us);
+        const int chunk = tdma_queued < capacity ? tdma_queued : capacity;
+        if (chunk == 0) {
+            return;
+        }
+        len = tdma_build_frame(frame, TDMA_TYPE_DATA, node_address, coordinator, tdma_queue, chunk);
+        tdma_queued -= chunk;
+        memmove(tdma_queue, tdma_queue + chunk, tdma_queued);
+    }
+    tdma_wait_until(start + tdma_slot_offset_us(&tdma_schedule, slot) + TDMA_GUARD_US);
+    send_manchester_frame(frame, len, frequency);
+}
+
+// Передача данных с консоли выбранной модуляцией, каждый вызов - отдельный кадр со своей синхропоследовательностью
+static void process_tx_data(const uint8_t* data, const int len) {
+    if (cskMode != CSK_MODE_OFF) {
+        process_csk_data(data, len, frequency, cskMode);
+    } else if (ofdmMode) {
+        process_ofdm_data(data, len, frequency, &ofdm_loading);
+    } else if (ppmOrder) {
+        process_ppm_data(data, len, frequency, ppmOrder);
+    } else if (fecMode) {
+        process_fec_data(data, len, frequency);
+    } else if (lzssMode) {
+        process_lzss_data(data, len, frequency);
+    } else {
+        process_binary_data(data, len, frequency);
+    }
+}
+
+// Накопитель пакетной передачи: кадр уходит, когда набрано batch_limit байт
+// или когда первый байт ждёт дольше batch_delay_us
+#define BATCH_MAX_BYTES BUF_SIZE
+#define BATCH_DEFAULT_DELAY_MS 50
+
+_Static_assert(BUF_SIZE < BUFPOOL_BLOCK_SIZE, "UART read and its terminator do not fit a pool buffer");
+
+// Накопитель - блок пула. Пустой накопитель забирает блок записи UART себе без копирования,
+// следующие записи дописываются за накопленным
+static bufpool_frame_t* batch_frame = NULL;
+static int batch_start = 0; // Начало накопленного в блоке: полные кадры длинной записи уходят прямо из него
+static int batch_limit = BATCH_MAX_BYTES;
+static int64_t batch_delay_us = BATCH_DEFAULT_DELAY_MS * 1000;
+static int64_t batch_started_at = 0;
+static uint32_t batch_writes = 0;
+static uint32_t batch_frames = 0;
+static uint32_t batch_bytes = 0;
+
+static void batch_send(const uint8_t* data, const int len) {
+    process_tx_data(data, len);
+    ++batch_frames;
+    batch_bytes += len;
+}
+
+static void batch_flush(void) {
+    if (!batch_frame) {
+        return;
+    }
+    batch_send(batch_frame->data + batch_start, batch_frame->len);
+    bufpool_release(batch_frame);
+    batch_frame = NULL;
+}
+
+// Пустой накопитель: полные кадры уходят прямо из блока записи, остаток с offset остаётся в нём же
+static void batch_take(bufpool_frame_t* frame, int offset) {
+    for (; frame->len - offset >= batch_limit; offset += batch_limit) {
+        batch_send(frame->data + offset, batch_limit);
+    }
+    if (offset == frame->len) {
+        bufpool_release(frame);
+        return;
+    }
+    // Остаток сдвигается в начало, только если иначе до предела накопителя не хватит места в блоке
+    if (offset + batch_limit > BUFPOOL_BLOCK_SIZE) {
+        memmove(frame->data, frame->data + offset, frame->len - offset);
+        frame->len -= offset;
+        offset = 0;
+    }
+    batch_frame = frame;
+    batch_start = offset;
+    batch_frame->len -= offset;
+    batch_started_at = esp_timer_get_time();
+}
+
+// Владение блоком frame переходит к накопителю
+static void batch_append(bufpool_frame_t* frame) {
+    ++batch_writes;
+    if (!batch_frame) {
+        batch_take(frame, 0);
+        return;
+    }
+    const int room = batch_limit - batch_frame->len;
+    const int chunk = frame->len < room ? frame->len : room;
+    memcpy(batch_frame->data + batch_start + batch_frame->len, frame->data, chunk);
+    batch_frame->len += chunk;
+    if (batch_frame->len < batch_limit) {
+        bufpool_release(frame);
+        return;
+    }
+    batch_flush();
+    batch_take(frame, chunk);
+}
+
+// Передача по истечении задержки накопителя
+static void process_batch(void) {
+    if (batch_frame && esp_timer_get_time() - batch_started_at >= batch_delay_us) {
+        batch_flush();
+    }
+}
+
+// Сколько ещё ждать данных с UART, не нарушая задержку накопителя
+static TickType_t batch_wait_ticks(const TickType_t wait_ticks) {
+    if (!batch_frame) {
+        return wait_ticks;
+    }
+    const int64_t left_us = batch_started_at + batch_delay_us - esp_timer_get_time();
+    const TickType_t left_ticks = left_us > 0 ? pdMS_TO_TICKS(left_us / 1000) : 0;
+    return left_ticks < wait_ticks ? left_ticks : wait_ticks;
 }
 
 void process_command(const char* cmd) {
@@ -88,17 +538,27 @@ void process_command(const char* cmd) {
         while (*arg == ' ' || *arg == '\t') {
             arg++;
         }
-        if (*arg) {
+        if (strncmp(arg, "AUTO", 4) == 0) {
+            // Передача остаётся на заданной частоте, приём следует за меткой скорости каждого кадра
+            set_receiver_autorate(1, MAX_FREQ);
+            printf("Receive rate: detected per frame (%d..%d Hz), transmit at %d Hz\n", RATE_AUTO_MIN_FREQ, MAX_FREQ, frequency);
+        } else if (*arg) {
             char* endptr;
             const double new_freq = strtod(arg, &endptr);
             if (endptr != arg && new_freq > 0 && new_freq <= MAX_FREQ) {
                 frequency = new_freq;
-                printf("Frequency installed to %d Hz\n", frequency);
+                set_receiver_autorate(0, MAX_FREQ);
+                printf(
+                    "Frequency installed to %d Hz (%s kernel)\n", frequency,
+                    is_standard_rate(frequency) ? "specialised" : "generic"
+                );
             } else {
                 printf("Incorrect frequency: %s (mac: %d Hz)\n", arg, MAX_FREQ);
             }
+        } else if (get_receiver_autorate()) {
+            printf("Last frame received at %d Hz, transmit at %d Hz\n", receiver_last_frame_rate(), frequency);
         } else {
-            printf("Команда #FREQ требует аргумент, например: #FREQ 2\n");
+            printf("Команда #FREQ требует аргумент <Гц> или AUTO, например: #FREQ 2\n");
         }
     } else if (strncmp(cmd, "#THR", 4) == 0) {
         const char* arg = cmd + 4;
@@ -110,6 +570,7 @@ void process_command(const char* cmd) {
             const double new_thr = strtod(arg, &endptr);
             if (endptr != arg && new_thr > 0 && new_thr < 4096) {
                 threshold = (int)new_thr;
+                calibration_save();
                 printf("Threshold installed to %d\n", threshold);
             } else {
                 printf("Incorrect threshold: %s\n", arg);
@@ -127,13 +588,8 @@ void process_command(const char* cmd) {
             const double new_blink_freq = strtod(arg, &endptr);
             if (endptr != arg && new_blink_freq > 0 && new_blink_freq <= MAX_FREQ * 2) {
                 blink_frequency = (int)new_blink_freq;
-                rawRead = 0;
-                binRead = 0;
-                normalRead = 0;
-                readMode = 0;
+                reset_modes();
                 blinkMode = 1;
-                infTest = 0;
-                duplexMode = 0;
                 printf("Blinking with %d Hz\n", blink_frequency);
             } else {
                 printf("Incorrect frequency: %s\n", arg);
@@ -143,65 +599,535 @@ void process_command(const char* cmd) {
         }
     } else if (strncmp(cmd, "#RNOR", 5) == 0) {
         printf("Normal mode\n");
-        rawRead = 0;
-        binRead = 0;
+        reset_modes();
         normalRead = 1;
         readMode = 1;
-        blinkMode = 0;
-        duplexMode = 0;
-        infTest = 0;
     } else if (strncmp(cmd, "#RRAW", 5) == 0) {
         printf("Raw mode\n");
+        reset_modes();
         rawRead = 1;
-        binRead = 0;
-        normalRead = 0;
         readMode = 1;
-        blinkMode = 0;
-        duplexMode = 0;
-        infTest = 0;
     } else if (strncmp(cmd, "#RBIN", 5) == 0) {
         printf("Bin mode\n");
-        rawRead = 0;
+        reset_modes();
         binRead = 1;
-        normalRead = 0;
         readMode = 1;
-        blinkMode = 0;
-        duplexMode = 0;
-        infTest = 0;
     } else if (strncmp(cmd, "#SEND", 5) == 0) {
         printf("Send mode\n");
-        rawRead = 0;
-        binRead = 0;
-        normalRead = 0;
-        readMode = 0;
-        blinkMode = 0;
-        duplexMode = 0;
-        infTest = 0;
+        reset_modes();
     } else if (strncmp(cmd, "#DUPL", 5) == 0) {
         printf("Half-Duplex mode\n");
-        rawRead = 0;
-        binRead = 0;
-        normalRead = 0;
-        readMode = 0;
-        blinkMode = 0;
+        reset_modes();
         duplexMode = 1;
-        infTest = 0;
+    } else if (strncmp(cmd, "#ARQ", 4) == 0) {
+        printf("Reliable half-duplex mode, window %d\n", arq_window);
+        reset_modes();
+        arq_receiver_reset();
+        arqMode = 1;
+    } else if (strncmp(cmd, "#PRBS", 5) == 0) {
+        const char* arg = cmd + 5;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        const int tx = strncmp(arg, "TX", 2) == 0;
+        const int rx = strncmp(arg, "RX", 2) == 0;
+        const int order = tx || rx ? prbs_order_from_value(atoi(arg + 2)) : -1;
+        if (order > 0) {
+            reset_modes();
+            if (tx) {
+                prbs_init(&prbs_generator, order);
+                prbsTx = 1;
+            } else {
+                prbs_checker_init(&prbs_checker, order);
+                prbs_started_at = prbs_reported_at = esp_timer_get_time();
+                prbsRx = 1;
+            }
+            printf("PRBS%d %s at %d Hz\n", order, tx ? "generator" : "checker", frequency);
+        } else if (strncmp(arg, "OFF", 3) == 0) {
+            if (prbsRx) {
+                prbs_report();
+            }
+            reset_modes();
+        } else {
+            printf("Команда #PRBS требует аргумент TX|RX <7|15|31> или OFF, например: #PRBS RX 15\n");
+        }
+    } else if (strncmp(cmd, "#NODE", 5) == 0) {
+        const char* arg = cmd + 5;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        const int address = atoi(arg);
+        if (address > 0 && address < TDMA_BROADCAST) {
+            node_address = address;
+            printf("Node address %d\n", node_address);
+        } else {
+            printf("Команда #NODE требует адрес от 1 до %d, например: #NODE 2\n", TDMA_BROADCAST - 1);
+        }
+    } else if (strncmp(cmd, "#COORD", 6) == 0) {
+        const char* arg = cmd + 6;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        const int slot_ms = *arg ? atoi(arg) : TDMA_DEFAULT_SLOT_MS;
+        if (slot_ms > 0 && slot_ms < 65536) {
+            reset_modes();
+            memset(&tdma_schedule, 0, sizeof(tdma_schedule));
+            tdma_schedule.slot_us = slot_ms * 1000;
+            tdmaCoordinator = 1;
+            printf(
+                "TDMA coordinator %d: %d ms slots, up to %d nodes, %d bytes per slot at %d Hz\n",
+                node_address, slot_ms, TDMA_MAX_SLOTS,
+                tdma_slot_capacity(&tdma_schedule, frequency, FRAME_PREAMBLE_US(frequency), get_rate_timing(frequency).max_delay_period_us),
+                frequency
+            );
+        } else {
+            printf("Incorrect slot length: %s\n", arg);
+        }
+    } else if (strncmp(cmd, "#TDMA", 5) == 0) {
+        reset_modes();
+        memset(&tdma_schedule, 0, sizeof(tdma_schedule));
+        tdma_queued = 0;
+        tdma_dropped = 0;
+        tdmaNode = 1;
+        printf("TDMA node %d, waiting for beacon\n", node_address);
+    } else if (strncmp(cmd, "#WIN", 4) == 0) {
+        const char* arg = cmd + 4;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (*arg) {
+            char* endptr;
+            const long new_window = strtol(arg, &endptr, 10);
+            if (endptr != arg && new_window >= 1 && new_window <= ARQ_MAX_WINDOW) {
+                arq_window = (int)new_window;
+                printf("ARQ window installed to %d frames\n", arq_window);
+            } else {
+                printf("Incorrect window: %s (1..%d)\n", arg, ARQ_MAX_WINDOW);
+            }
+        } else {
+            printf("Команда #WIN требует аргумент, например: #WIN 8\n");
+        }
     } else if (strncmp(cmd, "#IATHR", 6) == 0) {
         printf("Infinite testing scanning\n");
-        rawRead = 0;
-        binRead = 0;
-        normalRead = 0;
-        readMode = 0;
-        blinkMode = 0;
-        duplexMode = 0;
+        reset_modes();
         infTest = 1;
+    } else if (strncmp(cmd, "#COOP", 5) == 0) {
+        const char* arg = cmd + 5;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (strncmp(arg, "ON", 2) == 0) {
+            reset_modes();
+            coopMode = 1;
+            printf("Cooperative mode on: transmit, receive, calibration and blink share one core\n");
+        } else if (strncmp(arg, "OFF", 3) == 0) {
+            coopMode = 0;
+        } else if (strncmp(arg, "BLINK", 5) == 0) {
+            char* endptr;
+            const long new_freq = strtol(arg + 5, &endptr, 10);
+            if (endptr != arg + 5 && new_freq >= 0 && new_freq <= MAX_FREQ * 2) {
+                coop_blink_frequency = (int)new_freq;
+                printf("Cooperative blink set to %d Hz\n", coop_blink_frequency);
+            } else {
+                printf("Incorrect frequency: %s\n", arg + 5);
+            }
+        } else {
+            printf("Команда #COOP требует аргумент ON, OFF или BLINK <Гц>, например: #COOP ON\n");
+        }
     } else if (strncmp(cmd, "#ATHR", 5) == 0) {
-        found_threshold();
+        if (found_threshold()) {
+            calibration_save();
+        }
+    } else if (strncmp(cmd, "#CSK", 4) == 0) {
+        const char* arg = cmd + 4;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        const int new_mode = csk_mode_from_name(arg);
+        const int prepared = new_mode > CSK_MODE_OFF ? csk_prepare(new_mode) : 0;
+        if (new_mode < 0) {
+            printf("Команда #CSK требует режим: OFF, RGB, RGBW, CSK4 или CSK8\n");
+        } else if (prepared == -1) {
+            printf("Режим RGBW требует ленту с белым каналом (CONFIG_LIFI_CSK_RGBW)\n");
+        } else if (prepared < 0) {
+            printf("Адресная лента недоступна, режим CSK не изменён\n");
+        } else {
+            cskMode = new_mode;
+            printf("CSK mode: %s (%d bits per symbol)\n", csk_mode_name(cskMode), csk_bits_per_symbol(cskMode));
+        }
+    } else if (strncmp(cmd, "#FEC", 4) == 0) {
+        const char* arg = cmd + 4;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (*arg == '0' || *arg == '1') {
+            fecMode = *arg == '1';
+            printf("Convolutional coding: %s\n", fecMode ? "on (K=7, rate 1/2)" : "off");
+        } else {
+            printf("Команда #FEC требует аргумент 1 или 0, например: #FEC 1\n");
+        }
+    } else if (strncmp(cmd, "#LZ", 3) == 0) {
+        const char* arg = cmd + 3;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (*arg == '0' || *arg == '1') {
+            lzssMode = *arg == '1';
+            printf("Compression: %s\n", lzssMode ? "on (LZSS, 256-byte window)" : "off");
+        } else {
+            printf("Команда #LZ требует аргумент 1 или 0, например: #LZ 1\n");
+        }
+    } else if (strncmp(cmd, "#RATE", 5) == 0) {
+        const char* arg = cmd + 5;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (strncmp(arg, "AUTO", 4) == 0) {
+            char* endptr;
+            const long target = strtol(arg + 4, &endptr, 10);
+            const uint32_t target_ppm = endptr != arg + 4 && target > 0 ? target : RATECTL_DEFAULT_TARGET_PPM;
+            // Текущая частота становится базовой: на неё обе стороны возвращаются при потере связи
+            if (!autoRate) {
+                ratectl_init(&rate_control, frequency, MAX_FREQ, target_ppm);
+            }
+            rate_control.target_ppm = target_ppm;
+            autoRate = 1;
+            printf(
+                "Automatic rate: base %d Hz, up to %d Hz, target %lu invalid pairs per million (ARQ mode only)\n",
+                rate_control.rates[0], rate_control.rates[rate_control.levels - 1], (unsigned long)target_ppm
+            );
+        } else if (strncmp(arg, "OFF", 3) == 0) {
+            if (autoRate) {
+                frequency = rate_control.rates[0];
+            }
+            autoRate = 0;
+            printf("Automatic rate off, frequency %d Hz\n", frequency);
+        } else if (*arg == 0 && autoRate) {
+            printf(
+                "Rate level %d of %d: %d Hz%s, last failed level %d (retry after %d clean frames)\n",
+                rate_control.level, rate_control.levels - 1, frequency, rate_control.probing ? " (probing)" : "",
+                rate_control.failed_level, rate_control.probe_frames
+            );
+        } else {
+            printf("Команда #RATE требует аргумент AUTO [ppm] или OFF, например: #RATE AUTO 1000\n");
+        }
+    } else if (strncmp(cmd, "#STAT", 5) == 0) {
+        console_stats_t stats;
+        console_get_stats(&stats);
+        printf(
+            "UART output: %lu bytes written, %lu bytes dropped in %lu messages, min free %lu of %d\n",
+            (unsigned long)stats.bytes_written, (unsigned long)stats.bytes_dropped,
+            (unsigned long)stats.writes_dropped, (unsigned long)stats.min_free, CONSOLE_TX_BUFFER_SIZE
+        );
+        console_reset_stats();
+        rxfsm_stats_t rx_stats;
+        uint32_t rx_dropped;
+        receiver_stream_stats(&rx_stats, &rx_dropped);
+        printf(
+            "Continuous receive: %lu frames, %lu dropped, %lu without rate marker, %lu of %lu pairs invalid\n",
+            (unsigned long)rx_stats.frames, (unsigned long)rx_dropped, (unsigned long)rx_stats.marker_losses,
+            (unsigned long)rx_stats.invalid_pairs, (unsigned long)rx_stats.pairs
+        );
+        if (tdmaNode) {
+            printf("TDMA queue: %d bytes waiting, %lu bytes dropped\n", tdma_queued, (unsigned long)tdma_dropped);
+        }
+    } else if (strncmp(cmd, "#MEM", 4) == 0) {
+        // Отчёт о памяти; высшие отметки пула после него отсчитываются заново
+        bufpool_stats_t pool;
+        bufpool_get_stats(&pool);
+        printf(
+            "Frame pool: %d blocks of %d bytes, %lu in use, high water %lu, %lu acquired, %lu failed\n",
+            BUFPOOL_BLOCKS, BUFPOOL_BLOCK_SIZE, (unsigned long)pool.in_use, (unsigned long)pool.high_water,
+            (unsigned long)pool.acquired, (unsigned long)pool.failures
+        );
+        bufpool_reset_stats();
+        printf(
+            "Receive workspace: %u bytes shared by all receive modes\n", (unsigned)receiver_workspace_size()
+        );
+        printf(
+            "Heap: %lu bytes free, minimum %lu; main task stack: %u bytes never used\n",
+            (unsigned long)esp_get_free_heap_size(), (unsigned long)esp_get_minimum_free_heap_size(),
+            (unsigned)uxTaskGetStackHighWaterMark(NULL)
+        );
+    } else if (strncmp(cmd, "#EQ", 3) == 0) {
+        const char* arg = cmd + 3;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (*arg == '0' || *arg == '1') {
+            set_receiver_equaliser(*arg == '1');
+            printf("Equaliser: %s\n", get_receiver_equaliser() ? "on (trained on every sync)" : "off");
+        } else if (*arg == 0 && get_receiver_equaliser()) {
+            const eq_t* eq = receiver_equaliser_state();
+            printf(
+                "Equaliser taps: c0 %.3f, c1 %.3f, channel pole %.3f\n",
+                eq->c0 * 1.0 / EQ_ONE, eq->c1 * 1.0 / EQ_ONE, eq->pole * 1.0 / EQ_ONE
+            );
+        } else {
+            printf("Команда #EQ требует аргумент 1 или 0, например: #EQ 1\n");
+        }
+    } else if (strncmp(cmd, "#PPM", 4) == 0) {
+        const char* arg = cmd + 4;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        const int order = atoi(arg);
+        if (strncmp(arg, "OFF", 3) == 0) {
+            ppmOrder = 0;
+            printf("PPM off, Manchester coding\n");
+        } else if (ppm_bits_per_symbol(order) > 0) {
+            ppmOrder = order;
+            printf(
+                "%d-PPM: %d bits per pulse, slot %d us\n", ppmOrder, ppm_bits_per_symbol(ppmOrder),
+                500000 / frequency > 0 ? 500000 / frequency : 1
+            );
+        } else {
+            printf("Команда #PPM требует аргумент 4, 8, 16 или OFF, например: #PPM 8\n");
+        }
+    } else if (strncmp(cmd, "#OFDM", 5) == 0) {
+        const char* arg = cmd + 5;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (strncmp(arg, "ON", 2) == 0) {
+            ofdmMode = 1;
+            printf(
+                "OFDM on: %d carriers, %d bits per symbol, %d samples per second\n", OFDM_CARRIERS,
+                ofdm_symbol_bits(&ofdm_loading), frequency
+            );
+        } else if (strncmp(arg, "OFF", 3) == 0) {
+            ofdmMode = 0;
+            printf("OFDM off\n");
+        } else if (strncmp(arg, "LOAD", 4) == 0) {
+            // Биты поднесущих 1..OFDM_CARRIERS подряд, например строка из #OFDM без аргумента
+            arg += 4;
+            while (*arg == ' ' || *arg == '\t') {
+                arg++;
+            }
+            ofdm_loading_t loading;
+            int count = 0;
+            for (; count < OFDM_CARRIERS; ++count) {
+                const char c = arg[count];
+                if (c != '0' && c != '1' && c != '2' && c != '4') {
+                    break;
+                }
+                loading.bits[count] = c - '0';
+            }
+            if (count == OFDM_CARRIERS && ofdm_symbol_bits(&loading) > 0) {
+                ofdm_loading = loading;
+                printf(
+                    "OFDM loading: %d bits per symbol, %d bytes per frame\n", ofdm_symbol_bits(&ofdm_loading),
+                    ofdm_frame_capacity(&ofdm_loading)
+                );
+            } else {
+                printf("Команда #OFDM LOAD требует %d цифр 0, 1, 2 или 4, хотя бы одну ненулевую\n", OFDM_CARRIERS);
+            }
+        } else if (*arg == '\0') {
+            const ofdm_channel_t* channel = receiver_ofdm_channel();
+            if (!channel) {
+                printf("No OFDM frame received yet\n");
+            } else {
+                char suggested[OFDM_CARRIERS + 1];
+                for (int k = 0; k < OFDM_CARRIERS; ++k) {
+                    printf("%s%.1f", k ? " " : "SNR dB: ", channel->snr_db[k]);
+                    suggested[k] = '0' + channel->suggested.bits[k];
+                }
+                suggested[OFDM_CARRIERS] = '\0';
+                printf("\nSuggested loading: %s (%d bits per symbol)\n", suggested, ofdm_symbol_bits(&channel->suggested));
+            }
+        } else {
+            printf("Команда #OFDM требует аргумент ON, OFF или LOAD <биты>, например: #OFDM LOAD 4444222222221111111111111110000\n");
+        }
+    } else if (strncmp(cmd, "#BATCH", 6) == 0) {
+        const char* arg = cmd + 6;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        char* endptr;
+        const long bytes = strtol(arg, &endptr, 10);
+        const char* delay_arg = endptr;
+        const long delay_ms = strtol(delay_arg, &endptr, 10);
+        if (strncmp(arg, "OFF", 3) == 0) {
+            batch_flush();
+            batchMode = 0;
+            printf("Batching off\n");
+        } else if (*arg == 0) {
+            printf(
+                "Batching %s: %lu writes in %lu frames, %lu bytes, %.1f writes per frame\n",
+                batchMode ? "on" : "off", (unsigned long)batch_writes, (unsigned long)batch_frames,
+                (unsigned long)batch_bytes, batch_frames ? batch_writes * 1.0 / batch_frames : 0.0
+            );
+            batch_writes = batch_frames = batch_bytes = 0;
+        } else if (delay_arg != arg && bytes > 0 && bytes <= BATCH_MAX_BYTES && endptr != delay_arg && delay_ms >= 0) {
+            batch_flush();
+            batch_limit = bytes;
+            batch_delay_us = delay_ms * 1000;
+            batchMode = 1;
+            printf("Batching on: frame sent at %d bytes or %ld ms after the first byte\n", batch_limit, delay_ms);
+        } else {
+            printf("Команда #BATCH требует аргументы <байт 1..%d> <мс> или OFF, например: #BATCH 256 50\n", BATCH_MAX_BYTES);
+        }
+    } else if (strncmp(cmd, "#PERF", 5) == 0) {
+        printf("Measuring at %d Hz...\n", frequency);
+        perf_result_t result;
+        perf_measure(frequency, &result);
+        perf_report(UART_PORT_NUM, &result);
+    } else if (strncmp(cmd, "#BENCH", 6) == 0) {
+        bench_run(UART_PORT_NUM);
+    } else if (strncmp(cmd, "#MF", 3) == 0) {
+        const char* arg = cmd + 3;
+        while (*arg == ' ' || *arg == '\t') {
+            arg++;
+        }
+        if (*arg == '0' || *arg == '1') {
+            set_receiver_integrate(*arg == '1');
+            printf("Half-bit decision: %s\n", get_receiver_integrate() ? "integrate-and-dump" : "edge sample");
+        } else {
+            printf("Команда #MF требует аргумент 1 или 0, например: #MF 1\n");
+        }
     } else {
         printf("Unknown command: %s\n", cmd);
     }
 }
 
+// Вывод кадров, принятых задачей непрерывного приёма
+static void print_stream_frames(void) {
+    bufpool_frame_t* frame;
+    while ((frame = receiver_stream_take()) != NULL) {
+        frame->data[frame->len++] = '\r';
+        frame->data[frame->len++] = '\n';
+        console_write(UART_PORT_NUM, frame->data, frame->len);
+        bufpool_release(frame);
+    }
+}
+
+// Опрос UART в кооперативном режиме
+#define COOP_UART_POLL_US 1000
+
+static int coop_adc_read(void) {
+    return adc1_get_raw(ADC1_CHANNEL_4);
+}
+
+static void coop_led_set(const int level) {
+    gpio_set_level(LED_GPIO, level);
+}
+
+static const engine_io_t coop_io = {coop_adc_read, coop_led_set};
+
+// Служба UART: команды и данные для передачи. Блок с данными возвращается в пул после конца передачи
+typedef struct {
+    coop_task_t task;
+    bufpool_frame_t* input;
+    bufpool_frame_t* sending;
+} uart_engine_t;
+
+static coop_scheduler_t coop_scheduler;
+static tx_engine_t coop_tx;
+static rx_engine_t coop_rx;
+static calib_engine_t coop_calib;
+static blink_engine_t coop_blink;
+static uart_engine_t coop_uart;
+static eq_t coop_equaliser;
+
+static rxfsm_config_t coop_rx_config(void) {
+    const rxfsm_config_t config = {
+        .threshold = threshold,
+        .frequency = frequency,
+        .autorate_max = get_receiver_autorate() ? MAX_FREQ : 0,
+        .integrate = get_receiver_integrate(),
+        .eq = get_receiver_equaliser() ? &coop_equaliser : NULL,
+    };
+    return config;
+}
+
+static void coop_deliver(const uint8_t* data, const int len) {
+    console_write(UART_PORT_NUM, data, len);
+    console_write(UART_PORT_NUM, "\r\n", 2);
+}
+
+// Фоновая калибровка только следит за порогом, в NVS он сохраняется командами #ATHR и #THR
+static void coop_calibrated(const calib_result_t* result) {
+    threshold = result->threshold;
+    ambient_level = result->low;
+    const rxfsm_config_t config = coop_rx_config();
+    rx_engine_configure(&coop_rx, &config);
+}
+
+static int coop_uart_step(coop_task_t* task, const int64_t now_us) {
+    uart_engine_t* engine = (uart_engine_t*)task;
+    PT_BEGIN(&task->pt);
+    while (1) {
+        COOP_SLEEP_UNTIL(task, now_us + COOP_UART_POLL_US);
+        rtc_wdt_feed();
+        if (engine->sending && !tx_engine_busy(&coop_tx)) {
+            bufpool_release(engine->sending);
+            engine->sending = NULL;
+        }
+        engine->input = bufpool_acquire();
+        if (!engine->input) {
+            continue;
+        }
+        engine->input->len = uart_read_bytes(UART_PORT_NUM, engine->input->data, BUF_SIZE, 0);
+        if (engine->input->len > 0 && engine->input->data[0] == '#' && engine->input->len < 100) {
+            engine->input->data[engine->input->len] = '\0';
+            process_command((const char*)engine->input->data);
+            if (!coopMode) {
+                coop_stop(&coop_scheduler);
+            }
+            const rxfsm_config_t config = coop_rx_config();
+            rx_engine_configure(&coop_rx, &config);
+            coop_blink.frequency = coop_blink_frequency;
+        } else if (engine->input->len > 0) {
+            // Следующий кадр ждёт конца текущего, команды во время передачи обрабатываются
+            PT_WAIT_UNTIL(&task->pt, !tx_engine_busy(&coop_tx));
+            bufpool_release(engine->sending);
+            tx_engine_send(&coop_tx, engine->input->data, engine->input->len, frequency);
+            engine->sending = engine->input;
+            engine->input = NULL;
+        }
+        bufpool_release(engine->input);
+        engine->input = NULL;
+    }
+    PT_END(&task->pt);
+}
+
+// Кооперативный режим до #COOP OFF или команды другого режима
+static void process_coop_mode(void) {
+    receiver_stream_stop();
+    const rxfsm_config_t config = coop_rx_config();
+    eq_reset(&coop_equaliser);
+    tx_engine_init(&coop_tx, &coop_io);
+    rx_engine_init(&coop_rx, &coop_io, &config, coop_deliver);
+    calib_engine_init(&coop_calib, &coop_io, coop_calibrated);
+    blink_engine_init(&coop_blink, &coop_io, &coop_tx);
+    coop_blink.frequency = coop_blink_frequency;
+    memset(&coop_uart, 0, sizeof(coop_uart));
+
+    // Передатчик первым: его фронты меньше всего зависят от длительности шагов остальных
+    coop_init(&coop_scheduler, optical_now);
+    coop_add(&coop_scheduler, &coop_tx.task, "tx", tx_engine_step);
+    coop_add(&coop_scheduler, &coop_rx.task, "rx", rx_engine_step);
+    coop_add(&coop_scheduler, &coop_calib.task, "calib", calib_engine_step);
+    coop_add(&coop_scheduler, &coop_blink.task, "blink", blink_engine_step);
+    coop_add(&coop_scheduler, &coop_uart.task, "uart", coop_uart_step);
+    coop_run(&coop_scheduler);
+
+    gpio_set_level(LED_GPIO, 0);
+    bufpool_release(coop_uart.input);
+    bufpool_release(coop_uart.sending);
+    printf("Cooperative mode off after %lu passes\n", (unsigned long)coop_scheduler.passes);
+    for (int i = 0; i < coop_scheduler.count; ++i) {
+        const coop_task_t* task = coop_scheduler.tasks[i];
+        printf(
+            "  %s: %lu steps, max %lld us late\n", task->name, (unsigned long)task->steps, (long long)task->max_late_us
+        );
+    }
+    printf(
+        "  %lu frames sent, %lu received, %lu threshold updates (THR %d)\n", (unsigned long)coop_tx.frames,
+        (unsigned long)coop_rx.fsm.stats.frames, (unsigned long)coop_calib.updates, threshold
+    );
+}
+
 #define BASE_BLINK_FREQ 10
 
 // Простая функция непрерывного мигания
@@ -230,8 +1156,10 @@ void app_main(void) {
     };
     esp_log_level_set("*", ESP_LOG_NONE);
     uart_param_config(UART_PORT_NUM, &uart_config);
-    uart_driver_install(UART_PORT_NUM, BUF_SIZE * 2, 0, 0, NULL, 0);
-    uart_write_bytes(UART_PORT_NUM, "\n\0", 2);
+    // Буфер передачи ненулевой: вывод не останавливает приём, printf тоже идёт через драйвер
+    uart_driver_install(UART_PORT_NUM, BUF_SIZE * 2, CONSOLE_TX_BUFFER_SIZE, 0, NULL, 0);
+    uart_vfs_dev_use_driver(UART_PORT_NUM);
+    console_write(UART_PORT_NUM, "\n\0", 2);
 
     // Настройка ширины ADC (12 бит)
     adc1_config_width(ADC_WIDTH_BIT_12);
@@ -239,27 +1167,57 @@ void app_main(void) {
     // Настройка аттенюации для канала ADC1_CHANNEL_4 (GPIO32)
     adc1_config_channel_atten(ADC1_CHANNEL_4, ADC_ATTEN_DB_0);
 
+    // Калибровка из NVS: без неё остаётся порог по умолчанию до #ATHR
+    esp_err_t nvs_err = nvs_flash_init();
+    if (nvs_err == ESP_ERR_NVS_NO_FREE_PAGES || nvs_err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        nvs_err = nvs_flash_init();
+    }
+    if (nvs_err == ESP_OK) {
+        calibration_load();
+    }
+
     gpio_pad_select_gpio(LED_GPIO);
     gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
 
     init_receiver();
+    ofdm_loading_uniform(&ofdm_loading, 2);
 
     while (1) {
-        uint8_t data[BUF_SIZE];
-        const TickType_t waitTicks = (duplexMode || readMode || blinkMode) ? 0 : pdMS_TO_TICKS(100);
-        const int len = uart_read_bytes(UART_PORT_NUM, data, BUF_SIZE, waitTicks);
+        if (coopMode) {
+            process_coop_mode();
+        }
+        const TickType_t waitTicks = (duplexMode || readMode || blinkMode || arqMode || prbsTx || prbsRx || tdmaCoordinator || tdmaNode) ? 0 : pdMS_TO_TICKS(100);
+        // Запись с UART читается прямо в блок пула, дальше блок передаётся обработчику, а не копируется
+        bufpool_frame_t* input = bufpool_acquire();
+        if (input) {
+            input->len = uart_read_bytes(UART_PORT_NUM, input->data, BUF_SIZE, batch_wait_ticks(waitTicks));
+        } else {
+            vTaskDelay(batch_wait_ticks(waitTicks));
+        }
 
-        if (len > 0) {
+        if (input && input->len > 0) {
+            const uint8_t* data = input->data;
+            const int len = input->len;
             if (data[0] == '#' && len < 100) {
-                // Обработка команды
-                char cmd[BUF_SIZE];
-                memcpy(cmd, data, len);
-                cmd[len] = '\0';
-                process_command(cmd);
+                // Обработка команды: строка завершается на месте
+                input->data[len] = '\0';
+                // Накопленное уходит со старыми настройками, до того как команда их поменяет
+                batch_flush();
+                process_command((const char*)input->data);
+            } else if (arqMode) {
+                process_arq_data(data, len);
+            } else if (tdmaNode) {
+                tdma_enqueue(data, len);
+            } else if ((!readMode || duplexMode) && batchMode) {
+                batch_append(input);
+                input = NULL;
             } else if (!readMode || duplexMode) {
-                process_binary_data(data, len, frequency);
+                process_tx_data(data, len);
             }
         }
+        bufpool_release(input);
+        process_batch();
         if (blinkMode) {
             const int period = 500000 / blink_frequency;
             // BLINK_TIME_SECS секунд непрерывных Blink морганий, прежде чем сделаем попытку ввода с консоли
@@ -270,11 +1228,30 @@ void app_main(void) {
             ets_delay_us(period);
             // }
         }
+        // Обычный манчестерский приём идёт непрерывно в своей задаче, здесь только вывод принятых кадров
+        const bool streamRead = (readMode || duplexMode) && (normalRead || duplexMode) &&
+                                !ofdmMode && !ppmOrder && !fecMode && !lzssMode;
+        print_stream_frames();
+        if (!streamRead) {
+            receiver_stream_stop();
+        }
         // Режимы чтения
         if (readMode || duplexMode) {
-            if (normalRead || duplexMode) {
-                // Попытка приёма кодированной информации
-                process_manchester_receive(threshold, frequency, UART_PORT_NUM);
+            if ((normalRead || duplexMode) && ofdmMode) {
+                // Приём DCO-OFDM
+                process_ofdm_receive(threshold, frequency, UART_PORT_NUM);
+            } else if ((normalRead || duplexMode) && ppmOrder) {
+                // Приём импульсно-позиционной модуляции
+                process_ppm_receive(threshold, frequency, ppmOrder, UART_PORT_NUM);
+            } else if ((normalRead || duplexMode) && fecMode) {
+                // Приём с декодированием свёрточного кода
+                process_fec_receive(threshold, frequency, UART_PORT_NUM);
+            } else if ((normalRead || duplexMode) && lzssMode) {
+                // Приём сжатых кадров
+                process_lzss_receive(threshold, frequency, UART_PORT_NUM);
+            } else if (normalRead || duplexMode) {
+                // Приём кодированной информации без пропусков между кадрами
+                receiver_stream_start(threshold, frequency);
             } else if (rawRead && !duplexMode) {
                 // Режим аналогового чтения
                 test_receive_raw(UART_PORT_NUM);
@@ -285,6 +1262,23 @@ void app_main(void) {
                 ets_delay_us(10);
             }
         }
+        if (arqMode) {
+            // Приём кадров ARQ с выдачей данных по порядку и подтверждениями
+            const arq_config_t config = arq_current_config();
+            arq_receive_step(&optical_link, &config, ARQ_LISTEN_TIMEOUT_US);
+        }
+        if (tdmaCoordinator) {
+            process_tdma_coordinator();
+        }
+        if (tdmaNode) {
+            process_tdma_node();
+        }
+        if (prbsTx) {
+            process_prbs_tx();
+        }
+        if (prbsRx) {
+            process_prbs_rx();
+        }
         if (infTest) {
             found_threshold();
         }
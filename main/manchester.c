@@ -0,0 +1,55 @@
+#include "manchester.h"
+
+#include <math.h>
+
+#include "perf.h"
+
+// Используем отношение среднего значение буфера сканирования по отношению к порогу: выше единицы => выше порога
+LIFI_HOT char decode_manchester_pair(const double first, const double second) {
+    if (first < 1 && second >= 1) {
+        return 1;
+    }
+    if (first >= 1 && second < 1) {
+        return 0;
+    }
+    if (fabs(first - second) < 0.02) {
+        return 2;
+    }
+    return second > first ? 1 : 0;
+}
+
+uint32_t manchester_pack_halves(const float* half_bits, const int count) {
+    uint32_t word = 0;
+    for (int i = 0; i < 32; ++i) {
+        word = word << 1 | (i < count && half_bits[i] >= 1);
+    }
+    return word;
+}
+
+LIFI_HOT uint16_t decode_manchester_word(
+    const float* half_bits, const int count, uint16_t* invalid, uint16_t* undecided
+) {
+    uint16_t valid;
+    uint16_t word = manchester_decode_word(manchester_pack_halves(half_bits, count), &valid);
+    // Пары, не целиком вошедшие в count, верными не считаются
+    const int pairs = count / 2;
+    valid &= pairs >= 16 ? 0xFFFF : (uint16_t)(0xFFFF << (16 - pairs));
+    *invalid = ~valid;
+    *undecided = 0;
+    for (uint16_t pending = ~valid; pending; pending &= pending - 1) {
+        const int bit = __builtin_ctz(pending);
+        const int pair = 15 - bit;
+        word &= ~(1u << bit);
+        if (2 * pair + 1 >= count) {
+            *undecided |= 1u << bit;
+            continue;
+        }
+        const float first = half_bits[2 * pair];
+        const float second = half_bits[2 * pair + 1];
+        if (decode_manchester_pair(first, second) == 2) {
+            *undecided |= 1u << bit;
+        }
+        word |= (second > first) << bit;
+    }
+    return word;
+}
@@ -0,0 +1,53 @@
+#ifndef MANCHESTER_H
+#define MANCHESTER_H
+
+#include <stdint.h>
+
+// Манчестерский код словами: полубиты упакованы в биты слова, первый полубит - в старшем.
+// Бит 1 передаётся парой 01 (сначала низкий уровень), бит 0 - парой 10
+
+// Биты байта в чётные позиции 16-битного слова: бит i -> бит 2i
+static inline uint16_t manchester_spread_byte(const uint8_t byte) {
+    uint16_t x = byte;
+    x = (x | (x << 4)) & 0x0F0F;
+    x = (x | (x << 2)) & 0x3333;
+    x = (x | (x << 1)) & 0x5555;
+    return x;
+}
+
+// Чётные биты 32-битного слова в 16 бит подряд: бит 2i -> бит i
+static inline uint16_t manchester_compact_word(uint32_t x) {
+    x &= 0x55555555;
+    x = (x | (x >> 1)) & 0x33333333;
+    x = (x | (x >> 2)) & 0x0F0F0F0F;
+    x = (x | (x >> 4)) & 0x00FF00FF;
+    x = (x | (x >> 8)) & 0x0000FFFF;
+    return (uint16_t)x;
+}
+
+// 16 полубитов байта: вторые половины пар - сами биты, первые - их инверсия
+static inline uint16_t manchester_encode_byte(const uint8_t byte) {
+    const uint16_t second = manchester_spread_byte(byte);
+    return second | (uint16_t)((second ^ 0x5555) << 1);
+}
+
+// 32 полубита в 16 бит данных (два байта, первый в старших битах). Бит valid сброшен у пар 00 и 11:
+// для них возвращённый бит - вторая половина пары, решение остаётся за вызывающим
+static inline uint16_t manchester_decode_word(const uint32_t halves, uint16_t* valid) {
+    *valid = manchester_compact_word(halves ^ (halves >> 1));
+    return manchester_compact_word(halves);
+}
+
+// Решение по паре полубитов (уровни относительно порога): 0, 1 или 2, если пара неразличима
+char decode_manchester_pair(double first, double second);
+
+// Упаковка полубитов-отношений к порогу (не меньше 1 - высокий уровень) в слово, count не больше 32.
+// Недостающие полубиты считаются низкими
+uint32_t manchester_pack_halves(const float* half_bits, int count);
+
+// Два байта из 32 полубитов (первый байт в старших битах): пары с пересечением порога декодируются
+// масками сразу для всего слова, остальные - по разности половин, как в decode_manchester_pair().
+// invalid - пары без пересечения порога, undecided - неразличимые и не попавшие в count полубитов
+uint16_t decode_manchester_word(const float* half_bits, int count, uint16_t* invalid, uint16_t* undecided);
+
+#endif //MANCHESTER_H
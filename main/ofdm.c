@@ -0,0 +1,371 @@
+#include "ofdm.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "fft.h"
+#include "prbs.h"
+#include "utils.h"
+
+// Доля расхождения, на которую оценка канала подстраивается по решениям на поднесущей:
+// отслеживает уход тактов АЦП и ЦАП за время кадра
+#define OFDM_TRACKING 0.25f
+
+// Уровни 16-QAM по коду Грея: 00, 01, 11, 10
+static const int8_t qam16_levels[4] = {-3, -1, 3, 1};
+
+typedef struct {
+    const uint8_t* data;
+    int len;
+    int position; // Номер следующего бита
+} bit_reader_t;
+
+static int read_bits(bit_reader_t* reader, const int count) {
+    int value = 0;
+    for (int i = 0; i < count; ++i, ++reader->position) {
+        const int byte = reader->position / 8;
+        const int bit = byte < reader->len ? (reader->data[byte] >> (7 - reader->position % 8)) & 1 : 0;
+        value = (value << 1) | bit;
+    }
+    return value;
+}
+
+typedef struct {
+    uint8_t* data;
+    int max_len;
+    int position;
+} bit_writer_t;
+
+static void write_bits(bit_writer_t* writer, const int value, const int count) {
+    for (int i = count - 1; i >= 0; --i, ++writer->position) {
+        const int byte = writer->position / 8;
+        if (byte >= writer->max_len) {
+            return;
+        }
+        if (writer->position % 8 == 0) {
+            writer->data[byte] = 0;
+        }
+        writer->data[byte] |= ((value >> i) & 1) << (7 - writer->position % 8);
+    }
+}
+
+// Скремблирование бит заголовка и данных: повторяющиеся биты иначе складываются на всех поднесущих
+// в один пик, который ЦАП обрезает
+static int scramble(prbs_gen_t* scrambler, const int value, const int count) {
+    int mask = 0;
+    for (int i = 0; i < count; ++i) {
+        mask = (mask << 1) | prbs_next_bit(scrambler);
+    }
+    return value ^ mask;
+}
+
+// Знаки пилотов: PRBS7, одна последовательность на все пилотные символы
+static int8_t pilot_signs[OFDM_PILOT_SYMBOLS][OFDM_CARRIERS];
+
+static void init_tables(void) {
+    static int ready = 0;
+    if (ready) {
+        return;
+    }
+    fft_init();
+    prbs_gen_t gen;
+    prbs_init(&gen, PRBS_7);
+    for (int s = 0; s < OFDM_PILOT_SYMBOLS; ++s) {
+        for (int k = 0; k < OFDM_CARRIERS; ++k) {
+            pilot_signs[s][k] = prbs_next_bit(&gen) ? -1 : 1;
+        }
+    }
+    ready = 1;
+}
+
+// Точка созвездия с единичной средней мощностью
+static void map_point(const int value, const int bits, float* re, float* im) {
+    switch (bits) {
+        case 1:
+            *re = value ? -1.0f : 1.0f;
+            *im = 0;
+            break;
+        case 2:
+            *re = (value & 2 ? -1.0f : 1.0f) * (float)M_SQRT1_2;
+            *im = (value & 1 ? -1.0f : 1.0f) * (float)M_SQRT1_2;
+            break;
+        case 4:
+            *re = qam16_levels[value >> 2] / sqrtf(10);
+            *im = qam16_levels[value & 3] / sqrtf(10);
+            break;
+        default:
+            *re = *im = 0;
+            break;
+    }
+}
+
+// Ближайшая точка созвездия: код и сама точка
+static int demap_point(const float re, const float im, const int bits, float* point_re, float* point_im) {
+    int value = 0;
+    switch (bits) {
+        case 1:
+            value = re < 0;
+            break;
+        case 2:
+            value = (re < 0) << 1 | (im < 0);
+            break;
+        case 4: {
+            const float scale = sqrtf(10);
+            const float i_level = re * scale;
+            const float q_level = im * scale;
+            const int i_code = i_level < -2 ? 0 : i_level < 0 ? 1 : i_level < 2 ? 3 : 2;
+            const int q_code = q_level < -2 ? 0 : q_level < 0 ? 1 : q_level < 2 ? 3 : 2;
+            value = i_code << 2 | q_code;
+            break;
+        }
+        default:
+            break;
+    }
+    map_point(value, bits, point_re, point_im);
+    return value;
+}
+
+void ofdm_loading_uniform(ofdm_loading_t* loading, const int bits) {
+    memset(loading->bits, bits, sizeof(loading->bits));
+}
+
+int ofdm_symbol_bits(const ofdm_loading_t* loading) {
+    int bits = 0;
+    for (int k = 0; k < OFDM_CARRIERS; ++k) {
+        bits += loading->bits[k];
+    }
+    return bits;
+}
+
+int ofdm_frame_capacity(const ofdm_loading_t* loading) {
+    const int bytes = ofdm_symbol_bits(loading) * OFDM_MAX_DATA_SYMBOLS / 8;
+    return bytes < OFDM_MAX_DATA ? bytes : OFDM_MAX_DATA;
+}
+
+// Код числа бит поднесущей в заголовке
+static int loading_code(const int bits) {
+    return bits == 4 ? 3 : bits;
+}
+
+static int loading_bits(const int code) {
+    return code == 3 ? 4 : code;
+}
+
+// Символ из точек поднесущих 1..OFDM_CARRIERS (единичная мощность): эрмитова симметрия, обратное БПФ,
+// циклический префикс, отсчёты ЦАП
+static void emit_symbol(const float* re, const float* im, uint8_t* samples) {
+    fft_complex_t buffer[OFDM_N];
+    memset(buffer, 0, sizeof(buffer));
+    for (int k = 1; k <= OFDM_CARRIERS; ++k) {
+        buffer[k].re = (int16_t)lrintf(re[k - 1] * OFDM_AMPLITUDE);
+        buffer[k].im = (int16_t)lrintf(im[k - 1] * OFDM_AMPLITUDE);
+        buffer[OFDM_N - k].re = buffer[k].re;
+        buffer[OFDM_N - k].im = -buffer[k].im;
+    }
+    fft_q15(buffer, OFDM_LOG2_N, 1);
+    for (int n = 0; n < OFDM_N; ++n) {
+        const int value = OFDM_DAC_BIAS + (buffer[n].re >> OFDM_DAC_SHIFT);
+        samples[OFDM_CP + n] = value < 0 ? 0 : value > 255 ? 255 : value;
+    }
+    memcpy(samples, samples + OFDM_N, OFDM_CP);
+}
+
+int ofdm_modulate(const ofdm_loading_t* loading, const uint8_t* data, const int len, uint8_t* samples) {
+    init_tables();
+    float re[OFDM_CARRIERS];
+    float im[OFDM_CARRIERS];
+    int count = 0;
+
+    for (int s = 0; s < OFDM_PILOT_SYMBOLS; ++s) {
+        for (int k = 0; k < OFDM_CARRIERS; ++k) {
+            re[k] = pilot_signs[s][k];
+            im[k] = 0;
+        }
+        emit_symbol(re, im, samples + count);
+        count += OFDM_SYMBOL_SAMPLES;
+    }
+
+    prbs_gen_t scrambler;
+    prbs_init(&scrambler, PRBS_15);
+    uint8_t header[OFDM_HEADER_BYTES] = {0};
+    bit_writer_t writer = {header, OFDM_HEADER_BYTES, 0};
+    for (int k = 0; k < OFDM_CARRIERS; ++k) {
+        write_bits(&writer, loading_code(loading->bits[k]), 2);
+    }
+    write_bits(&writer, len, 16);
+    const uint16_t crc = crc16_ccitt(header, OFDM_HEADER_BYTES - 2);
+    header[OFDM_HEADER_BYTES - 2] = crc >> 8;
+    header[OFDM_HEADER_BYTES - 1] = crc & 0xFF;
+    bit_reader_t reader = {header, OFDM_HEADER_BYTES, 0};
+    for (int s = 0; s < OFDM_HEADER_SYMBOLS; ++s) {
+        for (int k = 0; k < OFDM_CARRIERS; ++k) {
+            if (k < OFDM_HEADER_CARRIERS) {
+                map_point(scramble(&scrambler, read_bits(&reader, 1), 1), 1, &re[k], &im[k]);
+            } else {
+                re[k] = im[k] = 0;
+            }
+        }
+        emit_symbol(re, im, samples + count);
+        count += OFDM_SYMBOL_SAMPLES;
+    }
+
+    const int symbol_bits = ofdm_symbol_bits(loading);
+    const int symbols = symbol_bits > 0 ? (len * 8 + symbol_bits - 1) / symbol_bits : 0;
+    reader = (bit_reader_t){data, len, 0};
+    for (int s = 0; s < symbols && s < OFDM_MAX_DATA_SYMBOLS; ++s) {
+        for (int k = 0; k < OFDM_CARRIERS; ++k) {
+            const int bits = loading->bits[k];
+            map_point(scramble(&scrambler, read_bits(&reader, bits), bits), bits, &re[k], &im[k]);
+        }
+        emit_symbol(re, im, samples + count);
+        count += OFDM_SYMBOL_SAMPLES;
+    }
+    return count;
+}
+
+// Спектр окна символа: постоянная составляющая убирается, масштаб подбирается под Q15 и возвращается в float
+static void analyse_symbol(const int16_t* window, float* re, float* im) {
+    int32_t sum = 0;
+    for (int n = 0; n < OFDM_N; ++n) {
+        sum += window[n];
+    }
+    const int mean = sum / OFDM_N;
+    int peak = 1;
+    for (int n = 0; n < OFDM_N; ++n) {
+        const int value = window[n] - mean;
+        if ((value < 0 ? -value : value) > peak) {
+            peak = value < 0 ? -value : value;
+        }
+    }
+    int shift = 0;
+    while ((peak << (shift + 1)) < 16384 && shift < 12) {
+        ++shift;
+    }
+    fft_complex_t buffer[OFDM_N];
+    for (int n = 0; n < OFDM_N; ++n) {
+        buffer[n].re = (window[n] - mean) << shift;
+        buffer[n].im = 0;
+    }
+    fft_q15(buffer, OFDM_LOG2_N, 0);
+    const float scale = 1.0f / (1 << shift);
+    for (int k = 1; k <= OFDM_CARRIERS; ++k) {
+        re[k - 1] = buffer[k].re * scale;
+        im[k - 1] = buffer[k].im * scale;
+    }
+}
+
+int ofdm_demodulate(const int16_t* samples, const int count, uint8_t* data, const int max_len, ofdm_channel_t* channel) {
+    init_tables();
+    // Окно БПФ каждого символа начинается после префикса относительно начала буфера
+    int symbol = 0;
+#define OFDM_WINDOW(s) (samples + (s) * OFDM_SYMBOL_SAMPLES + OFDM_CP)
+    if (count < (OFDM_PILOT_SYMBOLS + OFDM_HEADER_SYMBOLS) * OFDM_SYMBOL_SAMPLES + OFDM_CP) {
+        return -1;
+    }
+
+    // Оценка канала: среднее по пилотам, шум - по их разности
+    float y_re[OFDM_PILOT_SYMBOLS][OFDM_CARRIERS];
+    float y_im[OFDM_PILOT_SYMBOLS][OFDM_CARRIERS];
+    for (int s = 0; s < OFDM_PILOT_SYMBOLS; ++s, ++symbol) {
+        analyse_symbol(OFDM_WINDOW(symbol), y_re[s], y_im[s]);
+    }
+    float h_re[OFDM_CARRIERS];
+    float h_im[OFDM_CARRIERS];
+    float noise[OFDM_CARRIERS];
+    int noise_count[OFDM_CARRIERS];
+    for (int k = 0; k < OFDM_CARRIERS; ++k) {
+        const float r0 = y_re[0][k] * pilot_signs[0][k];
+        const float i0 = y_im[0][k] * pilot_signs[0][k];
+        const float r1 = y_re[1][k] * pilot_signs[1][k];
+        const float i1 = y_im[1][k] * pilot_signs[1][k];
+        h_re[k] = (r0 + r1) / 2;
+        h_im[k] = (i0 + i1) / 2;
+        noise[k] = ((r0 - r1) * (r0 - r1) + (i0 - i1) * (i0 - i1)) / 2;
+        noise_count[k] = 1;
+    }
+
+    // Заголовок, попутно - ещё отсчёты шума по решениям
+    prbs_gen_t scrambler;
+    prbs_init(&scrambler, PRBS_15);
+    uint8_t header[OFDM_HEADER_BYTES];
+    bit_writer_t writer = {header, OFDM_HEADER_BYTES, 0};
+    float re[OFDM_CARRIERS];
+    float im[OFDM_CARRIERS];
+    for (int s = 0; s < OFDM_HEADER_SYMBOLS; ++s, ++symbol) {
+        analyse_symbol(OFDM_WINDOW(symbol), re, im);
+        for (int k = 0; k < OFDM_HEADER_CARRIERS; ++k) {
+            // Проекция на оценку канала: знак BPSK не зависит от её модуля
+            const float projection = re[k] * h_re[k] + im[k] * h_im[k];
+            const int bit = projection < 0;
+            write_bits(&writer, scramble(&scrambler, bit, 1), 1);
+            const float sign = bit ? -1.0f : 1.0f;
+            const float e_re = re[k] - sign * h_re[k];
+            const float e_im = im[k] - sign * h_im[k];
+            // Оценка канала сама содержит половину шума пилотов, отсюда множитель
+            noise[k] += (e_re * e_re + e_im * e_im) / 1.5f;
+            ++noise_count[k];
+        }
+    }
+    const uint16_t crc = crc16_ccitt(header, OFDM_HEADER_BYTES - 2);
+    if (header[OFDM_HEADER_BYTES - 2] != (crc >> 8) || header[OFDM_HEADER_BYTES - 1] != (crc & 0xFF)) {
+        return -1;
+    }
+    bit_reader_t reader = {header, OFDM_HEADER_BYTES, 0};
+    for (int k = 0; k < OFDM_CARRIERS; ++k) {
+        channel->loading.bits[k] = loading_bits(read_bits(&reader, 2));
+    }
+    const int len = read_bits(&reader, 16);
+
+    // SNR поднесущих со сглаживанием шума по соседним: одиночная оценка шума слишком разбросана
+    for (int k = 0; k < OFDM_CARRIERS; ++k) {
+        float sum = 0;
+        int n = 0;
+        for (int j = k - 1; j <= k + 1; ++j) {
+            if (j >= 0 && j < OFDM_CARRIERS) {
+                sum += noise[j] / noise_count[j];
+                ++n;
+            }
+        }
+        const float power = h_re[k] * h_re[k] + h_im[k] * h_im[k];
+        const float snr = power / (sum / n + 1e-9f);
+        channel->snr_db[k] = 10 * log10f(snr + 1e-9f);
+        channel->suggested.bits[k] = channel->snr_db[k] >= OFDM_SNR_QAM16_DB ? 4
+                                   : channel->snr_db[k] >= OFDM_SNR_QPSK_DB ? 2
+                                   : channel->snr_db[k] >= OFDM_SNR_BPSK_DB ? 1 : 0;
+    }
+
+    const int symbol_bits = ofdm_symbol_bits(&channel->loading);
+    if (len > ofdm_frame_capacity(&channel->loading) || len > max_len) {
+        return -1;
+    }
+    const int symbols = symbol_bits > 0 ? (len * 8 + symbol_bits - 1) / symbol_bits : 0;
+    if (count < (OFDM_PILOT_SYMBOLS + OFDM_HEADER_SYMBOLS + symbols) * OFDM_SYMBOL_SAMPLES) {
+        return -1;
+    }
+
+    writer = (bit_writer_t){data, max_len, 0};
+    for (int s = 0; s < symbols; ++s, ++symbol) {
+        analyse_symbol(OFDM_WINDOW(symbol), re, im);
+        for (int k = 0; k < OFDM_CARRIERS; ++k) {
+            const int bits = channel->loading.bits[k];
+            if (bits == 0) {
+                continue;
+            }
+            // Выравнивание: деление на оценку канала
+            const float power = h_re[k] * h_re[k] + h_im[k] * h_im[k] + 1e-9f;
+            const float z_re = (re[k] * h_re[k] + im[k] * h_im[k]) / power;
+            const float z_im = (im[k] * h_re[k] - re[k] * h_im[k]) / power;
+            float d_re;
+            float d_im;
+            write_bits(&writer, scramble(&scrambler, demap_point(z_re, z_im, bits, &d_re, &d_im), bits), bits);
+            // Подстройка канала по решению: H += mu * (Y / d - H)
+            const float d_power = d_re * d_re + d_im * d_im;
+            const float m_re = (re[k] * d_re + im[k] * d_im) / d_power;
+            const float m_im = (im[k] * d_re - re[k] * d_im) / d_power;
+            h_re[k] += OFDM_TRACKING * (m_re - h_re[k]);
+            h_im[k] += OFDM_TRACKING * (m_im - h_im[k]);
+        }
+    }
+#undef OFDM_WINDOW
+    return len;
+}
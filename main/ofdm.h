@@ -0,0 +1,69 @@
+#ifndef OFDM_H
+#define OFDM_H
+
+#include <stdint.h>
+
+// DCO-OFDM: вещественный сигнал из эрмитово-симметричного спектра, сдвинутый постоянной составляющей
+// в неотрицательную область яркости светодиода
+#define OFDM_LOG2_N 6
+#define OFDM_N (1 << OFDM_LOG2_N)
+// Циклический префикс: поглощает затянутый спад светодиода и неточность начала кадра
+#define OFDM_CP 8
+#define OFDM_SYMBOL_SAMPLES (OFDM_N + OFDM_CP)
+// Поднесущие 1..N/2-1 несут данные, N-k - их сопряжения, нулевая и N/2 пустые
+#define OFDM_CARRIERS (OFDM_N / 2 - 1)
+
+// Кадр: пилоты (известный BPSK) для оценки канала, заголовок, данные.
+// Заголовок - BPSK на нижних поднесущих (они переживают спад АЧХ светодиода): распределение бит
+// по 2 бита на поднесущую, длина данных и CRC-16
+#define OFDM_PILOT_SYMBOLS 2
+#define OFDM_HEADER_SYMBOLS 4
+#define OFDM_HEADER_CARRIERS 24
+#define OFDM_HEADER_BYTES (OFDM_HEADER_SYMBOLS * OFDM_HEADER_CARRIERS / 8)
+#define OFDM_MAX_DATA_SYMBOLS 64
+#define OFDM_MAX_SYMBOLS (OFDM_PILOT_SYMBOLS + OFDM_HEADER_SYMBOLS + OFDM_MAX_DATA_SYMBOLS)
+#define OFDM_MAX_SAMPLES (OFDM_MAX_SYMBOLS * OFDM_SYMBOL_SAMPLES)
+#define OFDM_MAX_DATA 256
+
+// Амплитуда поднесущей с единичной средней мощностью созвездия, Q15
+#define OFDM_AMPLITUDE 10240
+// Отсчёт ЦАП: смещение плюс сигнал после обратного БПФ. СКО около 20 кодов: пик-фактор OFDM велик,
+// ограничение по краям шкалы наступает только после 6 СКО
+#define OFDM_DAC_BIAS 128
+#define OFDM_DAC_SHIFT 6
+
+// Пороги SNR поднесущей (дБ) для 1, 2 и 4 бит (BPSK, QPSK, 16-QAM): вероятность ошибки около 1e-3
+// с учётом разброса оценки по одному кадру
+#define OFDM_SNR_BPSK_DB 10
+#define OFDM_SNR_QPSK_DB 13
+#define OFDM_SNR_QAM16_DB 20
+
+// Бит на поднесущую 1..OFDM_CARRIERS: 0, 1, 2 или 4
+typedef struct {
+    uint8_t bits[OFDM_CARRIERS];
+} ofdm_loading_t;
+
+// Оценка канала по последнему принятому кадру
+typedef struct {
+    float snr_db[OFDM_CARRIERS];
+    ofdm_loading_t suggested; // Распределение бит, которое выдержит этот канал
+    ofdm_loading_t loading;   // Распределение, с которым кадр был передан
+} ofdm_channel_t;
+
+// Одинаковое число бит на всех поднесущих
+void ofdm_loading_uniform(ofdm_loading_t* loading, int bits);
+
+// Бит в одном символе
+int ofdm_symbol_bits(const ofdm_loading_t* loading);
+
+// Наибольшая полезная нагрузка кадра с таким распределением
+int ofdm_frame_capacity(const ofdm_loading_t* loading);
+
+// Кадр в отсчёты ЦАП (0..255). len не больше ofdm_frame_capacity(). Возвращает число отсчётов
+int ofdm_modulate(const ofdm_loading_t* loading, const uint8_t* data, int len, uint8_t* samples);
+
+// Кадр из отсчётов АЦП. samples начинаются не позже начала кадра и не раньше чем за OFDM_CP / 2 отсчётов до него
+// Возвращает число байт данных или -1, если заголовок или длина не прошли проверку
+int ofdm_demodulate(const int16_t* samples, int count, uint8_t* data, int max_len, ofdm_channel_t* channel);
+
+#endif //OFDM_H
@@ -0,0 +1,118 @@
+#include "perf.h"
+
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <rtc_wdt.h>
+#include <stdio.h>
+#include <driver/adc.h>
+#include <rom/ets_sys.h>
+
+#include "console.h"
+#include "sender.h"
+
+#define PERF_ADC_SAMPLES 10000
+// Столько же отсчётов, но с шагом цикла приёма: время, метка таймера, АЦП и пауза 10 мкс
+#define PERF_RX_SAMPLES 10000
+#define PERF_TX_BITS 256
+// Кадр, на котором раньше был заметен уход приёмника из окон
+#define PERF_FRAME_BYTES 1000
+// Длинные периоды не замеряются целиком, чтобы замер не занимал минуты
+#define PERF_TX_MAX_US 2000000
+
+#if CONFIG_LIFI_PERF_PROFILE
+// Профиль включён в sdkconfig, собранном не из sdkconfig.defaults.perf: остальные его настройки не применились
+#if !CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ_240 || !CONFIG_COMPILER_OPTIMIZATION_PERF || !CONFIG_GPIO_CTRL_FUNC_IN_IRAM
+#error "LIFI_PERF_PROFILE needs 240 MHz, -O2 and GPIO control in IRAM: build with -D SDKCONFIG=sdkconfig.perf, see sdkconfig.defaults.perf"
+#endif
+#if CONFIG_ESP_TASK_WDT_EN || CONFIG_ESP_INT_WDT
+#error "LIFI_PERF_PROFILE needs the task and interrupt watchdogs off like the committed sdkconfig, see sdkconfig.defaults.perf"
+#endif
+#define PERF_PROFILE_NAME "performance"
+#else
+#define PERF_PROFILE_NAME "default"
+#endif
+
+void perf_measure(const int frequency, perf_result_t* result) {
+    result->cpu_mhz = ets_get_cpu_frequency();
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < PERF_ADC_SAMPLES; ++i) {
+        adc1_get_raw(ADC1_CHANNEL_4);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    result->adc_samples_per_s = PERF_ADC_SAMPLES * 1000000LL / (elapsed > 0 ? elapsed : 1);
+    rtc_wdt_feed();
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < PERF_RX_SAMPLES; ++i) {
+        esp_timer_get_time();
+        rtc_wdt_feed();
+        adc1_get_raw(ADC1_CHANNEL_4);
+        ets_delay_us(10);
+    }
+    elapsed = esp_timer_get_time() - start;
+    result->rx_samples_per_s = PERF_RX_SAMPLES * 1000000LL / (elapsed > 0 ? elapsed : 1);
+
+    int half_period_us = 500000 / frequency;
+    if (half_period_us < 1) half_period_us = 1;
+    const int period_us = 2 * half_period_us;
+    int bits = PERF_TX_MAX_US / period_us;
+    if (bits > PERF_TX_BITS) bits = PERF_TX_BITS;
+    if (bits < 2) bits = 2;
+
+    // Метка счётчика тактов после каждого бита: отклонение отдельных периодов и накопленный уход
+    const int64_t period_cycles = (int64_t)period_us * result->cpu_mhz;
+    int64_t error_sum_cycles = 0;
+    int64_t max_error_cycles = 0;
+    tx_timebase_start();
+    const uint32_t first = esp_cpu_get_cycle_count();
+    uint32_t last = first;
+    for (int i = 0; i < bits; ++i) {
+        send_manchester_bit(i & 1, half_period_us);
+        const uint32_t now = esp_cpu_get_cycle_count();
+        const int64_t error = (int64_t)(uint32_t)(now - last) - period_cycles;
+        error_sum_cycles += error;
+        if ((error < 0 ? -error : error) > max_error_cycles) {
+            max_error_cycles = error < 0 ? -error : error;
+        }
+        last = now;
+        rtc_wdt_feed();
+    }
+    send_manchester_bit(-1, half_period_us);
+
+    result->tx_bits = bits;
+    result->tx_period_us = period_us;
+    result->tx_mean_error_ns = error_sum_cycles * 1000 / bits / result->cpu_mhz;
+    result->tx_max_error_ns = max_error_cycles * 1000 / result->cpu_mhz;
+    result->tx_drift_us = ((int64_t)(uint32_t)(last - first) - bits * period_cycles) / result->cpu_mhz;
+
+    // Кадр целиком через обычный путь передачи: длительность против номинальной
+    static uint8_t frame[PERF_FRAME_BYTES];
+    int frame_bytes = (int)((PERF_TX_MAX_US / 8) * (int64_t)frequency / 1000000);
+    if (frame_bytes > PERF_FRAME_BYTES) frame_bytes = PERF_FRAME_BYTES;
+    if (frame_bytes < 1) frame_bytes = 1;
+    for (int i = 0; i < frame_bytes; ++i) {
+        frame[i] = i * 37;
+    }
+    start = esp_timer_get_time();
+    send_manchester_frame(frame, frame_bytes, frequency);
+    elapsed = esp_timer_get_time() - start;
+    result->frame_bytes = frame_bytes;
+    result->frame_drift_us = elapsed - SYNC_SEQ_DURATION_US - (int64_t)(frame_bytes + 1) * 8 * 1000000 / frequency;
+}
+
+void perf_report(const uart_port_t uart_port, const perf_result_t* result) {
+    char buffer[320];
+    const int len = snprintf(
+        buffer, sizeof(buffer),
+        "Profile: %s, CPU %lu MHz\r\n"
+        "ADC: %lu samples/s raw, %lu samples/s in the receive loop\r\n"
+        "TX: %d bits of %d us, mean error %d ns, max error %d ns, drift %d us\r\n"
+        "Frame: %d bytes, drift %d us\r\n",
+        PERF_PROFILE_NAME, (unsigned long)result->cpu_mhz,
+        (unsigned long)result->adc_samples_per_s, (unsigned long)result->rx_samples_per_s,
+        result->tx_bits, result->tx_period_us, result->tx_mean_error_ns, result->tx_max_error_ns,
+        result->tx_drift_us, result->frame_bytes, result->frame_drift_us
+    );
+    console_write(uart_port, buffer, len);
+}
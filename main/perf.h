@@ -0,0 +1,39 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <esp_attr.h>
+#include <hal/uart_types.h>
+
+#include "sdkconfig.h"
+
+// Профиль производительности (CONFIG_LIFI_PERF_PROFILE, sdkconfig.defaults.perf):
+// циклы передачи и приёма и их таблицы лежат во внутренней памяти, промахи кэша флеш-памяти не сбивают тайминги
+#if CONFIG_LIFI_PERF_PROFILE
+#define LIFI_HOT IRAM_ATTR
+#define LIFI_HOT_DATA DRAM_ATTR
+#else
+#define LIFI_HOT
+#define LIFI_HOT_DATA
+#endif
+
+typedef struct {
+    uint32_t cpu_mhz;
+    uint32_t adc_samples_per_s;   // Чтение АЦП без задержек
+    uint32_t rx_samples_per_s;    // Итерации цикла приёма кадра
+    int tx_bits;                  // Переданные биты замера передачи
+    int tx_period_us;             // Номинальный период бита
+    int tx_mean_error_ns;         // Средняя ошибка периода бита
+    int tx_max_error_ns;          // Наибольшее отклонение одного периода
+    int tx_drift_us;              // Расхождение конца передачи с номинальным
+    int frame_bytes;              // Кадр целиком: синхропоследовательность и данные
+    int frame_drift_us;
+} perf_result_t;
+
+// Замер скорости выборки АЦП, дрожания периода бита передачи и ухода длительности кадра на заданной частоте.
+// Светодиод мигает во время замера
+void perf_measure(int frequency, perf_result_t* result);
+
+void perf_report(uart_port_t uart_port, const perf_result_t* result);
+
+#endif //PERF_H
@@ -0,0 +1,97 @@
+#include "ppm.h"
+
+int ppm_bits_per_symbol(const int order) {
+    switch (order) {
+        case 4: return 2;
+        case 8: return 3;
+        case 16: return 4;
+        default: return 0;
+    }
+}
+
+int ppm_pack_symbols(
+    const int order, const uint8_t* data, const int len,
+    uint8_t* symbols, const int max_symbols
+) {
+    const int bits = ppm_bits_per_symbol(order);
+    if (bits == 0) {
+        return 0;
+    }
+    const uint8_t mask = order - 1;
+    uint32_t accumulator = 0;
+    int accumulated = 0;
+    int count = 0;
+    for (int i = 0; i < len; ++i) {
+        accumulator = (accumulator << 8) | data[i];
+        accumulated += 8;
+        while (accumulated >= bits && count < max_symbols) {
+            accumulated -= bits;
+            symbols[count++] = (accumulator >> accumulated) & mask;
+        }
+    }
+    // Остаток дополняем нулями справа
+    if (accumulated > 0 && count < max_symbols) {
+        symbols[count++] = (accumulator << (bits - accumulated)) & mask;
+    }
+    return count;
+}
+
+int ppm_unpack_symbols(
+    const int order, const uint8_t* symbols, const int count,
+    uint8_t* data, const int max_len
+) {
+    const int bits = ppm_bits_per_symbol(order);
+    uint32_t accumulator = 0;
+    int accumulated = 0;
+    int len = 0;
+    for (int i = 0; i < count && len < max_len; ++i) {
+        accumulator = (accumulator << bits) | symbols[i];
+        accumulated += bits;
+        if (accumulated >= 8) {
+            accumulated -= 8;
+            data[len++] = accumulator >> accumulated;
+        }
+    }
+    return len;
+}
+
+int ppm_decode_pulses(
+    const int order, const int slot_us, const int64_t* pulses, const int count,
+    uint8_t* symbols, const int max_symbols
+) {
+    if (ppm_bits_per_symbol(order) == 0 || slot_us <= 0 || count < 1) {
+        return 0;
+    }
+    // Начало символа anchor, к которому привязан отсчёт (опорный импульс - символ -1, слот 0)
+    int64_t symbol_start = pulses[0];
+    int anchor = -1;
+    int decoded = 0;
+    for (int i = 1; i < count && decoded < max_symbols; ++i) {
+        if (pulses[i] < symbol_start) {
+            continue;
+        }
+        // Номер символа и слота с округлением до ближайшего слота
+        const int64_t offset_slots = (pulses[i] - symbol_start + slot_us / 2) / slot_us;
+        const int next = anchor + (int)(offset_slots / order);
+        if (next < decoded) {
+            // Лишний импульс (помеха) в символе, который уже принят
+            continue;
+        }
+        // Пропущенные символы (импульс не принят)
+        while (decoded < next && decoded < max_symbols) {
+            symbols[decoded++] = 0;
+        }
+        if (decoded >= max_symbols) {
+            break;
+        }
+        const int slot = offset_slots % order;
+        symbols[decoded++] = slot;
+        // Подстройка начала символа к импульсу на долю расхождения: дрожание моментов отсчёта сглаживается,
+        // медленный уход тактов отслеживается
+        const int64_t predicted = symbol_start + (int64_t)(next - anchor) * order * slot_us;
+        const int64_t measured = pulses[i] - (int64_t)slot * slot_us;
+        symbol_start = predicted + (measured - predicted) / PPM_TRACKING_DIVISOR;
+        anchor = next;
+    }
+    return decoded;
+}
@@ -0,0 +1,35 @@
+#ifndef PPM_H
+#define PPM_H
+
+#include <stdint.h>
+
+// L-PPM: символ из L слотов, светодиод включается ровно в одном из них, номер слота переносит log2(L) бит.
+// Слот равен полупериоду манчестерского кода на той же частоте - самый короткий импульс не меняется
+#define PPM_MAX_ORDER 16
+// Наибольший блок данных одного кадра
+#define PPM_FRAME_MAX_DATA 128
+#define PPM_MAX_SYMBOLS (PPM_FRAME_MAX_DATA * 8 / 2)
+// Кадр: опорный импульс в начале символа -1, затем символы данных. Тишина дольше стольких символов - конец кадра
+#define PPM_END_SILENCE_SYMBOLS 3
+// Начало символа сдвигается к каждому принятому импульсу на 1/PPM_TRACKING_DIVISOR расхождения
+#define PPM_TRACKING_DIVISOR 4
+
+// 4, 8 или 16 - число бит на символ, иначе 0
+int ppm_bits_per_symbol(int order);
+
+// Разбиение байтов на номера слотов (старшие биты первыми, последний символ дополняется нулями)
+// Возвращает число символов
+int ppm_pack_symbols(int order, const uint8_t* data, int len, uint8_t* symbols, int max_symbols);
+
+// Сборка байтов из символов, неполный последний байт (дополнение) отбрасывается. Возвращает число байт
+int ppm_unpack_symbols(int order, const uint8_t* symbols, int count, uint8_t* data, int max_len);
+
+// Символы по моментам начала импульсов (мкс), первый импульс - опорный. Начало символов подстраивается
+// по принятым импульсам, поэтому расхождение тактов передатчика и приёмника не накапливается.
+// Символ без импульса принимается как 0, импульс в уже занятом символе отбрасывается
+// Возвращает число символов
+int ppm_decode_pulses(
+    int order, int slot_us, const int64_t* pulses, int count, uint8_t* symbols, int max_symbols
+);
+
+#endif //PPM_H
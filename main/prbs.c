@@ -0,0 +1,161 @@
+#include "prbs.h"
+
+#include <string.h>
+
+// Второй отвод обратной связи
+static int prbs_tap(const prbs_order_t order) {
+    switch (order) {
+        case PRBS_7: return 6;
+        case PRBS_15: return 14;
+        default: return 28;
+    }
+}
+
+static uint32_t prbs_mask(const prbs_order_t order) {
+    return order == PRBS_31 ? 0x7FFFFFFFu : (1u << order) - 1;
+}
+
+// Бит обратной связи от регистра, в котором младший бит - последний выданный
+static int feedback(const prbs_order_t order, const uint32_t state) {
+    return ((state >> (order - 1)) ^ (state >> (prbs_tap(order) - 1))) & 1;
+}
+
+void prbs_init(prbs_gen_t* gen, const prbs_order_t order) {
+    gen->order = order;
+    gen->state = prbs_mask(order);
+}
+
+int prbs_next_bit(prbs_gen_t* gen) {
+    const int bit = feedback(gen->order, gen->state);
+    gen->state = ((gen->state << 1) | bit) & prbs_mask(gen->order);
+    return bit;
+}
+
+void prbs_fill(prbs_gen_t* gen, uint8_t* data, const int len) {
+    for (int i = 0; i < len; ++i) {
+        uint8_t byte = 0;
+        for (int b = 0; b < 8; ++b) {
+            byte = (byte << 1) | prbs_next_bit(gen);
+        }
+        data[i] = byte;
+    }
+}
+
+void prbs_checker_init(prbs_checker_t* checker, const prbs_order_t order) {
+    memset(checker, 0, sizeof(*checker));
+    prbs_init(&checker->local, order);
+    prbs_init(&checker->reference, order);
+}
+
+static void end_burst(prbs_checker_t* checker) {
+    if (checker->burst_length > 0) {
+        ++checker->stats.bursts;
+        if (checker->burst_length > checker->stats.max_burst) {
+            checker->stats.max_burst = checker->burst_length;
+        }
+        checker->burst_length = 0;
+    }
+}
+
+// Захват: регистр заполнен принятыми битами. Если он совпадает с опорной последовательностью
+// со сдвигом в несколько бит - это проскальзывание, иначе - новая синхронизация
+static void lock(prbs_checker_t* checker) {
+    const prbs_order_t order = checker->local.order;
+    const uint32_t state = checker->shift & prbs_mask(order);
+    if (checker->reference_valid) {
+        int slipped = 0;
+        for (int i = 0; i < PRBS_MAX_SLIP && !slipped; ++i) {
+            slipped = checker->history[i] == state;
+        }
+        prbs_gen_t ahead = checker->reference;
+        for (int i = 0; i < PRBS_MAX_SLIP && !slipped; ++i) {
+            prbs_next_bit(&ahead);
+            slipped = ahead.state == state;
+        }
+        if (slipped) {
+            ++checker->stats.slips;
+        } else {
+            ++checker->stats.sync_losses;
+        }
+    }
+    checker->local.state = state;
+    checker->locked = 1;
+    checker->window_bits = 0;
+    checker->window_errors = 0;
+    checker->gap = PRBS_BURST_GAP;
+}
+
+static void unlock(prbs_checker_t* checker) {
+    // Незакрытая пачка - начало рассинхронизации, в статистику канала не идёт
+    checker->burst_length = 0;
+    // Опорная последовательность продолжает идти, пока ищется новый синхронизм
+    checker->reference = checker->local;
+    checker->reference_valid = 1;
+    memset(checker->history, 0, sizeof(checker->history));
+    checker->locked = 0;
+    checker->filled = 0;
+    checker->matches = 0;
+}
+
+static void check_bit(prbs_checker_t* checker, const int bit) {
+    const prbs_order_t order = checker->local.order;
+    if (!checker->locked) {
+        if (checker->reference_valid) {
+            memmove(checker->history + 1, checker->history, sizeof(checker->history) - sizeof(checker->history[0]));
+            checker->history[0] = checker->reference.state;
+            prbs_next_bit(&checker->reference);
+        }
+        // Самосинхронизация: бит предсказывается по предыдущим принятым битам
+        if (checker->filled >= (int)order) {
+            checker->matches = feedback(order, checker->shift) == bit ? checker->matches + 1 : 0;
+        }
+        checker->shift = (checker->shift << 1) | bit;
+        ++checker->filled;
+        // Захват после стольких верных предсказаний подряд, сколько бит в регистре
+        if (checker->matches >= (int)order) {
+            lock(checker);
+        }
+        return;
+    }
+
+    const int expected = prbs_next_bit(&checker->local);
+    ++checker->stats.bits;
+    ++checker->window_bits;
+    if (expected != bit) {
+        ++checker->stats.errors;
+        ++checker->window_errors;
+        // Пачка закрывается после PRBS_BURST_GAP верных бит, до этого верные биты между ошибками входят в её длину
+        checker->burst_length = checker->burst_length > 0 ? checker->burst_length + checker->gap + 1 : 1;
+        checker->gap = 0;
+    } else if (++checker->gap == PRBS_BURST_GAP) {
+        end_burst(checker);
+    }
+    if (checker->window_bits == PRBS_LOSS_WINDOW) {
+        if (checker->window_errors > PRBS_LOSS_ERRORS) {
+            // Ошибки этого окна - следствие рассинхронизации, а не канала
+            checker->stats.errors -= checker->window_errors;
+            checker->stats.bits -= checker->window_bits;
+            unlock(checker);
+            return;
+        }
+        checker->window_bits = 0;
+        checker->window_errors = 0;
+    }
+}
+
+void prbs_check(prbs_checker_t* checker, const uint8_t* data, const int len) {
+    for (int i = 0; i < len; ++i) {
+        for (int b = 7; b >= 0; --b) {
+            check_bit(checker, (data[i] >> b) & 1);
+        }
+    }
+}
+
+int prbs_order_from_value(const int value) {
+    switch (value) {
+        case 7: return PRBS_7;
+        case 15: return PRBS_15;
+        case 31: return PRBS_31;
+        default: return -1;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef PRBS_H
+#define PRBS_H
+
+#include <stdint.h>
+
+// Псевдослучайные последовательности по ITU-T O.150: x^7+x^6+1, x^15+x^14+1, x^31+x^28+1
+typedef enum {
+    PRBS_7 = 7,
+    PRBS_15 = 15,
+    PRBS_31 = 31,
+} prbs_order_t;
+
+typedef struct {
+    prbs_order_t order;
+    uint32_t state;
+} prbs_gen_t;
+
+// Ошибки, разделённые меньшим числом верных бит, относятся к одной пачке
+#define PRBS_BURST_GAP 16
+// Окно контроля синхронизации: больше PRBS_LOSS_ERRORS ошибок в окне - синхронизация потеряна
+#define PRBS_LOSS_WINDOW 128
+#define PRBS_LOSS_ERRORS 32
+// Повторная синхронизация со сдвигом не больше стольких бит считается проскальзыванием, а не потерей
+#define PRBS_MAX_SLIP 8
+
+typedef struct {
+    uint64_t bits;       // Проверено бит в синхронизме
+    uint64_t errors;
+    uint32_t bursts;     // Пачки ошибок
+    uint32_t max_burst;  // Длина самой длинной пачки в битах
+    uint32_t slips;      // Потеря и восстановление синхронизма со сдвигом в несколько бит
+    uint32_t sync_losses;
+} prbs_stats_t;
+
+typedef struct {
+    prbs_gen_t local;     // Опорный генератор после захвата синхронизма
+    int locked;
+    uint32_t shift;       // Последние принятые биты (поиск синхронизма)
+    int filled;           // Сколько бит набрано в shift
+    int matches;          // Верных предсказаний подряд при поиске
+    int window_bits;
+    int window_errors;
+    int gap;              // Верных бит после последней ошибки
+    uint32_t burst_length;
+    // Опорная последовательность на время поиска: по ней определяется проскальзывание
+    prbs_gen_t reference;
+    int reference_valid;
+    uint32_t history[PRBS_MAX_SLIP];
+    prbs_stats_t stats;
+} prbs_checker_t;
+
+void prbs_init(prbs_gen_t* gen, prbs_order_t order);
+
+int prbs_next_bit(prbs_gen_t* gen);
+
+// Заполнение буфера байтами последовательности (старшие биты первыми)
+void prbs_fill(prbs_gen_t* gen, uint8_t* data, int len);
+
+void prbs_checker_init(prbs_checker_t* checker, prbs_order_t order);
+
+// Проверка принятых байтов: самосинхронизация, подсчёт ошибок, пачек и проскальзываний
+void prbs_check(prbs_checker_t* checker, const uint8_t* data, int len);
+
+// Разбор порядка команды "#PRBS TX|RX <7|15|31>", -1 при неизвестном
+int prbs_order_from_value(int value);
+
+#endif //PRBS_H
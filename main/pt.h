@@ -0,0 +1,65 @@
+#ifndef PT_H
+#define PT_H
+
+#include <stdint.h>
+
+// Протопотоки: функция-сопрограмма без собственного стека. Точка продолжения - номер строки в switch,
+// поэтому локальные переменные между шагами не сохраняются - состояние хранится в структуре потока.
+// Переход на метку продолжения сверху - намеренный, о нём молчит -Wimplicit-fallthrough.
+// Внутри потока нельзя использовать switch, охватывающий точки ожидания, и ставить две точки ожидания в одну строку
+
+#define PT_WAITING 0
+#define PT_YIELDED 1
+#define PT_EXITED 2
+#define PT_ENDED 3
+
+typedef struct {
+    uint16_t lc;
+} pt_t;
+
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+#define PT_BEGIN(pt)         \
+    {                        \
+        char pt_yielded = 1; \
+        (void)pt_yielded;    \
+        switch ((pt)->lc) {  \
+            case 0:
+
+#define PT_END(pt)       \
+        }                \
+        (pt)->lc = 0;    \
+        return PT_ENDED; \
+    }
+
+// Ожидание условия: пока оно ложно, каждый шаг сразу возвращается
+#define PT_WAIT_UNTIL(pt, condition)  \
+    do {                              \
+        (pt)->lc = __LINE__;          \
+        __attribute__((fallthrough)); \
+        case __LINE__:                \
+        if (!(condition)) {           \
+            return PT_WAITING;        \
+        }                             \
+    } while (0)
+
+// Возврат управления с продолжением со следующего шага
+#define PT_YIELD(pt)                  \
+    do {                              \
+        pt_yielded = 0;               \
+        (pt)->lc = __LINE__;          \
+        __attribute__((fallthrough)); \
+        case __LINE__:                \
+        if (pt_yielded == 0) {        \
+            return PT_YIELDED;        \
+        }                             \
+    } while (0)
+
+// Завершение потока, следующий шаг начнёт его заново
+#define PT_EXIT(pt)       \
+    do {                  \
+        PT_INIT(pt);      \
+        return PT_EXITED; \
+    } while (0)
+
+#endif //PT_H
@@ -0,0 +1,113 @@
+#include "ratectl.h"
+
+#include <string.h>
+
+#include "rates.h"
+
+#define RATECTL_LADDER_ENTRY(f) (f),
+
+static const int ladder[] = {
+    STANDARD_RATES(RATECTL_LADDER_ENTRY)
+};
+
+#define LADDER_SIZE (int)(sizeof(ladder) / sizeof(ladder[0]))
+
+void ratectl_init(ratectl_t* ctl, const int base_frequency, const int max_frequency, const uint32_t target_ppm) {
+    memset(ctl, 0, sizeof(*ctl));
+    ctl->rates[ctl->levels++] = base_frequency;
+    for (int i = 0; i < LADDER_SIZE && ctl->levels < RATECTL_MAX_LEVELS; ++i) {
+        if (ladder[i] > base_frequency && ladder[i] <= max_frequency) {
+            ctl->rates[ctl->levels++] = ladder[i];
+        }
+    }
+    ctl->failed_level = -1;
+    ctl->probe_frames = RATECTL_PROBE_FRAMES;
+    ctl->target_ppm = target_ppm;
+}
+
+static void change_level(ratectl_t* ctl, const int level) {
+    ctl->level = level;
+    ctl->good_frames = 0;
+    ctl->bad_frames = 0;
+    ctl->timeouts = 0;
+    ctl->errors = 0;
+}
+
+// Проба не выдержана: назад на ступень, повторная проба этой ступени - вдвое позже
+static void probe_failed(ratectl_t* ctl) {
+    if (ctl->failed_level == ctl->level && ctl->probe_frames < RATECTL_MAX_PROBE_FRAMES) {
+        ctl->probe_frames *= 2;
+    }
+    ctl->failed_level = ctl->level;
+    ctl->probing = 0;
+    change_level(ctl, ctl->level - 1);
+}
+
+int ratectl_observe(ratectl_t* ctl, const int valid, const int pairs, const int invalid) {
+    const int noisy = pairs > 0 && (uint64_t)invalid * 1000000 > (uint64_t)ctl->target_ppm * pairs;
+    if (valid && !noisy) {
+        ++ctl->good_frames;
+        ctl->bad_frames = 0;
+        return 0;
+    }
+    ctl->good_frames = 0;
+    if (valid) {
+        // Кадр цел, но ошибок больше допустимого - ступень снизится при подтверждении
+        ++ctl->errors;
+        return 0;
+    }
+    if (ctl->probing) {
+        probe_failed(ctl);
+        return 1;
+    }
+    ++ctl->errors;
+    if (++ctl->bad_frames >= RATECTL_FALLBACK_FRAMES && ctl->level != 0) {
+        change_level(ctl, 0);
+        return 1;
+    }
+    return 0;
+}
+
+int ratectl_advise(ratectl_t* ctl) {
+    if (ctl->errors > 0) {
+        ctl->errors = 0;
+        return ctl->level > 0 ? ctl->level - 1 : 0;
+    }
+    const int next = ctl->level + 1;
+    const int required = next == ctl->failed_level ? ctl->probe_frames : RATECTL_PROBE_FRAMES;
+    if (ctl->good_frames >= required && next < ctl->levels) {
+        return next;
+    }
+    return ctl->level;
+}
+
+int ratectl_timeout(ratectl_t* ctl) {
+    if (ctl->probing) {
+        probe_failed(ctl);
+        return 1;
+    }
+    if (++ctl->timeouts >= RATECTL_FALLBACK_TIMEOUTS && ctl->level != 0) {
+        change_level(ctl, 0);
+        return 1;
+    }
+    return 0;
+}
+
+void ratectl_set_level(ratectl_t* ctl, const int level) {
+    const int new_level = level >= 0 && level < ctl->levels ? level : 0;
+    if (new_level == ctl->level) {
+        if (ctl->probing && ctl->failed_level == new_level) {
+            ctl->failed_level = -1;
+            ctl->probe_frames = RATECTL_PROBE_FRAMES;
+        }
+        ctl->probing = 0;
+        ctl->timeouts = 0;
+        return;
+    }
+    ctl->probing = new_level > ctl->level;
+    change_level(ctl, new_level);
+}
+
+int ratectl_frequency(const ratectl_t* ctl) {
+    return ctl->rates[ctl->level];
+}
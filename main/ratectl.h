@@ -0,0 +1,55 @@
+#ifndef RATECTL_H
+#define RATECTL_H
+
+#include <stdint.h>
+
+// Наибольшее число ступеней скорости (все стандартные скорости)
+#define RATECTL_MAX_LEVELS 16
+// Допустимая по умолчанию доля неразличимых манчестерских пар (на миллион пар)
+#define RATECTL_DEFAULT_TARGET_PPM 1000
+// Чистых кадров подряд до первой пробы следующей скорости, и предел роста этого числа после неудачных проб
+#define RATECTL_PROBE_FRAMES 4
+#define RATECTL_MAX_PROBE_FRAMES 64
+// Непринятых кадров подряд (приёмник) и таймаутов подряд (отправитель), после которых связь считается
+// потерянной и обе стороны возвращаются на базовую скорость
+#define RATECTL_FALLBACK_FRAMES 12
+#define RATECTL_FALLBACK_TIMEOUTS 3
+
+// Адаптация битовой скорости по ошибкам приёма: ступени - стандартные скорости от базовой до максимальной
+// Кадры учитываются по мере приёма, решение о смене ступени принимается при подтверждении,
+// чтобы обе стороны переходили на новую скорость одновременно
+typedef struct {
+    int rates[RATECTL_MAX_LEVELS];
+    int levels;
+    int level;          // Текущая ступень, 0 - базовая скорость
+    int good_frames;    // Чистых кадров подряд на текущей ступени
+    int bad_frames;     // Непринятых кадров подряд
+    int timeouts;       // Таймаутов подряд у отправителя
+    int errors;         // Испорченных кадров с последнего решения
+    int probing;        // Текущая ступень - проба, первая же ошибка возвращает назад
+    int failed_level;   // Последняя ступень, не выдержавшая пробы, -1 - такой нет
+    int probe_frames;   // Сколько чистых кадров нужно для повторной пробы failed_level
+    uint32_t target_ppm;
+} ratectl_t;
+
+void ratectl_init(ratectl_t* ctl, int base_frequency, int max_frequency, uint32_t target_ppm);
+
+// Приёмник: учёт одного кадра, valid - кадр принят целым, pairs и invalid - всего пар и неразличимых пар в нём.
+// Непринятый кадр на пробной ступени сразу возвращает на предыдущую, долгая потеря кадров - на базовую
+// Возвращает 1, если ступень сменилась
+int ratectl_observe(ratectl_t* ctl, int valid, int pairs, int invalid);
+
+// Приёмник: решение при подтверждении - ступень, которую предложить отправителю
+int ratectl_advise(ratectl_t* ctl);
+
+// Отправитель: подтверждение не пришло. Симметрично приёмнику: с пробной ступени - назад сразу,
+// после RATECTL_FALLBACK_TIMEOUTS таймаутов подряд - на базовую. Возвращает 1, если ступень сменилась
+int ratectl_timeout(ratectl_t* ctl);
+
+// Переход на ступень из подтверждения (номер вне диапазона - базовая скорость).
+// Повышение ступени делает её пробной, подтверждение на той же ступени - рабочей
+void ratectl_set_level(ratectl_t* ctl, int level);
+
+int ratectl_frequency(const ratectl_t* ctl);
+
+#endif //RATECTL_H
@@ -0,0 +1,98 @@
+#include "rates.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define RATE_TIMING_ENTRY(f) \
+    {(f), RATE_HALF_PERIOD_US(f), RATE_MAX_DELAY_PERIOD_US(f), RATE_MAX_STABLE_PERIOD_US(f)},
+
+// Все деления выполняются при компиляции
+static const rate_timing_t rate_timings[] = {
+    STANDARD_RATES(RATE_TIMING_ENTRY)
+};
+
+#define RATE_TIMINGS_COUNT (int)(sizeof(rate_timings) / sizeof(rate_timings[0]))
+
+rate_timing_t get_rate_timing(const int frequency) {
+    for (int i = 0; i < RATE_TIMINGS_COUNT; ++i) {
+        if (rate_timings[i].frequency == frequency) {
+            return rate_timings[i];
+        }
+    }
+    const rate_timing_t timing = {
+        frequency,
+        RATE_HALF_PERIOD_US(frequency),
+        RATE_MAX_DELAY_PERIOD_US(frequency),
+        RATE_MAX_STABLE_PERIOD_US(frequency),
+    };
+    return timing;
+}
+
+int is_standard_rate(const int frequency) {
+    for (int i = 0; i < RATE_TIMINGS_COUNT; ++i) {
+        if (rate_timings[i].frequency == frequency) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void rate_marker_start(rate_marker_t* marker, const int threshold, const int first_raw) {
+    marker->threshold = threshold;
+    marker->level = first_raw >= threshold;
+    marker->edge_raw = first_raw;
+    marker->edges = 0;
+    marker->samples = 0;
+    marker->max_step_us = 0;
+}
+
+int rate_marker_feed(rate_marker_t* marker, const int64_t now_us, const int raw) {
+    if (marker->edges >= RATE_MARKER_EDGES) {
+        return 1;
+    }
+    if (marker->samples++ > 0 && now_us - marker->last_us > marker->max_step_us) {
+        marker->max_step_us = (int)(now_us - marker->last_us);
+    }
+    marker->last_us = now_us;
+    const int level = raw >= marker->threshold;
+    if (level != marker->level && abs(raw - marker->edge_raw) > RATE_MARKER_MIN_STEP) {
+        marker->level = level;
+        marker->edge_raw = raw;
+        marker->edge_us[marker->edges++] = now_us;
+    }
+    return marker->edges >= RATE_MARKER_EDGES;
+}
+
+int rate_marker_estimate(const rate_marker_t* marker, const int min_frequency, const int max_frequency) {
+    if (marker->edges < RATE_MARKER_EDGES) {
+        return 0;
+    }
+    // Полупериод по всему размаху метки: ошибка дискретизации делится на 14 полупериодов
+    const int64_t span_us = marker->edge_us[RATE_MARKER_EDGES - 1] - marker->edge_us[0];
+    if (span_us <= 0) {
+        return 0;
+    }
+    const double half_period_us = (double)span_us / RATE_MARKER_SPAN_HALF_PERIODS;
+    // Форма метки: один длинный интервал на своём месте, остальные короткие, каждый в пределах полупериода
+    // и шага отсчётов от ожидаемого. Выброс внутри полубита даёт интервалы короче и отбрасывает метку
+    const double tolerance_us = half_period_us / 2 + marker->max_step_us;
+    for (int i = 0; i < RATE_MARKER_EDGES - 1; ++i) {
+        const int64_t interval = marker->edge_us[i + 1] - marker->edge_us[i];
+        const int expected = i == RATE_MARKER_LONG_INTERVAL ? 2 : 1;
+        if (fabs(interval - expected * half_period_us) > tolerance_us) {
+            return 0;
+        }
+    }
+    const double measured = 500000.0 / half_period_us;
+    if (measured < min_frequency * (100 - RATE_SNAP_PCT) / 100.0 || measured > max_frequency * (100 + RATE_SNAP_PCT) / 100.0) {
+        return 0;
+    }
+    for (int i = 0; i < RATE_TIMINGS_COUNT; ++i) {
+        const int rate = rate_timings[i].frequency;
+        if (measured >= rate * (100 - RATE_SNAP_PCT) / 100.0 && measured <= rate * (100 + RATE_SNAP_PCT) / 100.0) {
+            return rate;
+        }
+    }
+    const int rate = (int)(measured + 0.5);
+    return rate < min_frequency ? min_frequency : rate > max_frequency ? max_frequency : rate;
+}
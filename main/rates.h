@@ -0,0 +1,67 @@
+#ifndef RATES_H
+#define RATES_H
+
+#include <stdint.h>
+
+// Стандартные битовые скорости (Гц): для них собраны специализированные ядра передачи
+// с постоянными задержками и посчитана таблица таймингов приёма. Остальные скорости идут общим путём
+#define STANDARD_RATES(X) \
+    X(100) X(200) X(500) X(1000) X(2000) X(5000) \
+    X(10000) X(20000) X(50000) X(100000) X(200000) X(500000)
+
+// Полупериод бита в мкс, не меньше 1
+#define RATE_HALF_PERIOD_US(f) (500000 / (f) > 0 ? 500000 / (f) : 1)
+// Тишина, после которой кадр считается завершённым (10 полупериодов)
+#define RATE_MAX_DELAY_PERIOD_US(f) (5000000 / (f))
+// Стабильный участок длиннее полутора полупериодов считается двумя полупериодами
+#define RATE_MAX_STABLE_PERIOD_US(f) (750000 / (f))
+
+typedef struct {
+    int frequency;
+    int half_period_us;
+    int max_delay_period_us;
+    int max_stable_period_us;
+} rate_timing_t;
+
+// Тайминги скорости: из таблицы для стандартных скоростей, иначе расчёт на месте
+rate_timing_t get_rate_timing(int frequency);
+
+int is_standard_rate(int frequency);
+
+// Метка скорости: байт на скорости данных сразу после синхропоследовательности.
+// 0xF0 в манчестерском коде после паузы даёт 14 фронтов: первый через полупериод от начала,
+// последний через 15 полупериодов, между 7-м и 8-м фронтом - полный период, между остальными - полупериод
+#define RATE_MARKER 0xF0
+#define RATE_MARKER_BITS 8
+#define RATE_MARKER_EDGES 14
+#define RATE_MARKER_SPAN_HALF_PERIODS 14
+#define RATE_MARKER_LONG_INTERVAL 6
+// Порог фронта по изменению отсчёта, как в цикле приёма
+#define RATE_MARKER_MIN_STEP 300
+// Оценка в пределах стольких процентов от стандартной скорости принимается за неё
+#define RATE_SNAP_PCT 10
+// Самая низкая скорость, которую ищет автоопределение: от неё зависит, сколько приёмник ждёт метку
+#define RATE_AUTO_MIN_FREQ 10
+
+typedef struct {
+    int threshold;
+    int level;      // Уровень после последнего фронта (1 - выше порога)
+    int edge_raw;   // Отсчёт на последнем фронте
+    int edges;
+    int64_t edge_us[RATE_MARKER_EDGES];
+    int samples;
+    int64_t last_us;
+    int max_step_us; // Наибольший шаг между отсчётами: на столько может опоздать обнаружение фронта
+} rate_marker_t;
+
+// Начало метки: линия в паузе после синхропоследовательности, first_raw - отсчёт в ней
+void rate_marker_start(rate_marker_t* marker, int threshold, int first_raw);
+
+// Очередной отсчёт. Возвращает 1, когда найдены все фронты метки
+int rate_marker_feed(rate_marker_t* marker, int64_t now_us, int raw);
+
+// Скорость по найденным фронтам: ближайшая стандартная, если отличается от неё меньше чем на RATE_SNAP_PCT,
+// иначе измеренная. 0 - фронты не похожи на метку или скорость вне min..max
+int rate_marker_estimate(const rate_marker_t* marker, int min_frequency, int max_frequency);
+
+#endif //RATES_H
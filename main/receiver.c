@@ -11,61 +11,79 @@
 #include <driver/uart.h>
 #include <rom/ets_sys.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include "bufpool.h"
+#include "console.h"
+#include "eq.h"
+#include "fec.h"
+#include "integrate.h"
+#include "lzss.h"
+#include "manchester.h"
+#include "ofdm.h"
+#include "perf.h"
+#include "ppm.h"
+#include "rates.h"
+#include "rxfsm.h"
+#include "sdkconfig.h"
 #include "synchronizer.h"
 
-static char console_buffer[1024];
-
 void init_receiver() {
     init_synchronizer();
-    for (int i = 0; i < 1024; ++i) {
-        console_buffer[i] = 0;
-    }
-}
-
-// Используем отношение среднего значение буфера сканирования по отношению к порогу: выше единицы => выше порога
-char decode_manchester_pair(const double first, const double second) {
-    if (first < 1 && second >= 1) {
-        return 1;
-    }
-    if (first >= 1 && second < 1) {
-        return 0;
-    }
-    if (fabs(first - second) < 0.02) {
-        return 2;
-    }
-    return second > first ? 1 : 0;
 }
 
 #define CYCLE_BUFFER_SIZE 1
 
-#define MAX_BYTES 1024
 #define MAX_HALF_BITS 16384
+// Время ожидания синхропоследовательности в режимах чтения
+#define RECEIVE_SYNC_TIMEOUT_US 2000000
 
-void print_double_arraqy(double arr[], const int size) {
+// Отладочный вывод массивов: строка собирается в блоке пула и сразу возвращается
+void print_double_arraqy(const float arr[], const int size) {
+    bufpool_frame_t* line = bufpool_acquire();
+    if (!line) {
+        return;
+    }
+    char* text = (char*)line->data;
     int offset = 0;
-    for (int i = 0; i < size; i++) {
-        offset += snprintf(console_buffer + offset, sizeof(console_buffer) - offset, "%.2f ", arr[i]);
+    for (int i = 0; i < size && offset < BUFPOOL_BLOCK_SIZE - 3; i++) {
+        offset += snprintf(text + offset, BUFPOOL_BLOCK_SIZE - 3 - offset, "%.2f ", arr[i]);
+    }
+    if (offset > BUFPOOL_BLOCK_SIZE - 3) {
+        offset = BUFPOOL_BLOCK_SIZE - 3;
     }
-    console_buffer[offset] = '\r'; // Перевод строки с помощью \r\n
-    console_buffer[offset + 1] = '\n';
-    console_buffer[offset + 2] = '\0'; // Завершающий нулевой символ
+    text[offset] = '\r'; // Перевод строки с помощью \r\n
+    text[offset + 1] = '\n';
+    text[offset + 2] = '\0'; // Завершающий нулевой символ
 
-    uart_write_bytes(UART_NUM_0, console_buffer, strlen(console_buffer));
+    console_write(UART_NUM_0, text, strlen(text));
+    bufpool_release(line);
 }
 
-void print_int_arraqy(int64_t arr[], const int size) {
+void print_int_arraqy(const int64_t arr[], const int size) {
+    bufpool_frame_t* line = bufpool_acquire();
+    if (!line) {
+        return;
+    }
+    char* text = (char*)line->data;
     int offset = 0;
-    for (int i = 0; i < size; i++) {
-        offset += snprintf(console_buffer + offset, sizeof(console_buffer) - offset, "%lld ", arr[i]);
+    for (int i = 0; i < size && offset < BUFPOOL_BLOCK_SIZE - 3; i++) {
+        offset += snprintf(text + offset, BUFPOOL_BLOCK_SIZE - 3 - offset, "%lld ", arr[i]);
+    }
+    if (offset > BUFPOOL_BLOCK_SIZE - 3) {
+        offset = BUFPOOL_BLOCK_SIZE - 3;
     }
-    console_buffer[offset] = '\r'; // Перевод строки с помощью \r\n
-    console_buffer[offset + 1] = '\n';
-    console_buffer[offset + 2] = '\0'; // Завершающий нулевой символ
+    text[offset] = '\r'; // Перевод строки с помощью \r\n
+    text[offset + 1] = '\n';
+    text[offset + 2] = '\0'; // Завершающий нулевой символ
 
-    uart_write_bytes(UART_NUM_0, console_buffer, strlen(console_buffer));
+    console_write(UART_NUM_0, text, strlen(text));
+    bufpool_release(line);
 }
 
-int read_avg_samples(const int samples, const int delay_us) {
+LIFI_HOT int read_avg_samples(const int samples, const int delay_us) {
     int sum = 0;
     for (int i = 0; i < samples; ++i) {
         sum += adc1_get_raw(ADC1_CHANNEL_4);
@@ -76,34 +94,308 @@ int read_avg_samples(const int samples, const int delay_us) {
     return sum / samples;
 }
 
+#define MAX_TIME_DIFFS 256
+#define EQ_TRAIN_SAMPLES 256
+
+// Рабочая память приёма. Режимы приёма не работают одновременно, поэтому делят одну область.
+// Полубиты хранятся во float: отношению уровня к порогу точности double не нужно, а буфер вдвое меньше
+typedef union {
+    struct {
+        float half_bits[MAX_HALF_BITS];
+        int64_t time_diffs[MAX_TIME_DIFFS];
+        int8_t soft_bits[FEC_CODED_SIZE(FEC_MAX_DATA) * 8];
+        int eq_samples[EQ_TRAIN_SAMPLES];
+    } manchester;
+    struct {
+        int64_t pulses[PPM_MAX_SYMBOLS + 1];
+        uint8_t symbols[PPM_MAX_SYMBOLS];
+    } ppm;
+    int16_t ofdm_samples[OFDM_MAX_SAMPLES];
+} rx_workspace_t;
+
+static rx_workspace_t rx_workspace;
+static float* const half_bits_buffer = rx_workspace.manchester.half_bits;
+static int64_t* const time_diffs = rx_workspace.manchester.time_diffs;
+
 static int read_buffer[CYCLE_BUFFER_SIZE] = {0};
-static double half_bits_buffer[MAX_HALF_BITS] = {0};
-static unsigned char bytes_buffer[MAX_BYTES] = {0};
-static int64_t time_diffs[256] = {0};
-void process_manchester_receive(
-    const int threshold, const int baseFrequency,
-    const uart_port_t uart_port
-) {
-    memset(read_buffer, 0, sizeof(read_buffer));
-    memset(half_bits_buffer, 0, sizeof(half_bits_buffer));
-    memset(bytes_buffer, 0, sizeof(bytes_buffer));
-    memset(time_diffs, 0, sizeof(time_diffs));
-    if (!await_end_sync(threshold)) {
+static int diff_index = 0;
+
+// Принятые байты выводятся из блока пула, в который их записал декодер
+static bufpool_frame_t* acquire_output_buffer(void) {
+    bufpool_frame_t* frame = bufpool_acquire();
+    if (!frame) {
+        console_write(UART_NUM_0, "No free frame buffer\n\0", 22);
+    }
+    return frame;
+}
+
+size_t receiver_workspace_size(void) {
+    return sizeof(rx_workspace);
+}
+
+// Режим интегрирования (согласованный фильтр для прямоугольных полубитов):
+// вместо одного отсчёта на фронте полубит оценивается средним всех отсчётов своего окна
+static int integrate_mode = 0;
+
+void set_receiver_integrate(const int enabled) {
+    integrate_mode = enabled != 0;
+}
+
+int get_receiver_integrate(void) {
+    return integrate_mode;
+}
+
+// Эквалайзер перед порогом: обучается на спаде в паузе после синхропоследовательности каждого кадра
+static int equaliser_mode = 0;
+static eq_t equaliser;
+
+// Пока работает задача непрерывного приёма, эквалайзер сбрасывает она сама между кадрами
+static volatile bool equaliser_reset_pending = false;
+
+int get_receiver_equaliser(void) {
+    return equaliser_mode;
+}
+
+const eq_t* receiver_equaliser_state(void) {
+    return &equaliser;
+}
+
+// Отсчёты снимаются примерно с тем же шагом, что и в цикле приёма, чтобы полюс совпадал с полюсом при приёме данных
+static void train_equaliser(void) {
+    int* samples = rx_workspace.manchester.eq_samples;
+    for (int i = 0; i < EQ_TRAIN_SAMPLES; ++i) {
+        rtc_wdt_feed();
+        samples[i] = adc1_get_raw(ADC1_CHANNEL_4);
+        ets_delay_us(10);
+    }
+    eq_train(&equaliser, samples, EQ_TRAIN_SAMPLES);
+    eq_start(&equaliser, samples[EQ_TRAIN_SAMPLES - 1]);
+}
+
+static LIFI_HOT void store_half_bit(const double value, int* half_bits) {
+    if (*half_bits < MAX_HALF_BITS) {
+        half_bits_buffer[(*half_bits)++] = value;
+    }
+}
+
+// Определение скорости кадра по метке вместо заданной командой
+static int autorate_mode = 0;
+static int autorate_max_frequency = 0;
+static int last_frame_rate = 0;
+
+void set_receiver_autorate(const int enabled, const int max_frequency) {
+    autorate_mode = enabled != 0;
+    autorate_max_frequency = max_frequency;
+}
+
+int get_receiver_autorate(void) {
+    return autorate_mode;
+}
+
+int receiver_last_frame_rate(void) {
+    return last_frame_rate;
+}
+
+// Непрерывный приём: автомат rxfsm в отдельной задаче не выходит из цикла отсчётов между кадрами,
+// готовые кадры уходят через очередь блоками пула, вывод в UART - дело основного цикла
+#define STREAM_TASK_STACK 4096
+#define STREAM_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#if CONFIG_FREERTOS_UNICORE
+#define STREAM_TASK_CORE 0
+#else
+// Основной цикл и передача остаются на первом ядре
+#define STREAM_TASK_CORE 1
+#endif
+// Опрос флага включения, пока задача остановлена
+#define STREAM_IDLE_POLL_MS 10
+
+static rxfsm_t stream_fsm;
+static QueueHandle_t stream_queue = NULL;
+static TaskHandle_t stream_task = NULL;
+static portMUX_TYPE stream_lock = portMUX_INITIALIZER_UNLOCKED;
+// Настройки для задачи, номер меняется с каждой новой настройкой
+static rxfsm_config_t stream_config;
+static volatile uint32_t stream_generation = 0;
+static volatile bool stream_enabled = false;
+// Задача в цикле отсчётов и читает АЦП
+static volatile bool stream_active = false;
+static volatile uint32_t stream_dropped = 0;
+
+void set_receiver_equaliser(const int enabled) {
+    equaliser_mode = enabled != 0;
+    // Флаги задачи меняются только здесь, в основном цикле, и в самой задаче после остановки: проверка не гоняется
+    if (stream_enabled || stream_active) {
+        equaliser_reset_pending = true;
+    } else {
+        eq_reset(&equaliser);
+    }
+}
+
+static void stream_task_main(void* arg) {
+    uint32_t applied = 0;
+    bufpool_frame_t* block = NULL;
+    while (true) {
+        if (!stream_enabled) {
+            bufpool_release(block);
+            block = NULL;
+            if (equaliser_reset_pending) {
+                eq_reset(&equaliser);
+                equaliser_reset_pending = false;
+            }
+            stream_active = false;
+            vTaskDelay(pdMS_TO_TICKS(STREAM_IDLE_POLL_MS));
+            continue;
+        }
+        stream_active = true;
+        if (stream_generation != applied) {
+            rxfsm_config_t config;
+            taskENTER_CRITICAL(&stream_lock);
+            config = stream_config;
+            applied = stream_generation;
+            taskEXIT_CRITICAL(&stream_lock);
+            rxfsm_init(&stream_fsm, &config);
+            if (block) {
+                rxfsm_set_output(&stream_fsm, block->data, BUFPOOL_BLOCK_SIZE - 2);
+            }
+        }
+        if (equaliser_reset_pending && stream_fsm.state == RXFSM_HUNT) {
+            eq_reset(&equaliser);
+            equaliser_reset_pending = false;
+        }
+        // Блок под следующий кадр берётся вне данных кадра; без блока кадр принимается, но отбрасывается
+        if (!block && stream_fsm.state != RXFSM_DATA) {
+            block = bufpool_acquire();
+            if (block) {
+                rxfsm_set_output(&stream_fsm, block->data, BUFPOOL_BLOCK_SIZE - 2);
+            }
+        }
+
+        rtc_wdt_feed();
+        const int64_t now = esp_timer_get_time();
+        const int len = rxfsm_feed(&stream_fsm, now, adc1_get_raw(ADC1_CHANNEL_4));
+        if (len > 0 && block) {
+            block->len = len;
+            if (xQueueSend(stream_queue, &block, 0) == pdTRUE) {
+                block = NULL;
+            } else {
+                ++stream_dropped;
+            }
+        } else if (len > 0) {
+            ++stream_dropped;
+        }
+        if (len >= 0 && block) {
+            rxfsm_set_output(&stream_fsm, block->data, BUFPOOL_BLOCK_SIZE - 2);
+        }
+
+        // Линия в покое: тик (10 мс при CONFIG_FREERTOS_HZ=100) короче полубита синхропоследовательности,
+        // начало следующего кадра не теряется, а задачи с низшим приоритетом на этом ядре получают время
+        const int delay_us = rxfsm_sample_delay_us(&stream_fsm);
+        if (rxfsm_idle(&stream_fsm, now)) {
+            vTaskDelay(1);
+        } else if (delay_us > 0) {
+            ets_delay_us(delay_us);
+        }
+    }
+}
+
+void receiver_stream_start(const int threshold, const int baseFrequency) {
+    if (!stream_task) {
+        stream_queue = xQueueCreate(BUFPOOL_BLOCKS, sizeof(bufpool_frame_t*));
+        xTaskCreatePinnedToCore(
+            stream_task_main, "lifi_rx", STREAM_TASK_STACK, NULL, STREAM_TASK_PRIORITY, &stream_task, STREAM_TASK_CORE
+        );
+    }
+    const rxfsm_config_t config = {
+        .threshold = threshold,
+        .frequency = baseFrequency,
+        .autorate_max = autorate_mode ? autorate_max_frequency : 0,
+        .integrate = integrate_mode,
+        .eq = equaliser_mode ? &equaliser : NULL,
+    };
+    taskENTER_CRITICAL(&stream_lock);
+    // Автомат начинает заново после остановки и при смене любой настройки
+    if (!stream_enabled || config.threshold != stream_config.threshold ||
+        config.frequency != stream_config.frequency || config.autorate_max != stream_config.autorate_max ||
+        config.integrate != stream_config.integrate || config.eq != stream_config.eq) {
+        stream_config = config;
+        ++stream_generation;
+    }
+    stream_enabled = true;
+    taskEXIT_CRITICAL(&stream_lock);
+}
+
+void receiver_stream_stop(void) {
+    if (!stream_task) {
         return;
     }
-    int read_index = 0;
+    stream_enabled = false;
+    while (stream_active) {
+        vTaskDelay(1);
+    }
+    // Непрочитанные кадры остановленного приёма не выводятся
+    bufpool_frame_t* frame;
+    while (xQueueReceive(stream_queue, &frame, 0) == pdTRUE) {
+        bufpool_release(frame);
+    }
+}
+
+bufpool_frame_t* receiver_stream_take(void) {
+    bufpool_frame_t* frame;
+    if (!stream_queue || xQueueReceive(stream_queue, &frame, 0) != pdTRUE) {
+        return NULL;
+    }
+    return frame;
+}
+
+void receiver_stream_stats(rxfsm_stats_t* stats, uint32_t* dropped) {
+    *stats = stream_fsm.stats;
+    *dropped = stream_dropped;
+}
+
+// Ожидание синхронизации и приём полубитов одного кадра в half_bits_buffer
+// Возвращает число принятых полубитов, -1 если синхропоследовательность или метка скорости не найдены
+static LIFI_HOT int receive_half_bits(const int threshold, int baseFrequency, const int64_t sync_timeout_us) {
+    memset(read_buffer, 0, sizeof(read_buffer));
+    memset(half_bits_buffer, 0, MAX_HALF_BITS * sizeof(half_bits_buffer[0]));
+    memset(time_diffs, 0, MAX_TIME_DIFFS * sizeof(time_diffs[0]));
+    diff_index = 0;
+    if (!await_end_sync(threshold, sync_timeout_us)) {
+        return -1;
+    }
+    if (equaliser_mode) {
+        train_equaliser();
+    }
+
+    // Метка скорости: её фронты ищутся в пределах паузы и восьми бит на самой низкой допустимой скорости
+    rate_marker_t marker;
+    const int slowest = autorate_mode ? RATE_AUTO_MIN_FREQ : baseFrequency;
+    const int64_t marker_timeout_us = SYNC_TAIL_US + (int64_t)(RATE_MARKER_BITS + 1) * 1000000 / slowest;
+    if (!await_rate_marker(threshold, marker_timeout_us, &marker, equaliser_mode ? &equaliser : NULL)) {
+        return -1;
+    }
+    if (autorate_mode) {
+        baseFrequency = rate_marker_estimate(&marker, RATE_AUTO_MIN_FREQ, autorate_max_frequency);
+        if (baseFrequency == 0) {
+            return -1;
+        }
+    }
+    last_frame_rate = baseFrequency;
 
     // Буфер для хранения принятых битов
     int half_bits = 0;
 
-    int last_raw = -1;
-    double last_value = -1;
-    int64_t stable_start = esp_timer_get_time();
+    // Цикл продолжается с последнего фронта метки (спад): первым сохранится её завершающий низкий полубит
+    int last_raw = marker.edge_raw;
+    double last_value = marker.edge_raw * 1.0 / threshold;
+    int64_t stable_start = marker.edge_us[RATE_MARKER_EDGES - 1];
 
-    const int64_t max_delay_period_us = 5000000 / (baseFrequency);
-    const int64_t half_period_target_us = 500000 / baseFrequency;
-    const int64_t max_stable_period_us_d = 750000 / (baseFrequency);
-    int diff_index = 0;
+    // Для стандартных скоростей тайминги берутся из таблицы без деления
+    const rate_timing_t timing = get_rate_timing(baseFrequency);
+    const int64_t max_delay_period_us = timing.max_delay_period_us;
+    const int64_t max_stable_period_us_d = timing.max_stable_period_us;
+    // Окна интегратора идут от последнего фронта метки
+    static integrate_t integrator;
+    integrate_start(&integrator, timing.half_period_us, stable_start, last_value >= 1);
 
     while (true) {
         const int64_t now = esp_timer_get_time();
@@ -115,7 +407,8 @@ void process_manchester_receive(
         // read_index = (read_index + 1) % CYCLE_BUFFER_SIZE;
         //
         // const int median = calc_median(read_buffer, CYCLE_BUFFER_SIZE);
-        const int median = adc1_get_raw(ADC1_CHANNEL_4);
+        const int raw = adc1_get_raw(ADC1_CHANNEL_4);
+        const int median = equaliser_mode ? eq_apply(&equaliser, raw) : raw;
         const int64_t diff = (now - stable_start);
 
         const double binary = median * 1.0 / threshold;
@@ -123,16 +416,32 @@ void process_manchester_receive(
             abs(median - last_raw) > 300 &&
             (binary >= 1) != (last_value >= 1)
         ) {
-            if (last_value != -1) {
-                for (int i = 0; i < (diff > max_stable_period_us_d ? 2 : 1); ++i) {
-                    half_bits_buffer[half_bits++] = last_value;
+            int accepted = 1;
+            if (!integrate_mode) {
+                store_half_bit(last_value, &half_bits);
+                if (diff > max_stable_period_us_d) {
+                    store_half_bit(last_value, &half_bits);
                 }
-                time_diffs[diff_index++] = diff;
+            } else {
+                float halves[INTEGRATE_HELD];
+                const int count = integrate_edge(&integrator, now, binary >= 1, halves);
+                for (int i = 0; i < count; ++i) {
+                    store_half_bit(halves[i], &half_bits);
+                }
+                // Фронт вне границы окна - помеха, уровень участка не меняется
+                accepted = count >= 0;
             }
-
-            last_value = binary;
-            last_raw = median;
-            stable_start = now;
+            if (accepted) {
+                if (diff_index < MAX_TIME_DIFFS - 1) {
+                    time_diffs[diff_index++] = diff;
+                }
+                last_value = binary;
+                last_raw = median;
+                stable_start = now;
+            }
+        }
+        if (integrate_mode) {
+            integrate_sample(&integrator, now, (float)binary);
         }
 
         if (diff >= max_delay_period_us) {
@@ -140,44 +449,283 @@ void process_manchester_receive(
         }
         ets_delay_us(10);
     }
+    // Завершающий полубит метки к данным не относится
+    if (half_bits > 0) {
+        memmove(half_bits_buffer, half_bits_buffer + 1, (half_bits - 1) * sizeof(half_bits_buffer[0]));
+        --half_bits;
+    }
+    // Последний полубит сливается с паузой после кадра и фронтом не завершается
+    if (half_bits % 2 == 1) {
+        store_half_bit(integrate_mode ? integrate_tail(&integrator, (float)last_value) : last_value, &half_bits);
+    }
+    time_diffs[diff_index++] = max_stable_period_us_d;
+    return half_bits;
+}
+
+// Качество последнего кадра receive_manchester_frame()
+static int frame_pairs = 0;
+static int frame_invalid_pairs = 0;
+
+void receiver_last_frame_quality(int* pairs, int* invalid) {
+    *pairs = frame_pairs;
+    *invalid = frame_invalid_pairs;
+}
+
+int receive_manchester_frame(
+    const int threshold, const int baseFrequency,
+    uint8_t* data, const int max_len, const int64_t sync_timeout_us
+) {
+    frame_pairs = 0;
+    frame_invalid_pairs = 0;
+    const int half_bits = receive_half_bits(threshold, baseFrequency, sync_timeout_us);
+    if (half_bits < 0) {
+        return -1;
+    }
+    // Неразличимая пара принимается как более вероятный бит, целостность проверяется выше по стеку.
+    // Ошибкой считается пара без пересечения порога, в том числе неразличимая
+    const int bytes = half_bits / 16;
+    int len = 0;
+    for (int byte_index = 0; byte_index < bytes && len < max_len; byte_index += 2) {
+        uint16_t invalid;
+        uint16_t undecided;
+        const uint16_t word = decode_manchester_word(
+            half_bits_buffer + byte_index * 16, half_bits - byte_index * 16, &invalid, &undecided
+        );
+        data[len++] = word >> 8;
+        frame_invalid_pairs += __builtin_popcount(invalid >> 8);
+        frame_pairs += 8;
+        if (byte_index + 1 < bytes && len < max_len) {
+            data[len++] = word & 0xFF;
+            frame_invalid_pairs += __builtin_popcount(invalid & 0xFF);
+            frame_pairs += 8;
+        }
+    }
+    return len;
+}
+
+void process_manchester_receive(
+    const int threshold, const int baseFrequency,
+    const uart_port_t uart_port
+) {
+    const int half_bits = receive_half_bits(threshold, baseFrequency, RECEIVE_SYNC_TIMEOUT_US);
+    if (half_bits < 0) {
+        return;
+    }
+    bufpool_frame_t* output = acquire_output_buffer();
+    if (!output) {
+        return;
+    }
+    uint8_t* bytes_buffer = output->data;
 
     int packet_byte_buffer_index = 0;
-    for (int byte_bits_index = 0; byte_bits_index <= half_bits / 16; ++byte_bits_index) {
-        unsigned char byte_value = 0;
-        bool skip_byte = 0;
-        for (int i = 0; i < 8; ++i) {
-            if (skip_byte) {
-                continue;
-            }
-            const double first = half_bits_buffer[byte_bits_index * 16 + i * 2];
-            const double second = half_bits_buffer[byte_bits_index * 16 + i * 2 + 1];
-            const char bit = decode_manchester_pair(
-                first,
-                second
-            );
-            if (bit == 2) {
-                skip_byte = true;
-                byte_value = ' ';
-                continue;
-            }
-            byte_value |= (bit << (7 - i));
+    // Байт с неразличимой парой выводится пробелом. Неполный последний байт тоже выводится:
+    // недостающие полубиты буфера нулевые и дают неразличимые пары
+    const int bytes = half_bits / 16 + 1;
+    for (int byte_index = 0; byte_index < bytes && packet_byte_buffer_index < BUFPOOL_BLOCK_SIZE - 3; byte_index += 2) {
+        uint16_t invalid;
+        uint16_t undecided;
+        const uint16_t word = decode_manchester_word(
+            half_bits_buffer + byte_index * 16, MAX_HALF_BITS - byte_index * 16, &invalid, &undecided
+        );
+        bytes_buffer[packet_byte_buffer_index++] = undecided >> 8 ? ' ' : word >> 8;
+        if (byte_index + 1 < bytes && packet_byte_buffer_index < BUFPOOL_BLOCK_SIZE - 3) {
+            bytes_buffer[packet_byte_buffer_index++] = undecided & 0xFF ? ' ' : word & 0xFF;
         }
-        bytes_buffer[packet_byte_buffer_index++] = byte_value;
     }
 
     if (packet_byte_buffer_index > 0) {
         bytes_buffer[packet_byte_buffer_index++] = '\r';
         bytes_buffer[packet_byte_buffer_index++] = '\n';
         bytes_buffer[packet_byte_buffer_index++] = '\0';
-        uart_write_bytes(uart_port, bytes_buffer, packet_byte_buffer_index);
+        console_write(uart_port, bytes_buffer, packet_byte_buffer_index);
     }
+    bufpool_release(output);
 
     print_double_arraqy(half_bits_buffer, half_bits);
-    time_diffs[diff_index++] = max_stable_period_us_d;
     print_int_arraqy(time_diffs, diff_index);
 }
 
 
+// Мягкое решение по манчестерской паре: разность половин (бит 1 - сначала низкий уровень)
+static int8_t soft_manchester_pair(const double first, const double second) {
+    const double value = (second - first) * 64;
+    if (value > FEC_SOFT_MAX) {
+        return FEC_SOFT_MAX;
+    }
+    if (value < -FEC_SOFT_MAX) {
+        return -FEC_SOFT_MAX;
+    }
+    return (int8_t)value;
+}
+
+void process_fec_receive(
+    const int threshold, const int baseFrequency,
+    const uart_port_t uart_port
+) {
+    const int half_bits = receive_half_bits(threshold, baseFrequency, RECEIVE_SYNC_TIMEOUT_US);
+    if (half_bits < 0) {
+        return;
+    }
+    int8_t* soft_bits_buffer = rx_workspace.manchester.soft_bits;
+    int bits = half_bits / 2;
+    if (bits > (int)sizeof(rx_workspace.manchester.soft_bits)) {
+        bits = sizeof(rx_workspace.manchester.soft_bits);
+    }
+    for (int i = 0; i < bits; ++i) {
+        soft_bits_buffer[i] = soft_manchester_pair(half_bits_buffer[2 * i], half_bits_buffer[2 * i + 1]);
+    }
+
+    bufpool_frame_t* output = acquire_output_buffer();
+    if (!output) {
+        return;
+    }
+    output->len = fec_decode(soft_bits_buffer, bits, output->data, FEC_MAX_DATA);
+    if (output->len > 0) {
+        output->data[output->len++] = '\r';
+        output->data[output->len++] = '\n';
+        console_write(uart_port, output->data, output->len);
+    }
+    bufpool_release(output);
+}
+
+static lzss_decoder_t lzss_decoder;
+
+void process_lzss_receive(
+    const int threshold, const int baseFrequency,
+    const uart_port_t uart_port
+) {
+    const int half_bits = receive_half_bits(threshold, baseFrequency, RECEIVE_SYNC_TIMEOUT_US);
+    if (half_bits < 16 * LZSS_HEADER_SIZE) {
+        return;
+    }
+
+    bufpool_frame_t* frame = acquire_output_buffer();
+    if (!frame) {
+        return;
+    }
+    uint8_t* lzss_output = frame->data;
+    int output = 0;
+    uint16_t word = 0;
+    for (int byte_index = 0; byte_index < half_bits / 16; ++byte_index) {
+        if (byte_index % 2 == 0) {
+            uint16_t invalid;
+            uint16_t undecided;
+            word = decode_manchester_word(
+                half_bits_buffer + byte_index * 16, half_bits - byte_index * 16, &invalid, &undecided
+            );
+        }
+        const uint8_t byte_value = byte_index % 2 == 0 ? word >> 8 : word & 0xFF;
+        if (byte_index == 0) {
+            lzss_decoder_reset(&lzss_decoder, byte_value);
+            continue;
+        }
+        // Распакованное выводится порциями, место под самую длинную ссылку всегда остаётся
+        output += lzss_decoder_feed(&lzss_decoder, byte_value, lzss_output + output);
+        if (output > BUFPOOL_BLOCK_SIZE - LZSS_MAX_MATCH) {
+            console_write(uart_port, lzss_output, output);
+            output = 0;
+        }
+    }
+    if (output > 0) {
+        console_write(uart_port, lzss_output, output);
+    }
+    bufpool_release(frame);
+    console_write(uart_port, "\r\n", 2);
+}
+
+
+void process_ppm_receive(
+    const int threshold, const int baseFrequency, const int order,
+    const uart_port_t uart_port
+) {
+    if (!await_end_sync(threshold, RECEIVE_SYNC_TIMEOUT_US)) {
+        return;
+    }
+    int slot_us = 500000 / baseFrequency;
+    if (slot_us < 1) slot_us = 1;
+    const int64_t symbol_us = (int64_t)order * slot_us;
+
+    // Моменты передних фронтов импульсов; отсчёты без паузы, чтобы точнее попадать в слот
+    int pulses = 0;
+    int level = 0;
+    int edge_raw = adc1_get_raw(ADC1_CHANNEL_4);
+    int64_t last_edge = esp_timer_get_time();
+    int64_t silence_us = SYNC_TAIL_US + 2 * symbol_us;
+    while (true) {
+        const int64_t now = esp_timer_get_time();
+        rtc_wdt_feed();
+        const int raw = adc1_get_raw(ADC1_CHANNEL_4);
+        const int high = raw >= threshold;
+        if (high != level && abs(raw - edge_raw) > 300) {
+            level = high;
+            edge_raw = raw;
+            last_edge = now;
+            silence_us = PPM_END_SILENCE_SYMBOLS * symbol_us;
+            if (high && pulses < PPM_MAX_SYMBOLS + 1) {
+                rx_workspace.ppm.pulses[pulses++] = now;
+            }
+        }
+        if (now - last_edge > silence_us) {
+            break;
+        }
+    }
+
+    uint8_t* symbols = rx_workspace.ppm.symbols;
+    const int count = ppm_decode_pulses(order, slot_us, rx_workspace.ppm.pulses, pulses, symbols, PPM_MAX_SYMBOLS);
+    bufpool_frame_t* output = acquire_output_buffer();
+    if (!output) {
+        return;
+    }
+    output->len = ppm_unpack_symbols(order, symbols, count, output->data, PPM_FRAME_MAX_DATA);
+    if (output->len > 0) {
+        output->data[output->len++] = '\r';
+        output->data[output->len++] = '\n';
+        console_write(uart_port, output->data, output->len);
+    }
+    bufpool_release(output);
+}
+
+// Оценка канала по последнему кадру OFDM
+static ofdm_channel_t ofdm_channel;
+static int ofdm_channel_valid = 0;
+
+void process_ofdm_receive(const int threshold, const int sampleRate, const uart_port_t uart_port) {
+    if (!await_end_sync(threshold, RECEIVE_SYNC_TIMEOUT_US)) {
+        return;
+    }
+    // Запись начинается за пол-префикса до первого пилота: ошибка обнаружения конца синхронизации
+    // в обе стороны остаётся внутри префикса
+    const int64_t start = esp_timer_get_time() + SYNC_TAIL_US - (int64_t)OFDM_CP * 500000 / sampleRate;
+    for (int i = 0; i < OFDM_MAX_SAMPLES; ++i) {
+        const int64_t deadline = start + (int64_t)i * 1000000 / sampleRate;
+        while (esp_timer_get_time() < deadline) {
+        }
+        rx_workspace.ofdm_samples[i] = adc1_get_raw(ADC1_CHANNEL_4);
+        if (i % OFDM_SYMBOL_SAMPLES == 0) {
+            rtc_wdt_feed();
+        }
+    }
+
+    bufpool_frame_t* output = acquire_output_buffer();
+    if (!output) {
+        return;
+    }
+    output->len = ofdm_demodulate(rx_workspace.ofdm_samples, OFDM_MAX_SAMPLES, output->data, OFDM_MAX_DATA, &ofdm_channel);
+    if (output->len >= 0) {
+        ofdm_channel_valid = 1;
+    }
+    if (output->len > 0) {
+        output->data[output->len++] = '\r';
+        output->data[output->len++] = '\n';
+        console_write(uart_port, output->data, output->len);
+    }
+    bufpool_release(output);
+}
+
+const ofdm_channel_t* receiver_ofdm_channel(void) {
+    return ofdm_channel_valid ? &ofdm_channel : NULL;
+}
+
 void test_receive_all(const uart_port_t uart_port, const int threshold) {
     for (int a = 0; a < 10; ++a) {
         char buffer[98]; // 96 символов + 3 для \r\n\0
@@ -193,7 +741,7 @@ void test_receive_all(const uart_port_t uart_port, const int threshold) {
 
         buffer[offset++] = '\n'; // Добавляем перенос строки
         buffer[offset++] = '\0'; // Добавляем перенос строки
-        uart_write_bytes(uart_port, buffer, offset);
+        console_write(uart_port, buffer, offset);
     }
 }
 
@@ -210,5 +758,5 @@ void test_receive_raw(const uart_port_t uart_port) {
     buffer[4 * RAW_RECEIVE_ROWS] = '\n';
     buffer[4 * RAW_RECEIVE_ROWS + 1] = '\0';
 
-    uart_write_bytes(uart_port, buffer, 4 * RAW_RECEIVE_ROWS + 2);
+    console_write(uart_port, buffer, 4 * RAW_RECEIVE_ROWS + 2);
 }
@@ -1,19 +1,89 @@
 #ifndef RECEIVER_H
 #define RECEIVER_H
+#include <stddef.h>
+#include <stdint.h>
 #include <hal/uart_types.h>
 
+#include "bufpool.h"
+#include "eq.h"
+#include "ofdm.h"
+#include "rxfsm.h"
+
 // Ожидание и чтение кодированных данных
 void process_manchester_receive(
     int threshold, int baseFrequency,
     uart_port_t uart_port
 );
 
+// Непрерывный приём манчестерских кадров задачей на втором ядре: кадры идут подряд без потерь между ними.
+// Повторный вызов с теми же настройками ничего не меняет, с другими - приём начинается заново
+void receiver_stream_start(int threshold, int baseFrequency);
+// Остановка до возврата: после неё АЦП свободен, непрочитанные кадры отброшены
+void receiver_stream_stop(void);
+// Очередной принятый кадр (байты в data, длина в len) или NULL. Блок освобождает вызывающий
+bufpool_frame_t* receiver_stream_take(void);
+// Счётчики автомата и кадры, отброшенные из-за нехватки блоков или переполнения очереди
+void receiver_stream_stats(rxfsm_stats_t* stats, uint32_t* dropped);
+
+// Приём одного кадра в буфер data (не более max_len байт), без вывода в UART
+// Возвращает число принятых байт, -1 если синхропоследовательность не найдена за sync_timeout_us
+int receive_manchester_frame(
+    int threshold, int baseFrequency,
+    uint8_t* data, int max_len, int64_t sync_timeout_us
+);
+
+// Пары последнего кадра receive_manchester_frame(): всего и без пересечения порога (ошибочные)
+void receiver_last_frame_quality(int* pairs, int* invalid);
+
+// Приём кадра со свёрточным кодом: декодирование Витерби по мягким решениям полубитов
+void process_fec_receive(
+    int threshold, int baseFrequency,
+    uart_port_t uart_port
+);
+
+// Приём кадра со сжатием: распаковка по мере декодирования байтов
+void process_lzss_receive(
+    int threshold, int baseFrequency,
+    uart_port_t uart_port
+);
+
+// Приём кадра L-PPM порядка order по моментам передних фронтов импульсов
+void process_ppm_receive(
+    int threshold, int baseFrequency, int order,
+    uart_port_t uart_port
+);
+
+// Приём кадра DCO-OFDM: sampleRate отсчётов АЦП в секунду, разбор по пилотам и заголовку кадра
+void process_ofdm_receive(int threshold, int sampleRate, uart_port_t uart_port);
+// Оценка канала по последнему принятому кадру OFDM, NULL - кадров ещё не было
+const ofdm_channel_t* receiver_ofdm_channel(void);
+
 // Бинарное чтение строки
 void test_receive_all(uart_port_t uart_port, int threshold);
 
 // Аналоговое чтение строки
 void test_receive_raw(uart_port_t uart_port);
 
+// Интегрирование всех отсчётов полубита вместо одного отсчёта на фронте
+void set_receiver_integrate(int enabled);
+int get_receiver_integrate(void);
+
+// Эквалайзер межсимвольной интерференции, обучаемый по синхропоследовательности каждого кадра
+void set_receiver_equaliser(int enabled);
+int get_receiver_equaliser(void);
+// Коэффициенты, обученные на последнем кадре
+const eq_t* receiver_equaliser_state(void);
+
+// Скорость каждого кадра определяется по метке после синхропоследовательности, заданная частота не используется
+void set_receiver_autorate(int enabled, int max_frequency);
+int get_receiver_autorate(void);
+
+// Скорость, на которой принят последний кадр
+int receiver_last_frame_rate(void);
+
+// Размер рабочей памяти приёма, общей для всех режимов
+size_t receiver_workspace_size(void);
+
 void init_receiver(void);
 
 #endif
@@ -0,0 +1,241 @@
+#include "rxfsm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "manchester.h"
+#include "perf.h"
+#include "synchronizer.h"
+
+static void enter_hunt(rxfsm_t* fsm) {
+    fsm->state = RXFSM_HUNT;
+    fsm->window_count = 0;
+    fsm->window_pos = 0;
+    fsm->window_sum = 0;
+    fsm->sync_level = -1;
+    fsm->sync_stable_start = 0;
+    fsm->sync_bits = 0;
+}
+
+void rxfsm_init(rxfsm_t* fsm, const rxfsm_config_t* config) {
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->config = *config;
+    enter_hunt(fsm);
+}
+
+void rxfsm_set_output(rxfsm_t* fsm, uint8_t* data, const int max_len) {
+    fsm->data = data;
+    fsm->max_len = data ? max_len : 0;
+}
+
+int rxfsm_sample_delay_us(const rxfsm_t* fsm) {
+    switch (fsm->state) {
+        case RXFSM_HUNT: return 1;
+        case RXFSM_MARKER: return fsm->config.eq ? 10 : 0;
+        default: return 10;
+    }
+}
+
+int rxfsm_idle(const rxfsm_t* fsm, const int64_t now_us) {
+    if (fsm->state != RXFSM_HUNT || fsm->window_count == 0) {
+        return 0;
+    }
+    if (fsm->sync_level != -1 && now_us - fsm->sync_stable_start <= RXFSM_IDLE_US) {
+        return 0;
+    }
+    // Отсчёт по другую сторону порога - возможно, началась смена уровня: окно набирается без пауз
+    const int last = fsm->window[(fsm->window_pos + RXFSM_SYNC_WINDOW - 1) % RXFSM_SYNC_WINDOW];
+    return (last >= fsm->config.threshold) == (fsm->sync_level == 1);
+}
+
+// Шаг await_end_sync(). Возвращает 1 на смене уровня, завершившей синхропоследовательность (начало паузы)
+static LIFI_HOT int hunt_feed(rxfsm_t* fsm, const int64_t now, const int raw) {
+    if (fsm->window_count == RXFSM_SYNC_WINDOW) {
+        fsm->window_sum -= fsm->window[fsm->window_pos];
+    } else {
+        ++fsm->window_count;
+    }
+    fsm->window[fsm->window_pos] = raw;
+    fsm->window_sum += raw;
+    fsm->window_pos = (fsm->window_pos + 1) % RXFSM_SYNC_WINDOW;
+
+    // До первой смены уровня линия считается низкой
+    const int level = fsm->window_sum >= fsm->config.threshold * fsm->window_count;
+    if (level == (fsm->sync_level == 1) || fsm->window_count < RXFSM_SYNC_MIN_SAMPLES) {
+        return 0;
+    }
+    if (fsm->sync_level != -1 && now - fsm->sync_stable_start > RXFSM_IDLE_US) {
+        // Такой паузы в синхропоследовательности нет: биты до неё не сложатся с началом следующей
+        fsm->sync_bits = 0;
+    } else if (fsm->sync_level != -1) {
+        const int bits = now - fsm->sync_stable_start > RXFSM_SYNC_MAX_STABLE_US ? 2 : 1;
+        for (int i = 0; i < bits; ++i) {
+            fsm->sync_bits = fsm->sync_bits << 1 | fsm->sync_level;
+        }
+    }
+    fsm->sync_stable_start = now;
+    fsm->sync_level = level;
+    fsm->window_count = 0;
+    fsm->window_pos = 0;
+    fsm->window_sum = 0;
+    return fsm->sync_bits == RXFSM_SYNC_PATTERN;
+}
+
+static void enter_marker(rxfsm_t* fsm) {
+    // Фронты метки ищутся в пределах паузы и восьми бит на самой низкой допустимой скорости
+    const int slowest = fsm->config.autorate_max ? RATE_AUTO_MIN_FREQ : fsm->config.frequency;
+    fsm->state = RXFSM_MARKER;
+    fsm->marker_started = 0;
+    fsm->marker_timeout_us = SYNC_TAIL_US + (int64_t)(RATE_MARKER_BITS + 1) * 1000000 / slowest;
+}
+
+// Начало данных с последнего фронта метки (спад): первым придёт её завершающий низкий полубит
+static void enter_data(rxfsm_t* fsm) {
+    int rate = fsm->config.frequency;
+    if (fsm->config.autorate_max) {
+        rate = rate_marker_estimate(&fsm->marker, RATE_AUTO_MIN_FREQ, fsm->config.autorate_max);
+        if (rate == 0) {
+            ++fsm->stats.marker_losses;
+            enter_hunt(fsm);
+            return;
+        }
+    }
+    fsm->state = RXFSM_DATA;
+    fsm->frame_rate = rate;
+    fsm->timing = get_rate_timing(rate);
+    fsm->last_raw = fsm->marker.edge_raw;
+    fsm->last_value = (float)fsm->marker.edge_raw / fsm->config.threshold;
+    fsm->stable_start = fsm->marker.edge_us[RATE_MARKER_EDGES - 1];
+    integrate_start(&fsm->integrator, fsm->timing.half_period_us, fsm->stable_start, fsm->last_value >= 1);
+    fsm->half_bits = 0;
+    fsm->byte = 0;
+    fsm->byte_bits = 0;
+    fsm->byte_undecided = 0;
+    fsm->len = 0;
+}
+
+// Полубит кадра: вторая половина пары сразу декодируется в бит
+static LIFI_HOT void store_half_bit(rxfsm_t* fsm, const float value) {
+    if (fsm->half_bits >= RXFSM_MAX_HALF_BITS) {
+        return;
+    }
+    // Нулевой полубит - завершающий полубит метки, к данным он не относится
+    const int index = fsm->half_bits++;
+    if (index == 0) {
+        return;
+    }
+    if (index % 2 == 1) {
+        fsm->pending_half = value;
+        return;
+    }
+    const float first = fsm->pending_half;
+    const char decision = decode_manchester_pair(first, value);
+    ++fsm->stats.pairs;
+    if ((first >= 1) == (value >= 1)) {
+        ++fsm->stats.invalid_pairs;
+    }
+    fsm->byte_undecided |= decision == 2;
+    fsm->byte = fsm->byte << 1 | (decision == 2 ? value > first : decision);
+    if (++fsm->byte_bits == 8) {
+        if (fsm->len < fsm->max_len) {
+            fsm->data[fsm->len++] = fsm->byte_undecided ? ' ' : fsm->byte;
+        }
+        fsm->byte = 0;
+        fsm->byte_bits = 0;
+        fsm->byte_undecided = 0;
+    }
+}
+
+// Шаг цикла receive_half_bits(). Возвращает 1 после тишины, завершающей кадр
+static LIFI_HOT int data_feed(rxfsm_t* fsm, const int64_t now, const int raw) {
+    const int median = fsm->config.eq ? eq_apply(fsm->config.eq, raw) : raw;
+    const float binary = (float)median / fsm->config.threshold;
+    if (abs(median - fsm->last_raw) > RXFSM_MIN_STEP && (binary >= 1) != (fsm->last_value >= 1)) {
+        int accepted = 1;
+        if (!fsm->config.integrate) {
+            store_half_bit(fsm, fsm->last_value);
+            if (now - fsm->stable_start > fsm->timing.max_stable_period_us) {
+                store_half_bit(fsm, fsm->last_value);
+            }
+        } else {
+            float halves[INTEGRATE_HELD];
+            const int count = integrate_edge(&fsm->integrator, now, binary >= 1, halves);
+            for (int i = 0; i < count; ++i) {
+                store_half_bit(fsm, halves[i]);
+            }
+            // Фронт вне границы окна - помеха, уровень участка не меняется
+            accepted = count >= 0;
+        }
+        if (accepted) {
+            fsm->last_value = binary;
+            fsm->last_raw = median;
+            fsm->stable_start = now;
+        }
+    }
+    if (fsm->config.integrate) {
+        integrate_sample(&fsm->integrator, now, binary);
+    }
+
+    if (now - fsm->stable_start < fsm->timing.max_delay_period_us) {
+        return 0;
+    }
+    // Последний полубит сливается с паузой после кадра и фронтом не завершается
+    if (fsm->half_bits > 0 && fsm->half_bits % 2 == 0) {
+        store_half_bit(
+            fsm, fsm->config.integrate ? integrate_tail(&fsm->integrator, fsm->last_value) : fsm->last_value
+        );
+    }
+    return 1;
+}
+
+LIFI_HOT int rxfsm_feed(rxfsm_t* fsm, const int64_t now_us, const int raw) {
+    switch (fsm->state) {
+        case RXFSM_HUNT:
+            if (hunt_feed(fsm, now_us, raw)) {
+                if (fsm->config.eq) {
+                    fsm->state = RXFSM_TRAIN;
+                    fsm->eq_count = 0;
+                } else {
+                    enter_marker(fsm);
+                }
+            }
+            return -1;
+        case RXFSM_TRAIN:
+            // Спад в паузе после синхропоследовательности
+            fsm->eq_samples[fsm->eq_count++] = raw;
+            if (fsm->eq_count == RXFSM_EQ_TRAIN_SAMPLES) {
+                eq_train(fsm->config.eq, fsm->eq_samples, RXFSM_EQ_TRAIN_SAMPLES);
+                eq_start(fsm->config.eq, raw);
+                enter_marker(fsm);
+            }
+            return -1;
+        case RXFSM_MARKER: {
+            const int value = fsm->config.eq ? eq_apply(fsm->config.eq, raw) : raw;
+            if (!fsm->marker_started) {
+                rate_marker_start(&fsm->marker, fsm->config.threshold, value);
+                fsm->marker_started = 1;
+                fsm->marker_start = now_us;
+                return -1;
+            }
+            if (rate_marker_feed(&fsm->marker, now_us, value)) {
+                enter_data(fsm);
+            } else if (now_us - fsm->marker_start > fsm->marker_timeout_us) {
+                ++fsm->stats.marker_losses;
+                enter_hunt(fsm);
+            }
+            return -1;
+        }
+        case RXFSM_DATA: {
+            if (!data_feed(fsm, now_us, raw)) {
+                return -1;
+            }
+            ++fsm->stats.frames;
+            const int len = fsm->len;
+            fsm->data = NULL;
+            fsm->max_len = 0;
+            enter_hunt(fsm);
+            return len;
+        }
+    }
+    return -1;
+}
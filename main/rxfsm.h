@@ -0,0 +1,110 @@
+#ifndef RXFSM_H
+#define RXFSM_H
+
+#include <stdint.h>
+
+#include "eq.h"
+#include "integrate.h"
+#include "rates.h"
+
+// Непрерывный приём манчестерских кадров: автомат получает отсчёты по одному и между кадрами не выходит
+// из цикла отсчётов. Поиск синхропоследовательности -> обучение эквалайзера -> метка скорости -> данные -> поиск.
+// Пары полубитов декодируются по мере приёма, поэтому на конец кадра не нужен отдельный проход
+
+// Поиск повторяет await_end_sync(): уровень по среднему последних отсчётов, смена уровня - не раньше
+// чем через RXFSM_SYNC_MIN_SAMPLES отсчётов после предыдущей, уровень дольше RXFSM_SYNC_MAX_STABLE_US - два бита
+#define RXFSM_SYNC_WINDOW 10
+#define RXFSM_SYNC_MIN_SAMPLES 6
+#define RXFSM_SYNC_MAX_STABLE_US 30000
+// Синхропоследовательность 1010101001010101, первый бит - старший
+#define RXFSM_SYNC_PATTERN 0xAA55
+#define RXFSM_EQ_TRAIN_SAMPLES 256
+// Порог фронта по изменению отсчёта, как в цикле приёма
+#define RXFSM_MIN_STEP 300
+// Линия без смены уровня дольше любого бита синхропоследовательности - кадра нет
+#define RXFSM_IDLE_US (2 * RXFSM_SYNC_MAX_STABLE_US)
+// Полубитов в кадре не больше, чем в буфере блокирующего приёма
+#define RXFSM_MAX_HALF_BITS 16384
+
+typedef enum {
+    RXFSM_HUNT,
+    RXFSM_TRAIN,
+    RXFSM_MARKER,
+    RXFSM_DATA,
+} rxfsm_state_t;
+
+typedef struct {
+    int threshold;
+    int frequency;    // Скорость данных, если она не определяется по метке
+    int autorate_max; // 0 - скорость задана, иначе наибольшая скорость автоопределения
+    int integrate;    // Полубит - среднее отсчётов окна в полупериод, см. integrate.h
+    eq_t* eq;         // Эквалайзер, обучаемый на каждом кадре, NULL - без него
+} rxfsm_config_t;
+
+typedef struct {
+    uint32_t frames;        // Завершённые кадры
+    uint32_t marker_losses; // Синхропоследовательность найдена, метка скорости - нет
+    uint32_t pairs;         // Пары полубитов во всех кадрах
+    uint32_t invalid_pairs; // Из них без пересечения порога
+} rxfsm_stats_t;
+
+typedef struct {
+    rxfsm_config_t config;
+    rxfsm_state_t state;
+    rxfsm_stats_t stats;
+
+    // Поиск синхропоследовательности
+    int window[RXFSM_SYNC_WINDOW];
+    int window_count;
+    int window_pos;
+    int window_sum;
+    int sync_level; // -1 - смены уровня ещё не было
+    int64_t sync_stable_start;
+    uint16_t sync_bits;
+
+    int eq_samples[RXFSM_EQ_TRAIN_SAMPLES];
+    int eq_count;
+
+    rate_marker_t marker;
+    int marker_started;
+    int64_t marker_start;
+    int64_t marker_timeout_us;
+
+    // Данные: текущий стабильный участок
+    rate_timing_t timing;
+    int last_raw;
+    float last_value;
+    int64_t stable_start;
+    integrate_t integrator; // Окна полубитов в режиме интегрирования
+    // Полубиты кадра, первый (завершающий полубит метки) пропускается; ожидающая пары половина
+    int half_bits;
+    float pending_half;
+    uint8_t byte;
+    int byte_bits;
+    int byte_undecided;
+
+    uint8_t* data;
+    int max_len;
+    int len;
+    int frame_rate; // Скорость последнего кадра
+} rxfsm_t;
+
+void rxfsm_init(rxfsm_t* fsm, const rxfsm_config_t* config);
+
+// Буфер для следующего кадра. Без буфера кадр демодулируется, но байты отбрасываются
+void rxfsm_set_output(rxfsm_t* fsm, uint8_t* data, int max_len);
+
+// Отсчёт raw в момент now_us. Возвращает длину завершённого кадра в буфере вывода, иначе -1.
+// Байт с неразличимой парой записывается пробелом, неполный последний байт отбрасывается.
+// К следующему отсчёту автомат уже ищет новый кадр, буфер вывода отдан вызывающему и снят
+int rxfsm_feed(rxfsm_t* fsm, int64_t now_us, int raw);
+
+// Пауза между отсчётами в текущем состоянии, как в блокирующих циклах приёма
+int rxfsm_sample_delay_us(const rxfsm_t* fsm);
+
+// Поиск синхропоследовательности, уровень линии не менялся с начала поиска или дольше RXFSM_IDLE_US,
+// и последний отсчёт на той же стороне порога. Пауза короче полубита синхропоследовательности тогда
+// сдвигает только первую смену уровня, и кадр не теряется
+int rxfsm_idle(const rxfsm_t* fsm, int64_t now_us);
+
+#endif //RXFSM_H
@@ -1,39 +1,78 @@
 #include "sender.h"
 
+#include <esp_cpu.h>
 #include <rtc_wdt.h>
+#include <driver/dac_oneshot.h>
 #include <driver/gpio.h>
 #include <driver/uart.h>
-#include <rom/ets_sys.h>
+
+#include "bufpool.h"
+#include "console.h"
+#include "fec.h"
+#include "lzss.h"
+#include "manchester.h"
+#include "ofdm.h"
+#include "perf.h"
+#include "ppm.h"
+#include "rates.h"
+#include "sdkconfig.h"
 
 // Esp32 TX2 (GPIO 17)
 #define LED_GPIO         17
 
+// Светодиод OFDM с аналоговым драйвером на выходе ЦАП, Esp32 GPIO 25
+#define OFDM_DAC_CHANNEL DAC_CHAN_0
+
 #define SYNC_PERIOD        10000
 
 // Период работы одного бита во время синхронизации
 #define SYNC_HALF_PERIOD_US 20000
 
-void send_manchester_bit(const int bit, const int half_period_us) {
+// Тайминги передачи отсчитываются от абсолютных моментов по счётчику тактов процессора:
+// время вызовов GPIO, сброса watchdog и прерываний поглощается ожиданием и не накапливается от бита к биту
+#define TX_CYCLES_PER_US CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+// Полупериод бита в тактах, точный и для скоростей, у которых он не кратен микросекунде
+#define TX_HALF_PERIOD_CYCLES(f) (TX_CYCLES_PER_US * 500000 / (f))
+
+// Конец последнего выведенного полупериода
+static uint32_t tx_deadline = 0;
+
+static inline LIFI_HOT void tx_wait_until(const uint32_t deadline) {
+    while ((int32_t)(esp_cpu_get_cycle_count() - deadline) < 0) {
+    }
+}
+
+void tx_timebase_start(void) {
+    tx_deadline = esp_cpu_get_cycle_count();
+}
+
+// Уровень на cycles тактов после конца предыдущего полупериода. Если передача отстала больше чем на полупериод
+// (долгое прерывание, вызов без tx_timebase_start), отсчёт начинается заново, а не догоняет укороченными битами
+static inline LIFI_HOT void tx_level(const int level, const uint32_t cycles) {
+    gpio_set_level(LED_GPIO, level);
+    if ((int32_t)(esp_cpu_get_cycle_count() - tx_deadline) > (int32_t)cycles) {
+        tx_deadline = esp_cpu_get_cycle_count();
+    }
+    tx_deadline += cycles;
+    tx_wait_until(tx_deadline);
+}
+
+LIFI_HOT void send_manchester_bit(const int bit, const int half_period_us) {
+    const uint32_t half_cycles = half_period_us * TX_CYCLES_PER_US;
     if (bit == 0) {
-        gpio_set_level(LED_GPIO, 1);
-        ets_delay_us(half_period_us);
-        gpio_set_level(LED_GPIO, 0);
-        ets_delay_us(half_period_us);
+        tx_level(1, half_cycles);
+        tx_level(0, half_cycles);
     } else if (bit == 1) {
-        gpio_set_level(LED_GPIO, 0);
-        ets_delay_us(half_period_us);
-        gpio_set_level(LED_GPIO, 1);
-        ets_delay_us(half_period_us);
+        tx_level(0, half_cycles);
+        tx_level(1, half_cycles);
     } else if (bit == -1) {
-        gpio_set_level(LED_GPIO, 0);
-        ets_delay_us(half_period_us * 2);
+        tx_level(0, half_cycles * 2);
     } else if (bit == 2) {
-        gpio_set_level(LED_GPIO, 1);
-        ets_delay_us(half_period_us * 2);
+        tx_level(1, half_cycles * 2);
     }
 }
 
-void send_sync_seq(void) {
+LIFI_HOT void send_sync_seq(void) {
     for (int i = 0; i < 4; ++i) {
         send_manchester_bit(0, SYNC_HALF_PERIOD_US);
     }
@@ -44,21 +83,230 @@ void send_sync_seq(void) {
     rtc_wdt_feed();
 }
 
-void process_binary_data(const uint8_t* data, const int len, const double baseFrequency) {
-    send_sync_seq();
+// Байт целиком: 16 полубитов слова manchester_encode_byte(), старший первым, без разбора по битам
+#define TX_BYTE(byte, half_cycles)                            \
+    {                                                         \
+        const uint16_t halves = manchester_encode_byte(byte); \
+        for (int h = 15; h >= 0; --h) {                       \
+            tx_level((halves >> h) & 1, half_cycles);         \
+        }                                                     \
+    }
 
-    int half_period_us = (int)(1000000.0 / baseFrequency / 2);
-    if (half_period_us < 1) half_period_us = 1;
+// То же без цикла: сдвиги - константы, между фронтами нет счётчика и условного перехода
+#define TX_HALF(halves, h, half_cycles) tx_level(((halves) >> (h)) & 1, half_cycles);
+#define TX_BYTE_UNROLLED(byte, half_cycles)                               \
+    {                                                                     \
+        const uint16_t halves = manchester_encode_byte(byte);             \
+        TX_HALF(halves, 15, half_cycles) TX_HALF(halves, 14, half_cycles) \
+        TX_HALF(halves, 13, half_cycles) TX_HALF(halves, 12, half_cycles) \
+        TX_HALF(halves, 11, half_cycles) TX_HALF(halves, 10, half_cycles) \
+        TX_HALF(halves, 9, half_cycles) TX_HALF(halves, 8, half_cycles)   \
+        TX_HALF(halves, 7, half_cycles) TX_HALF(halves, 6, half_cycles)   \
+        TX_HALF(halves, 5, half_cycles) TX_HALF(halves, 4, half_cycles)   \
+        TX_HALF(halves, 3, half_cycles) TX_HALF(halves, 2, half_cycles)   \
+        TX_HALF(halves, 1, half_cycles) TX_HALF(halves, 0, half_cycles)   \
+    }
 
+// Ядро передачи для стандартной скорости: полупериод - константа времени компиляции, байт развёрнут
+#define DEFINE_TX_KERNEL(f)                                                  \
+    static LIFI_HOT void tx_kernel_##f(const uint8_t* data, const int len) { \
+        for (int i = 0; i < len; i++) {                                      \
+            const uint8_t data_byte = data[i];                               \
+            TX_BYTE_UNROLLED(data_byte, TX_HALF_PERIOD_CYCLES(f))            \
+            rtc_wdt_feed();                                                  \
+        }                                                                    \
+    }
+
+STANDARD_RATES(DEFINE_TX_KERNEL)
+
+typedef struct {
+    int frequency;
+    void (*kernel)(const uint8_t* data, int len);
+} tx_kernel_entry_t;
+
+#define TX_KERNEL_ENTRY(f) {(f), tx_kernel_##f},
+
+static const LIFI_HOT_DATA tx_kernel_entry_t tx_kernels[] = {
+    STANDARD_RATES(TX_KERNEL_ENTRY)
+};
+
+#define TX_KERNEL_COUNT (int)(sizeof(tx_kernels) / sizeof(tx_kernels[0]))
+
+// Общий путь для нестандартных скоростей
+static LIFI_HOT void tx_kernel_generic(const uint8_t* data, const int len, const uint32_t half_cycles) {
     for (int i = 0; i < len; i++) {
         const uint8_t data_byte = data[i];
-        for (int bit = 7; bit >= 0; bit--) {
-            const int current = (data_byte >> bit) & 1;
-            send_manchester_bit(current, half_period_us);
-            rtc_wdt_feed();
+        TX_BYTE(data_byte, half_cycles)
+        rtc_wdt_feed();
+    }
+}
+
+LIFI_HOT void send_manchester_frame(const uint8_t* data, const int len, const double baseFrequency) {
+    tx_timebase_start();
+    send_sync_seq();
+
+    // Метка скорости идёт тем же ядром без разрыва, по ней приёмник может определить скорость кадра
+    static const LIFI_HOT_DATA uint8_t marker = RATE_MARKER;
+    const int rate = (int)baseFrequency;
+    int sent = 0;
+    if (rate == baseFrequency) {
+        for (int i = 0; i < TX_KERNEL_COUNT; ++i) {
+            if (tx_kernels[i].frequency == rate) {
+                tx_kernels[i].kernel(&marker, 1);
+                tx_kernels[i].kernel(data, len);
+                sent = 1;
+                break;
+            }
         }
     }
+    if (!sent) {
+        uint32_t half_cycles = (uint32_t)(TX_CYCLES_PER_US * 500000.0 / baseFrequency);
+        if (half_cycles < 1) half_cycles = 1;
+        tx_kernel_generic(&marker, 1, half_cycles);
+        tx_kernel_generic(data, len, half_cycles);
+    }
 
     gpio_set_level(LED_GPIO, 0);
-    uart_write_bytes(UART_NUM_0, "Data sent\n\0", 11);
+}
+
+void process_binary_data(const uint8_t* data, const int len, const double baseFrequency) {
+    send_manchester_frame(data, len, baseFrequency);
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
+}
+
+_Static_assert(FEC_CODED_SIZE(FEC_MAX_DATA) <= BUFPOOL_BLOCK_SIZE, "FEC block does not fit a pool buffer");
+_Static_assert(LZSS_FRAME_MAX_DATA + LZSS_HEADER_SIZE <= BUFPOOL_BLOCK_SIZE, "LZSS frame does not fit a pool buffer");
+_Static_assert(PPM_MAX_SYMBOLS <= BUFPOOL_BLOCK_SIZE, "PPM symbols do not fit a pool buffer");
+
+// Блок под выход кодера на время передачи
+static bufpool_frame_t* acquire_encoder_buffer(void) {
+    bufpool_frame_t* frame = bufpool_acquire();
+    if (!frame) {
+        console_write(UART_NUM_0, "No free frame buffer\n\0", 22);
+    }
+    return frame;
+}
+
+void process_fec_data(const uint8_t* data, const int len, const double baseFrequency) {
+    bufpool_frame_t* coded = acquire_encoder_buffer();
+    if (!coded) {
+        return;
+    }
+    for (int offset = 0; offset < len; offset += FEC_MAX_DATA) {
+        const int chunk = len - offset < FEC_MAX_DATA ? len - offset : FEC_MAX_DATA;
+        coded->len = fec_encode(data + offset, chunk, coded->data);
+        send_manchester_frame(coded->data, coded->len, baseFrequency);
+    }
+    bufpool_release(coded);
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
+}
+
+void process_lzss_data(const uint8_t* data, const int len, const double baseFrequency) {
+    bufpool_frame_t* frame = acquire_encoder_buffer();
+    if (!frame) {
+        return;
+    }
+    for (int offset = 0; offset < len; offset += LZSS_FRAME_MAX_DATA) {
+        const int chunk = len - offset < LZSS_FRAME_MAX_DATA ? len - offset : LZSS_FRAME_MAX_DATA;
+        frame->len = lzss_pack_frame(data + offset, chunk, frame->data);
+        send_manchester_frame(frame->data, frame->len, baseFrequency);
+    }
+    bufpool_release(frame);
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
+}
+
+// Символ L-PPM: импульс длиной в слот на позиции symbol, остальные слоты - без света
+static LIFI_HOT void send_ppm_symbol(const int symbol, const int order, const uint32_t slot_cycles) {
+    if (symbol > 0) {
+        tx_level(0, symbol * slot_cycles);
+    }
+    tx_level(1, slot_cycles);
+    if (symbol < order - 1) {
+        tx_level(0, (order - 1 - symbol) * slot_cycles);
+    }
+}
+
+void process_ppm_data(const uint8_t* data, const int len, const double baseFrequency, const int order) {
+    bufpool_frame_t* symbols = acquire_encoder_buffer();
+    if (!symbols) {
+        return;
+    }
+    uint32_t slot_cycles = (uint32_t)(TX_CYCLES_PER_US * 500000.0 / baseFrequency);
+    if (slot_cycles < 1) slot_cycles = 1;
+    for (int offset = 0; offset < len; offset += PPM_FRAME_MAX_DATA) {
+        const int chunk = len - offset < PPM_FRAME_MAX_DATA ? len - offset : PPM_FRAME_MAX_DATA;
+        symbols->len = ppm_pack_symbols(order, data + offset, chunk, symbols->data, PPM_MAX_SYMBOLS);
+        tx_timebase_start();
+        send_sync_seq();
+        // Опорный импульс в слоте 0, от него приёмник отсчитывает символы
+        send_ppm_symbol(0, order, slot_cycles);
+        for (int i = 0; i < symbols->len; ++i) {
+            send_ppm_symbol(symbols->data[i], order, slot_cycles);
+            rtc_wdt_feed();
+        }
+        gpio_set_level(LED_GPIO, 0);
+    }
+    bufpool_release(symbols);
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
+}
+
+// Канал ЦАП создаётся при первой передаче OFDM
+static dac_oneshot_handle_t ofdm_dac = NULL;
+
+// Уровень ЦАП светодиода OFDM на cycles тактов, с той же привязкой к абсолютным моментам, что и tx_level()
+static LIFI_HOT void dac_level(const uint8_t value, const uint32_t cycles) {
+    dac_oneshot_output_voltage(ofdm_dac, value);
+    if ((int32_t)(esp_cpu_get_cycle_count() - tx_deadline) > (int32_t)cycles) {
+        tx_deadline = esp_cpu_get_cycle_count();
+    }
+    tx_deadline += cycles;
+    tx_wait_until(tx_deadline);
+}
+
+// Синхропоследовательность send_sync_seq() полной шкалой ЦАП. Вторая половина паузы уже на смещении OFDM:
+// приёмник определяет начало паузы, а светодиод успевает выйти на рабочую точку до первого пилота
+static void dac_send_sync_seq(void) {
+    const uint32_t half_cycles = SYNC_HALF_PERIOD_US * TX_CYCLES_PER_US;
+    for (int i = 0; i < 4; ++i) {
+        dac_level(255, half_cycles);
+        dac_level(0, half_cycles);
+    }
+    for (int i = 0; i < 4; ++i) {
+        dac_level(0, half_cycles);
+        dac_level(255, half_cycles);
+    }
+    dac_level(0, half_cycles);
+    dac_level(OFDM_DAC_BIAS, half_cycles);
+    rtc_wdt_feed();
+}
+
+void process_ofdm_data(const uint8_t* data, const int len, const double sampleRate, const ofdm_loading_t* loading) {
+    static uint8_t samples[OFDM_MAX_SAMPLES];
+    const int capacity = ofdm_frame_capacity(loading);
+    if (capacity == 0) {
+        console_write(UART_NUM_0, "OFDM loading carries no data\n\0", 30);
+        return;
+    }
+    uint32_t sample_cycles = (uint32_t)(TX_CYCLES_PER_US * 1000000.0 / sampleRate);
+    if (sample_cycles < 1) sample_cycles = 1;
+    if (!ofdm_dac) {
+        const dac_oneshot_config_t dac_config = {.chan_id = OFDM_DAC_CHANNEL};
+        if (dac_oneshot_new_channel(&dac_config, &ofdm_dac) != ESP_OK) {
+            ofdm_dac = NULL;
+            console_write(UART_NUM_0, "OFDM DAC unavailable\n\0", 22);
+            return;
+        }
+    }
+    for (int offset = 0; offset < len; offset += capacity) {
+        const int chunk = len - offset < capacity ? len - offset : capacity;
+        const int count = ofdm_modulate(loading, data + offset, chunk, samples);
+        tx_timebase_start();
+        dac_send_sync_seq();
+        for (int i = 0; i < count; ++i) {
+            dac_level(samples[i], sample_cycles);
+        }
+        dac_oneshot_output_voltage(ofdm_dac, 0);
+        rtc_wdt_feed();
+    }
+    console_write(UART_NUM_0, "Data sent\n\0", 11);
 }
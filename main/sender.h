@@ -3,7 +3,33 @@
 
 #include <stdint.h>
 
+#include "ofdm.h"
+#include "rates.h"
+
+// Длительность синхропоследовательности: 4 нуля, 4 единицы и пауза по 20 мс на полупериод
+#define SYNC_SEQ_DURATION_US 360000
+// Всё, что передаётся до данных кадра: синхропоследовательность и метка скорости
+#define FRAME_PREAMBLE_US(f) (SYNC_SEQ_DURATION_US + (int64_t)RATE_MARKER_BITS * 1000000 / (f))
+
+// Начало отсчёта абсолютных моментов передачи. send_manchester_frame() вызывает его сама,
+// при передаче отдельными битами - перед первым из них
+void tx_timebase_start(void);
 void send_manchester_bit(int bit, int half_period_us);
+// Передача одного кадра: синхропоследовательность, метка скорости и байты в манчестерском коде
+void send_manchester_frame(const uint8_t* data, int len, double baseFrequency);
 void process_binary_data(const uint8_t* data, int len, double baseFrequency);
+// Передача со свёрточным кодированием, по кадру на каждые FEC_MAX_DATA байт
+void process_fec_data(const uint8_t* data, int len, double baseFrequency);
+
+// Наибольший блок данных одного сжатого кадра
+#define LZSS_FRAME_MAX_DATA 1024
+// Передача со сжатием, флаг в заголовке кадра сообщает приёмнику, сжат ли кадр
+void process_lzss_data(const uint8_t* data, int len, double baseFrequency);
+
+// Передача импульсно-позиционной модуляцией порядка order (4, 8, 16), слот - полупериод манчестерского бита
+void process_ppm_data(const uint8_t* data, int len, double baseFrequency, int order);
+
+// Передача DCO-OFDM через ЦАП, sampleRate отсчётов в секунду, по кадру на каждые ofdm_frame_capacity() байт
+void process_ofdm_data(const uint8_t* data, int len, double sampleRate, const ofdm_loading_t* loading);
 
 #endif
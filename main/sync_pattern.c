@@ -0,0 +1,51 @@
+#include "sync_pattern.h"
+
+#include <stdbool.h>
+
+#include "perf.h"
+
+// Синхронизирующая последовательность: 1,0,1,0,1,0,1,0,0,1,0,1,0,1,0,0
+static LIFI_HOT_DATA const int pattern[PATTERN_LENGTH] = {1, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 1};
+
+LIFI_HOT void shift_left_and_append_int(int arr[], const int size, const int new_value) {
+    for (int i = 0; i < size - 1; ++i) {
+        arr[i] = arr[i + 1]; // Сдвигаем влево
+    }
+    arr[size - 1] = new_value; // Добавляем новое значение в конец
+}
+
+LIFI_HOT void shift_left_and_append_double(double arr[], const int size, const double new_value) {
+    for (int i = 0; i < size - 1; ++i) {
+        arr[i] = arr[i + 1]; // Сдвигаем влево
+    }
+    arr[size - 1] = new_value; // Добавляем новое значение в конец
+}
+
+// Функция определения бита по среднему значению измерений (для стабильности на низкой частоте синхронизации)
+LIFI_HOT double avg_bin_of_buffer(const int arr[], const int size, const int analogue_threshold) {
+    long long int sum = 0;
+    int count = 0;
+    for (int i = 0; i < size; ++i) {
+        if (arr[i] != -1) {
+            sum += arr[i];
+            ++count;
+        }
+    }
+    return sum * 1.0 / count / analogue_threshold;
+}
+
+LIFI_HOT int match_sync_pattern(const double sync_buffer[SYNC_BUFFER_LENGTH]) {
+    for (int i = SYNC_BUFFER_LENGTH - 1; i >= 0; --i) {
+        if ((pattern[i] >= 1) != (sync_buffer[i] >= 1)) {
+            // printf("Incorrect\r\n");
+            return false;
+        }
+        if (sync_buffer[i] == -1 && (SYNC_BUFFER_LENGTH - i) > MIN_SYNC_BITS) {
+            // printf("Correct suffix\r\n");
+            return true;
+        }
+    }
+
+    // printf("All correct\r\n");
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef SYNC_PATTERN_H
+#define SYNC_PATTERN_H
+
+// Распознавание синхропоследовательности без обращения к АЦП: используется циклом await_end_sync()
+// и собирается на хосте для замеров
+
+// Размер битового буфера для синхронизации
+#define SYNC_BUFFER_LENGTH 16
+// Полная длина синхронизирующей последовательности
+#define PATTERN_LENGTH 16
+// Минимальное число бит для проверки совпадения (например, если первые биты утеряны)
+#define MIN_SYNC_BITS 10
+
+void shift_left_and_append_int(int arr[], int size, int new_value);
+
+void shift_left_and_append_double(double arr[], int size, double new_value);
+
+// Среднее буфера отсчётов по отношению к порогу: не меньше единицы - высокий уровень
+double avg_bin_of_buffer(const int arr[], int size, int analogue_threshold);
+
+// Совпадение накопленных битов с шаблоном синхропоследовательности (допускается потеря первых битов, они равны -1)
+int match_sync_pattern(const double sync_buffer[SYNC_BUFFER_LENGTH]);
+
+#endif //SYNC_PATTERN_H
@@ -8,24 +8,19 @@
 #include <hal/wdt_hal.h>
 #include <rom/ets_sys.h>
 
+#include "bufpool.h"
+#include "console.h"
+#include "perf.h"
+
 // 200 мс в микросекундах
 #define TIMEOUT_US 200000
-// Размер битового буфера для синхронизации
-#define SYNC_BUFFER_LENGTH 16
-// Полная длина синхронизирующей последовательности
-#define PATTERN_LENGTH 16
-// Минимальное число бит для проверки совпадения (например, если первые биты утеряны)
-#define MIN_SYNC_BITS 10
 // Размер буфера сканирования для усреднения
 #define READ_BUFFER_LENGTH 10
 // Максимальный период для одного бита в микросекундах
 #define MAX_STABLE_DURATION 30000
 #define SYNC_DELAY          40000
 
-// Синхронизирующая последовательность: 1,0,1,0,1,0,1,0,0,1,0,1,0,1,0,0
-const int pattern[PATTERN_LENGTH] = {1, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 1};
-
-int read_avg(const int length_us, const int analogue_threshold) {
+LIFI_HOT int read_avg(const int length_us, const int analogue_threshold) {
     long long int sum = 0;
     int count = 0;
     for (int i = 0; i < length_us; ++i) {
@@ -37,57 +32,47 @@ int read_avg(const int length_us, const int analogue_threshold) {
     return (sum / count) > analogue_threshold;
 }
 
-void shift_left_and_append_int(int arr[], const int size, const int new_value) {
-    for (int i = 0; i < size - 1; ++i) {
-        arr[i] = arr[i + 1]; // Сдвигаем влево
-    }
-    arr[size - 1] = new_value; // Добавляем новое значение в конец
-}
-
-void shift_left_and_append_double(double arr[], const int size, const double new_value) {
-    for (int i = 0; i < size - 1; ++i) {
-        arr[i] = arr[i + 1]; // Сдвигаем влево
-    }
-    arr[size - 1] = new_value; // Добавляем новое значение в конец
-}
-
-// Функция определения бита по среднему значению измерений (для стабильности на низкой частоте синхронизации)
-double avg_bin_of_buffer(const int arr[], const int size, const int analogue_threshold) {
-    long long int sum = 0;
-    int count = 0;
-    for (int i = 0; i < size; ++i) {
-        if (arr[i] != -1) {
-            sum += arr[i];
-            ++count;
-        }
-    }
-    return sum * 1.0 / count / analogue_threshold;
-}
-
-static char console_buffer[1024]; // Глобальный буфер (можно изменить размер по необходимости)
-
+// Отладочный вывод массивов: строка собирается в блоке пула и сразу возвращается
 void print_int_array(double arr[], const int size) {
+    bufpool_frame_t* line = bufpool_acquire();
+    if (!line) {
+        return;
+    }
+    char* text = (char*)line->data;
     int offset = 0;
-    for (int i = 0; i < size; i++) {
-        offset += snprintf(console_buffer + offset, sizeof(console_buffer) - offset, "%.02f ", arr[i]);
+    for (int i = 0; i < size && offset < BUFPOOL_BLOCK_SIZE - 3; i++) {
+        offset += snprintf(text + offset, BUFPOOL_BLOCK_SIZE - 3 - offset, "%.02f ", arr[i]);
+    }
+    if (offset > BUFPOOL_BLOCK_SIZE - 3) {
+        offset = BUFPOOL_BLOCK_SIZE - 3;
     }
-    console_buffer[offset] = '\r'; // Перевод строки с помощью \r\n
-    console_buffer[offset + 1] = '\n';
-    console_buffer[offset + 2] = '\0'; // Завершающий нулевой символ
+    text[offset] = '\r'; // Перевод строки с помощью \r\n
+    text[offset + 1] = '\n';
+    text[offset + 2] = '\0'; // Завершающий нулевой символ
 
-    uart_write_bytes(UART_NUM_0, console_buffer, strlen(console_buffer));
+    console_write(UART_NUM_0, text, strlen(text));
+    bufpool_release(line);
 }
 
 void print_double_array(int arr[], const int size) {
+    bufpool_frame_t* line = bufpool_acquire();
+    if (!line) {
+        return;
+    }
+    char* text = (char*)line->data;
     int offset = 0;
-    for (int i = 0; i < size; i++) {
-        offset += snprintf(console_buffer + offset, sizeof(console_buffer) - offset, "%4d ", arr[i]);
+    for (int i = 0; i < size && offset < BUFPOOL_BLOCK_SIZE - 3; i++) {
+        offset += snprintf(text + offset, BUFPOOL_BLOCK_SIZE - 3 - offset, "%4d ", arr[i]);
+    }
+    if (offset > BUFPOOL_BLOCK_SIZE - 3) {
+        offset = BUFPOOL_BLOCK_SIZE - 3;
     }
-    console_buffer[offset] = '\r'; // Перевод строки с помощью \r\n
-    console_buffer[offset + 1] = '\n';
-    console_buffer[offset + 2] = '\0'; // Завершающий нулевой символ
+    text[offset] = '\r'; // Перевод строки с помощью \r\n
+    text[offset + 1] = '\n';
+    text[offset + 2] = '\0'; // Завершающий нулевой символ
 
-    uart_write_bytes(UART_NUM_0, console_buffer, strlen(console_buffer));
+    console_write(UART_NUM_0, text, strlen(text));
+    bufpool_release(line);
 }
 
 static double sync_buffer[SYNC_BUFFER_LENGTH];
@@ -99,20 +84,8 @@ void clear_read_buffer(void) {
     }
 }
 
-int check_buffers() {
-    for (int i = SYNC_BUFFER_LENGTH - 1; i >= 0; --i) {
-        if ((pattern[i] >= 1) != (sync_buffer[i] >= 1)) {
-            // printf("Incorrect\r\n");
-            return false;
-        }
-        if (sync_buffer[i] == -1 && (SYNC_BUFFER_LENGTH - i) > MIN_SYNC_BITS) {
-            // printf("Correct suffix\r\n");
-            return true;
-        }
-    }
-
-    // printf("All correct\r\n");
-    return true;
+LIFI_HOT int check_buffers() {
+    return match_sync_pattern(sync_buffer);
 }
 
 void init_synchronizer() {
@@ -122,9 +95,9 @@ void init_synchronizer() {
 }
 
 // Функция ожидающая паттерн стартовой последовательности перед каждым сообщением
-// При обнаружении таковой в течение TIMEOUT_US мкс сразу же возвращает 1
+// При обнаружении таковой в течение timeout_us мкс сразу же возвращает 1
 // При не обнаружении - 0
-int await_end_sync(const int analogue_threshold) {
+LIFI_HOT int await_end_sync(const int analogue_threshold, const int64_t timeout_us) {
     clear_read_buffer();
 
     // int time = 0;
@@ -153,13 +126,13 @@ int await_end_sync(const int analogue_threshold) {
 
                 // char console_buffer[32];
                 // snprintf(console_buffer, sizeof(console_buffer), "Delay %6lld / %6d \r\n", diff, MAX_STABLE_DURATION);
-                // uart_write_bytes(UART_NUM_0, console_buffer, strlen(console_buffer));
+                // console_write(UART_NUM_0, console_buffer, strlen(console_buffer));
             }
             // print_int_array(sync_buffer, SYNC_BUFFER_LENGTH);
             // print_double_array(read_buffer, READ_BUFFER_LENGTH);
             stable_duration_start = esp_timer_get_time();
             // const char* aaa = "\r\n\0";
-            // uart_write_bytes(UART_NUM_0, aaa, strlen(aaa));
+            // console_write(UART_NUM_0, aaa, strlen(aaa));
             last_bit = bin_of_buffer;
             clear_read_buffer();
             filled_count = 0;
@@ -174,8 +147,29 @@ int await_end_sync(const int analogue_threshold) {
             }
         }
 
-        if (esp_timer_get_time() - start_time > 2000000) {
+        if (esp_timer_get_time() - start_time > timeout_us) {
+            return 0;
+        }
+    }
+}
+
+LIFI_HOT int await_rate_marker(const int analogue_threshold, const int64_t timeout_us, rate_marker_t* marker, eq_t* eq) {
+    const int first = adc1_get_raw(ADC1_CHANNEL_4);
+    rate_marker_start(marker, analogue_threshold, eq ? eq_apply(eq, first) : first);
+    const int64_t start_time = esp_timer_get_time();
+    while (1) {
+        rtc_wdt_feed();
+        const int64_t now = esp_timer_get_time();
+        const int raw = adc1_get_raw(ADC1_CHANNEL_4);
+        if (rate_marker_feed(marker, now, eq ? eq_apply(eq, raw) : raw)) {
+            return 1;
+        }
+        if (now - start_time > timeout_us) {
             return 0;
         }
+        // Эквалайзер обучен на шаге отсчётов цикла приёма
+        if (eq) {
+            ets_delay_us(10);
+        }
     }
 }
@@ -1,7 +1,24 @@
 #ifndef SYNCHRONIZER_H
 #define SYNCHRONIZER_H
 
-int await_end_sync(int analogue_threshold);
+#include <stdint.h>
+
+#include "eq.h"
+#include "rates.h"
+#include "sync_pattern.h"
+
+// Пауза в конце синхропоследовательности (полубит -1 длиной в два полупериода синхронизации).
+// await_end_sync() возвращается в её начале, данные начинаются после неё
+#define SYNC_TAIL_US 40000
+
+// Совпадение накопленных битов с шаблоном синхропоследовательности (допускается потеря первых битов)
+int check_buffers(void);
+
+int await_end_sync(int analogue_threshold, int64_t timeout_us);
+
+// Ожидание фронтов метки скорости после синхропоследовательности. eq - эквалайзер приёма или NULL
+// Возвращает 1, если найдены все фронты за timeout_us
+int await_rate_marker(int analogue_threshold, int64_t timeout_us, rate_marker_t* marker, eq_t* eq);
 
 void init_synchronizer(void);
 
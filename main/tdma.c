@@ -0,0 +1,115 @@
+#include "tdma.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+// Полезная нагрузка маяка: номер суперкадра, длительность слота в мс (2 байта), число слотов, владельцы слотов
+#define TDMA_BEACON_FIXED 4
+
+int tdma_build_frame(
+    uint8_t* out, const uint8_t type, const uint8_t src, const uint8_t dst,
+    const uint8_t* payload, const int len
+) {
+    out[0] = type;
+    out[1] = src;
+    out[2] = dst;
+    out[3] = len;
+    memcpy(out + TDMA_HEADER_SIZE, payload, len);
+    const uint16_t crc = crc16_ccitt(out, TDMA_HEADER_SIZE + len);
+    out[TDMA_HEADER_SIZE + len] = crc >> 8;
+    out[TDMA_HEADER_SIZE + len + 1] = crc & 0xFF;
+    return TDMA_HEADER_SIZE + len + TDMA_CRC_SIZE;
+}
+
+int tdma_parse_frame(const uint8_t* frame, const int len, tdma_frame_t* parsed) {
+    if (len < TDMA_HEADER_SIZE + TDMA_CRC_SIZE) {
+        return 0;
+    }
+    const int payload = frame[3];
+    if (payload > TDMA_MAX_PAYLOAD || TDMA_HEADER_SIZE + payload + TDMA_CRC_SIZE > len) {
+        return 0;
+    }
+    const uint16_t crc = crc16_ccitt(frame, TDMA_HEADER_SIZE + payload);
+    if (frame[TDMA_HEADER_SIZE + payload] != (crc >> 8) || frame[TDMA_HEADER_SIZE + payload + 1] != (crc & 0xFF)) {
+        return 0;
+    }
+    parsed->type = frame[0];
+    parsed->src = frame[1];
+    parsed->dst = frame[2];
+    parsed->len = payload;
+    parsed->payload = frame + TDMA_HEADER_SIZE;
+    return 1;
+}
+
+int tdma_build_beacon(uint8_t* out, const uint8_t coordinator, const tdma_schedule_t* schedule) {
+    uint8_t payload[TDMA_BEACON_FIXED + TDMA_MAX_SLOTS];
+    const int slot_ms = schedule->slot_us / 1000;
+    payload[0] = schedule->seq;
+    payload[1] = slot_ms >> 8;
+    payload[2] = slot_ms & 0xFF;
+    payload[3] = schedule->slots;
+    memcpy(payload + TDMA_BEACON_FIXED, schedule->owners, schedule->slots);
+    return tdma_build_frame(out, TDMA_TYPE_BEACON, coordinator, TDMA_BROADCAST, payload, TDMA_BEACON_FIXED + schedule->slots);
+}
+
+int tdma_parse_beacon(const tdma_frame_t* frame, tdma_schedule_t* schedule) {
+    if (frame->type != TDMA_TYPE_BEACON || frame->len < TDMA_BEACON_FIXED) {
+        return 0;
+    }
+    const uint8_t* payload = frame->payload;
+    const int slots = payload[3];
+    if (slots > TDMA_MAX_SLOTS || frame->len != TDMA_BEACON_FIXED + slots) {
+        return 0;
+    }
+    schedule->seq = payload[0];
+    schedule->slot_us = (payload[1] << 8 | payload[2]) * 1000;
+    schedule->slots = slots;
+    memset(schedule->owners, 0, sizeof(schedule->owners));
+    memcpy(schedule->owners, payload + TDMA_BEACON_FIXED, slots);
+    return 1;
+}
+
+int tdma_slot_of(const tdma_schedule_t* schedule, const uint8_t node) {
+    for (int i = 0; i < schedule->slots; ++i) {
+        if (schedule->owners[i] == node) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+int tdma_assign(tdma_schedule_t* schedule, const uint8_t node) {
+    const int slot = tdma_slot_of(schedule, node);
+    if (slot > 0) {
+        return slot;
+    }
+    if (schedule->slots >= TDMA_MAX_SLOTS) {
+        return -1;
+    }
+    schedule->owners[schedule->slots++] = node;
+    return schedule->slots;
+}
+
+int64_t tdma_slot_offset_us(const tdma_schedule_t* schedule, const int slot) {
+    return (int64_t)slot * schedule->slot_us;
+}
+
+int64_t tdma_superframe_us(const tdma_schedule_t* schedule) {
+    return (int64_t)(schedule->slots + 1) * schedule->slot_us;
+}
+
+int tdma_slot_capacity(
+    const tdma_schedule_t* schedule, const int frequency,
+    const int64_t preamble_us, const int64_t end_silence_us
+) {
+    const int64_t airtime = schedule->slot_us - 2 * TDMA_GUARD_US - preamble_us - end_silence_us;
+    if (airtime <= 0) {
+        return 0;
+    }
+    const int64_t bytes = airtime * frequency / 8000000 - TDMA_HEADER_SIZE - TDMA_CRC_SIZE;
+    if (bytes <= 0) {
+        return 0;
+    }
+    return bytes < TDMA_MAX_PAYLOAD ? (int)bytes : TDMA_MAX_PAYLOAD;
+}
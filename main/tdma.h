@@ -0,0 +1,64 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdint.h>
+
+// Адрес "всем" и наибольшее число слотов данных в суперкадре
+#define TDMA_BROADCAST 0xFF
+#define TDMA_MAX_SLOTS 8
+
+// Заголовок кадра: тип, адрес отправителя, адрес получателя, длина
+#define TDMA_HEADER_SIZE 4
+#define TDMA_CRC_SIZE 2
+#define TDMA_MAX_PAYLOAD 200
+#define TDMA_MAX_FRAME (TDMA_HEADER_SIZE + TDMA_MAX_PAYLOAD + TDMA_CRC_SIZE)
+
+#define TDMA_TYPE_BEACON 'B'
+#define TDMA_TYPE_JOIN 'J'
+#define TDMA_TYPE_DATA 'T'
+
+// Защитный интервал в начале и в конце слота: расхождение часов узлов и задержка обнаружения конца маяка
+#define TDMA_GUARD_US 20000
+
+typedef struct {
+    uint8_t type;
+    uint8_t src;
+    uint8_t dst;
+    int len;
+    const uint8_t* payload;
+} tdma_frame_t;
+
+// Расписание суперкадра: маяк, слот 0 для запросов подключения (с состязанием), слоты 1..slots - узлам owners[]
+typedef struct {
+    uint8_t seq;
+    int slot_us;
+    int slots;
+    uint8_t owners[TDMA_MAX_SLOTS];
+} tdma_schedule_t;
+
+// Возвращает длину кадра
+int tdma_build_frame(uint8_t* out, uint8_t type, uint8_t src, uint8_t dst, const uint8_t* payload, int len);
+
+// Проверка длины и CRC, 1 если кадр цел
+int tdma_parse_frame(const uint8_t* frame, int len, tdma_frame_t* parsed);
+
+int tdma_build_beacon(uint8_t* out, uint8_t coordinator, const tdma_schedule_t* schedule);
+
+// Расписание из маяка, 1 если кадр - корректный маяк
+int tdma_parse_beacon(const tdma_frame_t* frame, tdma_schedule_t* schedule);
+
+// Координатор: слот для узла (уже выданный или первый свободный), -1 если слотов нет
+int tdma_assign(tdma_schedule_t* schedule, uint8_t node);
+
+// Слот узла по расписанию, -1 если не назначен
+int tdma_slot_of(const tdma_schedule_t* schedule, uint8_t node);
+
+// Начало слота относительно начала суперкадра (конца маяка) и длительность суперкадра после маяка
+int64_t tdma_slot_offset_us(const tdma_schedule_t* schedule, int slot);
+int64_t tdma_superframe_us(const tdma_schedule_t* schedule);
+
+// Сколько байт полезной нагрузки помещается в слот с учётом защитных интервалов,
+// синхропоследовательности и тишины, по которой приёмник находит конец кадра
+int tdma_slot_capacity(const tdma_schedule_t* schedule, int frequency, int64_t preamble_us, int64_t end_silence_us);
+
+#endif //TDMA_H
@@ -124,4 +124,15 @@ int calc_median(const int arr[], int size) {
 
     free(copy1);
     return result;
-}
\ No newline at end of file
+}
+// Побитовый расчёт CRC-16/CCITT: кадры короткие, таблица не нужна
+uint16_t crc16_ccitt(const uint8_t* data, const int len) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -9,6 +9,11 @@
 
 // double avg_bin_of_buffer(const int arr[], int size, int analogue_threshold);
 
+#include <stdint.h>
+
 int calc_median(const int arr[], const int size);
 
+// CRC-16/CCITT-FALSE (полином 0x1021, начальное значение 0xFFFF)
+uint16_t crc16_ccitt(const uint8_t* data, int len);
+
 #endif //UTILS_H
@@ -54,6 +54,26 @@ esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t
  */
 esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+/**
+ * @brief Set a run of pixels from a contiguous color buffer
+ *
+ * @note The buffer holds 3 bytes per pixel in GRB order, or 4 bytes per pixel in GRBW order for LED_PIXEL_FORMAT_GRBW,
+ *       i.e. the same order the LEDs receive on the wire. The whole run is encoded in one pass, which is much cheaper
+ *       than calling `led_strip_set_pixel` for every pixel of a long strip.
+ *
+ * @param strip: LED strip
+ * @param start_index: index of the first pixel to set
+ * @param pixels: color bytes of the pixels
+ * @param num_pixels: number of pixels in the buffer
+ *
+ * @return
+ *      - ESP_OK: Set pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set pixels failed because of invalid parameters
+ *      - ESP_ERR_NOT_SUPPORTED: Set pixels failed because the backend doesn't support it
+ *      - ESP_FAIL: Set pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start_index, const uint8_t *pixels, uint32_t num_pixels);
+
 /**
  * @brief Set HSV for a specific pixel
  *
@@ -84,6 +104,37 @@ esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint
  */
 esp_err_t led_strip_refresh(led_strip_handle_t strip);
 
+/**
+ * @brief Start refreshing memory colors to LEDs without blocking
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_ERR_NOT_SUPPORTED: Refresh failed because the backend doesn't support asynchronous refresh
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ *
+ * @note:
+ *      The strip keeps two pixel buffers. The frame being sent is handed to the peripheral and the pixels written after
+ *      this call go to the other buffer, which starts as a copy of the frame just sent. A new call waits for the previous
+ *      refresh to finish. Use `led_strip_wait_done` before relying on the LEDs showing the frame.
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+
+/**
+ * @brief Wait for the refresh started by `led_strip_refresh_async` to finish
+ *
+ * @param strip: LED strip
+ * @param timeout_ms: timeout value in milliseconds, -1 to wait forever
+ *
+ * @return
+ *      - ESP_OK: No refresh is in progress any more
+ *      - ESP_ERR_TIMEOUT: The refresh is still in progress after the timeout
+ *      - ESP_ERR_NOT_SUPPORTED: The backend doesn't support asynchronous refresh
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_wait_done(led_strip_handle_t strip, int32_t timeout_ms);
+
 /**
  * @brief Clear LED strip (turn off all LEDs)
  *
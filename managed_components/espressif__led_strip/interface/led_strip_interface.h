@@ -51,6 +51,21 @@ struct led_strip_t {
      */
     esp_err_t (*set_pixel_rgbw)(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+    /**
+     * @brief Set a run of pixels from a contiguous color buffer
+     *
+     * @param strip: LED strip
+     * @param start_index: index of the first pixel to set
+     * @param pixels: color bytes in the strip order, GRB (or GRBW) per pixel
+     * @param num_pixels: number of pixels in the buffer
+     *
+     * @return
+     *      - ESP_OK: Set pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set pixels failed because the range exceeds the strip length
+     *      - ESP_FAIL: Set pixels failed because other error occurred
+     */
+    esp_err_t (*set_pixels)(led_strip_t *strip, uint32_t start_index, const uint8_t *pixels, uint32_t num_pixels);
+
     /**
      * @brief Refresh memory colors to LEDs
      *
@@ -66,6 +81,34 @@ struct led_strip_t {
      */
     esp_err_t (*refresh)(led_strip_t *strip);
 
+    /**
+     * @brief Start flushing memory colors to LEDs without waiting for the transmission to finish
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - ESP_OK: Refresh started successfully
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note:
+     *      The frame is sent from a second pixel buffer, so the next frame can be composed while this one is on the wire.
+     *      If a previous refresh is still in progress, this call waits for it first.
+     */
+    esp_err_t (*refresh_async)(led_strip_t *strip);
+
+    /**
+     * @brief Wait for the refresh started by `refresh_async` to finish
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value in milliseconds, -1 to wait forever
+     *
+     * @return
+     *      - ESP_OK: No refresh is in progress any more
+     *      - ESP_ERR_TIMEOUT: The refresh is still in progress after the timeout
+     *      - ESP_FAIL: Wait failed because some other error occurred
+     */
+    esp_err_t (*wait_done)(led_strip_t *strip, int32_t timeout_ms);
+
     /**
      * @brief Clear LED strip (turn off all LEDs)
      *
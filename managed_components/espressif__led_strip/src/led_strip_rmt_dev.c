@@ -30,7 +30,10 @@ typedef struct {
     rmt_encoder_handle_t strip_encoder;
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
-    uint8_t pixel_buf[];
+    bool tx_busy;       // a refresh is in progress, tx_buf is owned by the RMT driver
+    uint8_t *pixel_buf; // buffer the pixels are composed in
+    uint8_t *tx_buf;    // buffer of the frame on the wire
+    uint8_t buffers[];
 } led_strip_rmt_obj;
 
 static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
@@ -62,21 +65,61 @@ static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index
     return ESP_OK;
 }
 
-static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+static esp_err_t led_strip_rmt_set_pixels(led_strip_t *strip, uint32_t start_index, const uint8_t *pixels, uint32_t num_pixels)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start_index < rmt_strip->strip_len && num_pixels <= rmt_strip->strip_len - start_index,
+                        ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    // The pixel buffer already holds the wire order, the RMT encoder expands the bits on the fly
+    memcpy(rmt_strip->pixel_buf + start_index * rmt_strip->bytes_per_pixel, pixels, num_pixels * rmt_strip->bytes_per_pixel);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_wait_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    if (!rmt_strip->tx_busy) {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, timeout_ms), TAG, "flush RMT channel failed");
+    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+    rmt_strip->tx_busy = false;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh_async(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    size_t frame_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
     rmt_transmit_config_t tx_conf = {
         .loop_count = 0,
     };
 
+    // the buffer of the previous frame is reused for composing, so it must leave the wire first
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_done(strip, -1), TAG, "wait previous refresh failed");
     ESP_RETURN_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), TAG, "enable RMT channel failed");
-    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
-                                     rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), TAG, "transmit pixels by RMT failed");
-    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
-    ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
+
+    uint8_t *frame = rmt_strip->pixel_buf;
+    esp_err_t ret = rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, frame, frame_size, &tx_conf);
+    if (ret != ESP_OK) {
+        rmt_disable(rmt_strip->rmt_chan);
+        ESP_LOGE(TAG, "transmit pixels by RMT failed");
+        return ret;
+    }
+    rmt_strip->tx_busy = true;
+    rmt_strip->pixel_buf = rmt_strip->tx_buf;
+    rmt_strip->tx_buf = frame;
+    // continue composing on top of the frame just sent, while it is being transmitted
+    memcpy(rmt_strip->pixel_buf, frame, frame_size);
     return ESP_OK;
 }
 
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "refresh failed");
+    return led_strip_rmt_wait_done(strip, -1);
+}
+
 static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
@@ -88,6 +131,7 @@ static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
 static esp_err_t led_strip_rmt_del(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_done(strip, -1), TAG, "wait refresh done failed");
     ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
     ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
     free(rmt_strip);
@@ -108,8 +152,11 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     } else {
         assert(false);
     }
-    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel);
+    // two pixel buffers: one is composed while the other is transmitted
+    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel * 2);
     ESP_GOTO_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for rmt strip");
+    rmt_strip->pixel_buf = rmt_strip->buffers;
+    rmt_strip->tx_buf = rmt_strip->buffers + led_config->max_leds * bytes_per_pixel;
     uint32_t resolution = rmt_config->resolution_hz ? rmt_config->resolution_hz : LED_STRIP_RMT_DEFAULT_RESOLUTION;
 
     // for backward compatibility, if the user does not set the clk_src, use the default value
@@ -144,7 +191,10 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     rmt_strip->strip_len = led_config->max_leds;
     rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
     rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+    rmt_strip->base.set_pixels = led_strip_rmt_set_pixels;
     rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
+    rmt_strip->base.wait_done = led_strip_rmt_wait_done;
     rmt_strip->base.clear = led_strip_rmt_clear;
     rmt_strip->base.del = led_strip_rmt_del;
 
@@ -43,7 +43,10 @@ typedef struct {
     rmt_channel_t rmt_channel;
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
-    uint8_t buffer[0];
+    bool tx_busy;       // a refresh is in progress, tx_buf is owned by the RMT driver
+    uint8_t *buffer;    // buffer the pixels are composed in
+    uint8_t *tx_buf;    // buffer of the frame on the wire
+    uint8_t buffers[0];
 } led_strip_rmt_obj;
 
 static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
@@ -93,15 +96,51 @@ static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uin
     return ESP_OK;
 }
 
-static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+static esp_err_t led_strip_rmt_set_pixels(led_strip_t *strip, uint32_t start_index, const uint8_t *pixels, uint32_t num_pixels)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
-    ESP_RETURN_ON_ERROR(rmt_write_sample(rmt_strip->rmt_channel, rmt_strip->buffer, rmt_strip->strip_len * rmt_strip->bytes_per_pixel, true), TAG,
-                        "transmit RMT samples failed");
+    ESP_RETURN_ON_FALSE(start_index < rmt_strip->strip_len && num_pixels <= rmt_strip->strip_len - start_index,
+                        ESP_ERR_INVALID_ARG, TAG, "pixel range out of the maximum number of leds");
+    memcpy(rmt_strip->buffer + start_index * rmt_strip->bytes_per_pixel, pixels, num_pixels * rmt_strip->bytes_per_pixel);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_wait_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    if (!rmt_strip->tx_busy) {
+        return ESP_OK;
+    }
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    ESP_RETURN_ON_ERROR(rmt_wait_tx_done(rmt_strip->rmt_channel, ticks), TAG, "wait RMT samples done failed");
     vTaskDelay(pdMS_TO_TICKS(LED_STRIP_RESET_MS));
+    rmt_strip->tx_busy = false;
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_refresh_async(led_strip_t *strip)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    size_t frame_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
+    // the buffer of the previous frame is reused for composing, so it must leave the wire first
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_done(strip, -1), TAG, "wait previous refresh failed");
+    uint8_t *frame = rmt_strip->buffer;
+    ESP_RETURN_ON_ERROR(rmt_write_sample(rmt_strip->rmt_channel, frame, frame_size, false), TAG,
+                        "transmit RMT samples failed");
+    rmt_strip->tx_busy = true;
+    rmt_strip->buffer = rmt_strip->tx_buf;
+    rmt_strip->tx_buf = frame;
+    // continue composing on top of the frame just sent, while it is being transmitted
+    memcpy(rmt_strip->buffer, frame, frame_size);
     return ESP_OK;
 }
 
+static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_rmt_refresh_async(strip), TAG, "refresh failed");
+    return led_strip_rmt_wait_done(strip, -1);
+}
+
 static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
@@ -113,6 +152,7 @@ static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
 static esp_err_t led_strip_rmt_del(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_rmt_wait_done(strip, -1), TAG, "wait refresh done failed");
     ESP_RETURN_ON_ERROR(rmt_driver_uninstall(rmt_strip->rmt_channel), TAG, "uninstall RMT driver failed");
     free(rmt_strip);
     return ESP_OK;
@@ -135,9 +175,11 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
         assert(false);
     }
 
-    // allocate memory for led_strip object
-    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel);
+    // allocate memory for led_strip object, with two pixel buffers: one is composed while the other is transmitted
+    rmt_strip = calloc(1, sizeof(led_strip_rmt_obj) + led_config->max_leds * bytes_per_pixel * 2);
     ESP_RETURN_ON_FALSE(rmt_strip, ESP_ERR_NO_MEM, TAG, "request memory for les_strip failed");
+    rmt_strip->buffer = rmt_strip->buffers;
+    rmt_strip->tx_buf = rmt_strip->buffers + led_config->max_leds * bytes_per_pixel;
 
     // install RMT channel driver
     rmt_config_t config = RMT_DEFAULT_CONFIG_TX(led_config->strip_gpio_num, dev_config->rmt_channel);
@@ -179,7 +221,10 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     rmt_strip->rmt_channel = (rmt_channel_t)dev_config->rmt_channel;
     rmt_strip->strip_len = led_config->max_leds;
     rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
+    rmt_strip->base.set_pixels = led_strip_rmt_set_pixels;
     rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.refresh_async = led_strip_rmt_refresh_async;
+    rmt_strip->base.wait_done = led_strip_rmt_wait_done;
     rmt_strip->base.clear = led_strip_rmt_clear;
     rmt_strip->base.del = led_strip_rmt_del;
 
@@ -12,12 +12,13 @@
 #include "soc/spi_periph.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
+#include "led_strip_spi_encoder.h"
 #include "hal/spi_hal.h"
 
 #define LED_STRIP_SPI_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz resolution
 #define LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE 4
 
-#define SPI_BYTES_PER_COLOR_BYTE 3
+#define SPI_BYTES_PER_COLOR_BYTE LED_STRIP_SPI_BYTES_PER_COLOR_BYTE
 #define SPI_BITS_PER_COLOR_BYTE (SPI_BYTES_PER_COLOR_BYTE * 8)
 
 static const char *TAG = "led_strip_spi";
@@ -28,24 +29,16 @@ typedef struct {
     spi_device_handle_t spi_device;
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
-    uint8_t pixel_buf[];
+    bool tx_busy;                // a refresh is in progress, tx_buf is owned by the SPI driver
+    spi_transaction_t tx_trans;  // transaction of the refresh in progress
+    uint8_t *pixel_buf;          // buffer the pixels are composed in
+    uint8_t *tx_buf;             // buffer of the frame on the wire
+    uint8_t buffers[];
 } led_strip_spi_obj;
 
-// please make sure to zero-initialize the buf before calling this function
-static void __led_strip_spi_bit(uint8_t data, uint8_t *buf)
-{
-    // Each color of 1 bit is represented by 3 bits of SPI, low_level:100 ,high_level:110
-    // So a color byte occupies 3 bytes of SPI.
-    *(buf + 2) |= data & BIT(0) ? BIT(2) | BIT(1) : BIT(2);
-    *(buf + 2) |= data & BIT(1) ? BIT(5) | BIT(4) : BIT(5);
-    *(buf + 2) |= data & BIT(2) ? BIT(7) : 0x00;
-    *(buf + 1) |= BIT(0);
-    *(buf + 1) |= data & BIT(3) ? BIT(3) | BIT(2) : BIT(3);
-    *(buf + 1) |= data & BIT(4) ? BIT(6) | BIT(5) : BIT(6);
-    *(buf + 0) |= data & BIT(5) ? BIT(1) | BIT(0) : BIT(1);
-    *(buf + 0) |= data & BIT(6) ? BIT(4) | BIT(3) : BIT(4);
-    *(buf + 0) |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
-}
+// Each pixel buffer starts on a word boundary, as required for DMA
+#define LED_STRIP_SPI_BUF_SIZE(max_leds, bytes_per_pixel) \
+    ((((max_leds) * (bytes_per_pixel) * SPI_BYTES_PER_COLOR_BYTE) + 3) & ~3)
 
 static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
 {
@@ -53,13 +46,8 @@ static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uin
     ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
     // LED_PIXEL_FORMAT_GRB takes 72bits(9bytes)
     uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
-    memset(spi_strip->pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
-    __led_strip_spi_bit(green, &spi_strip->pixel_buf[start]);
-    __led_strip_spi_bit(red, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE]);
-    __led_strip_spi_bit(blue, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * 2]);
-    if (spi_strip->bytes_per_pixel > 3) {
-        __led_strip_spi_bit(0, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * 3]);
-    }
+    const uint8_t colors[4] = {green & 0xFF, red & 0xFF, blue & 0xFF, 0};
+    led_strip_spi_encode(&spi_strip->pixel_buf[start], colors, spi_strip->bytes_per_pixel);
     return ESP_OK;
 }
 
@@ -71,37 +59,71 @@ static esp_err_t led_strip_spi_set_pixel_rgbw(led_strip_t *strip, uint32_t index
     // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes)
     uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
     // SK6812 component order is GRBW
-    memset(spi_strip->pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
-    __led_strip_spi_bit(green, &spi_strip->pixel_buf[start]);
-    __led_strip_spi_bit(red, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE]);
-    __led_strip_spi_bit(blue, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * 2]);
-    __led_strip_spi_bit(white, &spi_strip->pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * 3]);
+    const uint8_t colors[4] = {green & 0xFF, red & 0xFF, blue & 0xFF, white & 0xFF};
+    led_strip_spi_encode(&spi_strip->pixel_buf[start], colors, 4);
 
     return ESP_OK;
 }
 
-static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+static esp_err_t led_strip_spi_set_pixels(led_strip_t *strip, uint32_t start_index, const uint8_t *pixels, uint32_t num_pixels)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
-    spi_transaction_t tx_conf;
-    memset(&tx_conf, 0, sizeof(tx_conf));
+    ESP_RETURN_ON_FALSE(start_index < spi_strip->strip_len && num_pixels <= spi_strip->strip_len - start_index,
+                        ESP_ERR_INVALID_ARG, TAG, "pixel range out of maximum number of LEDs");
+    uint32_t start = start_index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    led_strip_spi_encode(&spi_strip->pixel_buf[start], pixels, num_pixels * spi_strip->bytes_per_pixel);
+    return ESP_OK;
+}
 
-    tx_conf.length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
-    tx_conf.tx_buffer = spi_strip->pixel_buf;
-    tx_conf.rx_buffer = NULL;
-    ESP_RETURN_ON_ERROR(spi_device_transmit(spi_strip->spi_device, &tx_conf), TAG, "transmit pixels by SPI failed");
+static esp_err_t led_strip_spi_wait_done(led_strip_t *strip, int32_t timeout_ms)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    if (!spi_strip->tx_busy) {
+        return ESP_OK;
+    }
+    spi_transaction_t *done_trans = NULL;
+    TickType_t ticks = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done_trans, ticks), TAG, "wait SPI transaction failed");
+    spi_strip->tx_busy = false;
+    return ESP_OK;
+}
 
+static esp_err_t led_strip_spi_refresh_async(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    size_t frame_size = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+
+    // the buffer of the previous frame is reused for composing, so it must leave the wire first
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_done(strip, -1), TAG, "wait previous refresh failed");
+
+    uint8_t *frame = spi_strip->pixel_buf;
+    memset(&spi_strip->tx_trans, 0, sizeof(spi_strip->tx_trans));
+    spi_strip->tx_trans.length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
+    spi_strip->tx_trans.tx_buffer = frame;
+    spi_strip->tx_trans.rx_buffer = NULL;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, &spi_strip->tx_trans, portMAX_DELAY), TAG, "transmit pixels by SPI failed");
+    spi_strip->tx_busy = true;
+    spi_strip->pixel_buf = spi_strip->tx_buf;
+    spi_strip->tx_buf = frame;
+    // continue composing on top of the frame just sent, while it is being transmitted
+    memcpy(spi_strip->pixel_buf, frame, frame_size);
     return ESP_OK;
 }
 
+static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_spi_refresh_async(strip), TAG, "refresh failed");
+    return led_strip_spi_wait_done(strip, -1);
+}
+
 static esp_err_t led_strip_spi_clear(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
     //Write zero to turn off all leds
-    memset(spi_strip->pixel_buf, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    static const uint8_t zero = 0;
     uint8_t *buf = spi_strip->pixel_buf;
     for (int index = 0; index < spi_strip->strip_len * spi_strip->bytes_per_pixel; index++) {
-        __led_strip_spi_bit(0, buf);
+        led_strip_spi_encode(buf, &zero, 1);
         buf += SPI_BYTES_PER_COLOR_BYTE;
     }
 
@@ -112,6 +134,7 @@ static esp_err_t led_strip_spi_del(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
 
+    ESP_RETURN_ON_ERROR(led_strip_spi_wait_done(strip, -1), TAG, "wait refresh done failed");
     ESP_RETURN_ON_ERROR(spi_bus_remove_device(spi_strip->spi_device), TAG, "delete spi device failed");
     ESP_RETURN_ON_ERROR(spi_bus_free(spi_strip->spi_host), TAG, "free spi bus failed");
 
@@ -138,9 +161,13 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
         // DMA buffer must be placed in internal SRAM
         mem_caps |= MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
     }
-    spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, mem_caps);
+    // two pixel buffers: one is composed while the other is transmitted
+    size_t buf_size = LED_STRIP_SPI_BUF_SIZE(led_config->max_leds, bytes_per_pixel);
+    spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + buf_size * 2, mem_caps);
 
     ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+    spi_strip->pixel_buf = spi_strip->buffers;
+    spi_strip->tx_buf = spi_strip->buffers + buf_size;
 
     spi_strip->spi_host = spi_config->spi_bus;
     // for backward compatibility, if the user does not set the clk_src, use the default value
@@ -191,7 +218,10 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
     spi_strip->strip_len = led_config->max_leds;
     spi_strip->base.set_pixel = led_strip_spi_set_pixel;
     spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw;
+    spi_strip->base.set_pixels = led_strip_spi_set_pixels;
     spi_strip->base.refresh = led_strip_spi_refresh;
+    spi_strip->base.refresh_async = led_strip_spi_refresh_async;
+    spi_strip->base.wait_done = led_strip_spi_wait_done;
     spi_strip->base.clear = led_strip_spi_clear;
     spi_strip->base.del = led_strip_spi_del;
 
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "esp_attr.h"
+#include "led_strip_spi_encoder.h"
+
+// Each color of 1 bit is represented by 3 bits of SPI, low_level:100 ,high_level:110
+// So a color byte occupies 3 bytes of SPI, MSB first. The expansion of every possible color byte is precomputed,
+// so encoding a color byte is a single table lookup instead of nine conditional bit operations.
+static const DRAM_ATTR uint8_t led_strip_spi_lut[256][LED_STRIP_SPI_BYTES_PER_COLOR_BYTE] = {
+    {0x92, 0x49, 0x24}, {0x92, 0x49, 0x26}, {0x92, 0x49, 0x34}, {0x92, 0x49, 0x36},
+    {0x92, 0x49, 0xa4}, {0x92, 0x49, 0xa6}, {0x92, 0x49, 0xb4}, {0x92, 0x49, 0xb6},
+    {0x92, 0x4d, 0x24}, {0x92, 0x4d, 0x26}, {0x92, 0x4d, 0x34}, {0x92, 0x4d, 0x36},
+    {0x92, 0x4d, 0xa4}, {0x92, 0x4d, 0xa6}, {0x92, 0x4d, 0xb4}, {0x92, 0x4d, 0xb6},
+    {0x92, 0x69, 0x24}, {0x92, 0x69, 0x26}, {0x92, 0x69, 0x34}, {0x92, 0x69, 0x36},
+    {0x92, 0x69, 0xa4}, {0x92, 0x69, 0xa6}, {0x92, 0x69, 0xb4}, {0x92, 0x69, 0xb6},
+    {0x92, 0x6d, 0x24}, {0x92, 0x6d, 0x26}, {0x92, 0x6d, 0x34}, {0x92, 0x6d, 0x36},
+    {0x92, 0x6d, 0xa4}, {0x92, 0x6d, 0xa6}, {0x92, 0x6d, 0xb4}, {0x92, 0x6d, 0xb6},
+    {0x93, 0x49, 0x24}, {0x93, 0x49, 0x26}, {0x93, 0x49, 0x34}, {0x93, 0x49, 0x36},
+    {0x93, 0x49, 0xa4}, {0x93, 0x49, 0xa6}, {0x93, 0x49, 0xb4}, {0x93, 0x49, 0xb6},
+    {0x93, 0x4d, 0x24}, {0x93, 0x4d, 0x26}, {0x93, 0x4d, 0x34}, {0x93, 0x4d, 0x36},
+    {0x93, 0x4d, 0xa4}, {0x93, 0x4d, 0xa6}, {0x93, 0x4d, 0xb4}, {0x93, 0x4d, 0xb6},
+    {0x93, 0x69, 0x24}, {0x93, 0x69, 0x26}, {0x93, 0x69, 0x34}, {0x93, 0x69, 0x36},
+    {0x93, 0x69, 0xa4}, {0x93, 0x69, 0xa6}, {0x93, 0x69, 0xb4}, {0x93, 0x69, 0xb6},
+    {0x93, 0x6d, 0x24}, {0x93, 0x6d, 0x26}, {0x93, 0x6d, 0x34}, {0x93, 0x6d, 0x36},
+    {0x93, 0x6d, 0xa4}, {0x93, 0x6d, 0xa6}, {0x93, 0x6d, 0xb4}, {0x93, 0x6d, 0xb6},
+    {0x9a, 0x49, 0x24}, {0x9a, 0x49, 0x26}, {0x9a, 0x49, 0x34}, {0x9a, 0x49, 0x36},
+    {0x9a, 0x49, 0xa4}, {0x9a, 0x49, 0xa6}, {0x9a, 0x49, 0xb4}, {0x9a, 0x49, 0xb6},
+    {0x9a, 0x4d, 0x24}, {0x9a, 0x4d, 0x26}, {0x9a, 0x4d, 0x34}, {0x9a, 0x4d, 0x36},
+    {0x9a, 0x4d, 0xa4}, {0x9a, 0x4d, 0xa6}, {0x9a, 0x4d, 0xb4}, {0x9a, 0x4d, 0xb6},
+    {0x9a, 0x69, 0x24}, {0x9a, 0x69, 0x26}, {0x9a, 0x69, 0x34}, {0x9a, 0x69, 0x36},
+    {0x9a, 0x69, 0xa4}, {0x9a, 0x69, 0xa6}, {0x9a, 0x69, 0xb4}, {0x9a, 0x69, 0xb6},
+    {0x9a, 0x6d, 0x24}, {0x9a, 0x6d, 0x26}, {0x9a, 0x6d, 0x34}, {0x9a, 0x6d, 0x36},
+    {0x9a, 0x6d, 0xa4}, {0x9a, 0x6d, 0xa6}, {0x9a, 0x6d, 0xb4}, {0x9a, 0x6d, 0xb6},
+    {0x9b, 0x49, 0x24}, {0x9b, 0x49, 0x26}, {0x9b, 0x49, 0x34}, {0x9b, 0x49, 0x36},
+    {0x9b, 0x49, 0xa4}, {0x9b, 0x49, 0xa6}, {0x9b, 0x49, 0xb4}, {0x9b, 0x49, 0xb6},
+    {0x9b, 0x4d, 0x24}, {0x9b, 0x4d, 0x26}, {0x9b, 0x4d, 0x34}, {0x9b, 0x4d, 0x36},
+    {0x9b, 0x4d, 0xa4}, {0x9b, 0x4d, 0xa6}, {0x9b, 0x4d, 0xb4}, {0x9b, 0x4d, 0xb6},
+    {0x9b, 0x69, 0x24}, {0x9b, 0x69, 0x26}, {0x9b, 0x69, 0x34}, {0x9b, 0x69, 0x36},
+    {0x9b, 0x69, 0xa4}, {0x9b, 0x69, 0xa6}, {0x9b, 0x69, 0xb4}, {0x9b, 0x69, 0xb6},
+    {0x9b, 0x6d, 0x24}, {0x9b, 0x6d, 0x26}, {0x9b, 0x6d, 0x34}, {0x9b, 0x6d, 0x36},
+    {0x9b, 0x6d, 0xa4}, {0x9b, 0x6d, 0xa6}, {0x9b, 0x6d, 0xb4}, {0x9b, 0x6d, 0xb6},
+    {0xd2, 0x49, 0x24}, {0xd2, 0x49, 0x26}, {0xd2, 0x49, 0x34}, {0xd2, 0x49, 0x36},
+    {0xd2, 0x49, 0xa4}, {0xd2, 0x49, 0xa6}, {0xd2, 0x49, 0xb4}, {0xd2, 0x49, 0xb6},
+    {0xd2, 0x4d, 0x24}, {0xd2, 0x4d, 0x26}, {0xd2, 0x4d, 0x34}, {0xd2, 0x4d, 0x36},
+    {0xd2, 0x4d, 0xa4}, {0xd2, 0x4d, 0xa6}, {0xd2, 0x4d, 0xb4}, {0xd2, 0x4d, 0xb6},
+    {0xd2, 0x69, 0x24}, {0xd2, 0x69, 0x26}, {0xd2, 0x69, 0x34}, {0xd2, 0x69, 0x36},
+    {0xd2, 0x69, 0xa4}, {0xd2, 0x69, 0xa6}, {0xd2, 0x69, 0xb4}, {0xd2, 0x69, 0xb6},
+    {0xd2, 0x6d, 0x24}, {0xd2, 0x6d, 0x26}, {0xd2, 0x6d, 0x34}, {0xd2, 0x6d, 0x36},
+    {0xd2, 0x6d, 0xa4}, {0xd2, 0x6d, 0xa6}, {0xd2, 0x6d, 0xb4}, {0xd2, 0x6d, 0xb6},
+    {0xd3, 0x49, 0x24}, {0xd3, 0x49, 0x26}, {0xd3, 0x49, 0x34}, {0xd3, 0x49, 0x36},
+    {0xd3, 0x49, 0xa4}, {0xd3, 0x49, 0xa6}, {0xd3, 0x49, 0xb4}, {0xd3, 0x49, 0xb6},
+    {0xd3, 0x4d, 0x24}, {0xd3, 0x4d, 0x26}, {0xd3, 0x4d, 0x34}, {0xd3, 0x4d, 0x36},
+    {0xd3, 0x4d, 0xa4}, {0xd3, 0x4d, 0xa6}, {0xd3, 0x4d, 0xb4}, {0xd3, 0x4d, 0xb6},
+    {0xd3, 0x69, 0x24}, {0xd3, 0x69, 0x26}, {0xd3, 0x69, 0x34}, {0xd3, 0x69, 0x36},
+    {0xd3, 0x69, 0xa4}, {0xd3, 0x69, 0xa6}, {0xd3, 0x69, 0xb4}, {0xd3, 0x69, 0xb6},
+    {0xd3, 0x6d, 0x24}, {0xd3, 0x6d, 0x26}, {0xd3, 0x6d, 0x34}, {0xd3, 0x6d, 0x36},
+    {0xd3, 0x6d, 0xa4}, {0xd3, 0x6d, 0xa6}, {0xd3, 0x6d, 0xb4}, {0xd3, 0x6d, 0xb6},
+    {0xda, 0x49, 0x24}, {0xda, 0x49, 0x26}, {0xda, 0x49, 0x34}, {0xda, 0x49, 0x36},
+    {0xda, 0x49, 0xa4}, {0xda, 0x49, 0xa6}, {0xda, 0x49, 0xb4}, {0xda, 0x49, 0xb6},
+    {0xda, 0x4d, 0x24}, {0xda, 0x4d, 0x26}, {0xda, 0x4d, 0x34}, {0xda, 0x4d, 0x36},
+    {0xda, 0x4d, 0xa4}, {0xda, 0x4d, 0xa6}, {0xda, 0x4d, 0xb4}, {0xda, 0x4d, 0xb6},
+    {0xda, 0x69, 0x24}, {0xda, 0x69, 0x26}, {0xda, 0x69, 0x34}, {0xda, 0x69, 0x36},
+    {0xda, 0x69, 0xa4}, {0xda, 0x69, 0xa6}, {0xda, 0x69, 0xb4}, {0xda, 0x69, 0xb6},
+    {0xda, 0x6d, 0x24}, {0xda, 0x6d, 0x26}, {0xda, 0x6d, 0x34}, {0xda, 0x6d, 0x36},
+    {0xda, 0x6d, 0xa4}, {0xda, 0x6d, 0xa6}, {0xda, 0x6d, 0xb4}, {0xda, 0x6d, 0xb6},
+    {0xdb, 0x49, 0x24}, {0xdb, 0x49, 0x26}, {0xdb, 0x49, 0x34}, {0xdb, 0x49, 0x36},
+    {0xdb, 0x49, 0xa4}, {0xdb, 0x49, 0xa6}, {0xdb, 0x49, 0xb4}, {0xdb, 0x49, 0xb6},
+    {0xdb, 0x4d, 0x24}, {0xdb, 0x4d, 0x26}, {0xdb, 0x4d, 0x34}, {0xdb, 0x4d, 0x36},
+    {0xdb, 0x4d, 0xa4}, {0xdb, 0x4d, 0xa6}, {0xdb, 0x4d, 0xb4}, {0xdb, 0x4d, 0xb6},
+    {0xdb, 0x69, 0x24}, {0xdb, 0x69, 0x26}, {0xdb, 0x69, 0x34}, {0xdb, 0x69, 0x36},
+    {0xdb, 0x69, 0xa4}, {0xdb, 0x69, 0xa6}, {0xdb, 0x69, 0xb4}, {0xdb, 0x69, 0xb6},
+    {0xdb, 0x6d, 0x24}, {0xdb, 0x6d, 0x26}, {0xdb, 0x6d, 0x34}, {0xdb, 0x6d, 0x36},
+    {0xdb, 0x6d, 0xa4}, {0xdb, 0x6d, 0xa6}, {0xdb, 0x6d, 0xb4}, {0xdb, 0x6d, 0xb6}
+};
+
+// Encode a run of color bytes into SPI bytes, four color bytes per iteration
+void led_strip_spi_encode(uint8_t *buf, const uint8_t *colors, uint32_t num_bytes)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= num_bytes; i += 4) {
+        memcpy(buf + 0, led_strip_spi_lut[colors[i + 0]], LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        memcpy(buf + 3, led_strip_spi_lut[colors[i + 1]], LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        memcpy(buf + 6, led_strip_spi_lut[colors[i + 2]], LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        memcpy(buf + 9, led_strip_spi_lut[colors[i + 3]], LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        buf += LED_STRIP_SPI_BYTES_PER_COLOR_BYTE * 4;
+    }
+    for (; i < num_bytes; i++) {
+        memcpy(buf, led_strip_spi_lut[colors[i]], LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        buf += LED_STRIP_SPI_BYTES_PER_COLOR_BYTE;
+    }
+}
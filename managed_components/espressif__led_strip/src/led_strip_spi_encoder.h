@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of SPI bytes a color byte is expanded to
+ */
+#define LED_STRIP_SPI_BYTES_PER_COLOR_BYTE 3
+
+/**
+ * @brief Encode color bytes into the SPI bit stream of the LED strip
+ *
+ * @note Each color bit becomes 3 SPI bits, low level 100 and high level 110, MSB first.
+ *       The encoder has no driver dependency, so it can also be built and checked on the host.
+ *
+ * @param[out] buf SPI buffer, at least num_bytes * LED_STRIP_SPI_BYTES_PER_COLOR_BYTE bytes
+ * @param[in] colors Color bytes in wire order
+ * @param[in] num_bytes Number of color bytes
+ */
+void led_strip_spi_encode(uint8_t *buf, const uint8_t *colors, uint32_t num_bytes);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// Host-сборка: размещение кода и данных во внутренней памяти ESP32 не имеет смысла
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif //ESP_ATTR_H
@@ -0,0 +1,7 @@
+#ifndef HAL_UART_TYPES_H
+#define HAL_UART_TYPES_H
+
+// Host-сборка: номер порта UART нужен только в объявлениях
+typedef int uart_port_t;
+
+#endif //HAL_UART_TYPES_H
@@ -0,0 +1,7 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Host-сборка: конфигурация ESP-IDF по умолчанию, профиль производительности выключен
+#define CONFIG_LIFI_PERF_PROFILE 0
+
+#endif //SDKCONFIG_H
@@ -0,0 +1,26 @@
+#ifndef LED_STRIP_SPI_REFERENCE_H
+#define LED_STRIP_SPI_REFERENCE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "led_strip_spi_encoder.h"
+
+#define REFERENCE_BIT(n) (1u << (n))
+
+// Побитовое кодирование из led_strip_spi_dev.c до таблицы (__led_strip_spi_bit): эталон для проверки
+// и замера таблицы
+static inline void reference_spi_bit(const uint8_t data, uint8_t* buf) {
+    memset(buf, 0, LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+    *(buf + 2) |= data & REFERENCE_BIT(0) ? REFERENCE_BIT(2) | REFERENCE_BIT(1) : REFERENCE_BIT(2);
+    *(buf + 2) |= data & REFERENCE_BIT(1) ? REFERENCE_BIT(5) | REFERENCE_BIT(4) : REFERENCE_BIT(5);
+    *(buf + 2) |= data & REFERENCE_BIT(2) ? REFERENCE_BIT(7) : 0x00;
+    *(buf + 1) |= REFERENCE_BIT(0);
+    *(buf + 1) |= data & REFERENCE_BIT(3) ? REFERENCE_BIT(3) | REFERENCE_BIT(2) : REFERENCE_BIT(3);
+    *(buf + 1) |= data & REFERENCE_BIT(4) ? REFERENCE_BIT(6) | REFERENCE_BIT(5) : REFERENCE_BIT(6);
+    *(buf + 0) |= data & REFERENCE_BIT(5) ? REFERENCE_BIT(1) | REFERENCE_BIT(0) : REFERENCE_BIT(1);
+    *(buf + 0) |= data & REFERENCE_BIT(6) ? REFERENCE_BIT(4) | REFERENCE_BIT(3) : REFERENCE_BIT(4);
+    *(buf + 0) |= data & REFERENCE_BIT(7) ? REFERENCE_BIT(7) | REFERENCE_BIT(6) : REFERENCE_BIT(7);
+}
+
+#endif //LED_STRIP_SPI_REFERENCE_H
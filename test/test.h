@@ -0,0 +1,53 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Проверки host-тестов: первая нарушенная печатает место и значения и завершает тест с кодом 1
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                      \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                   \
+    do {                                                                                             \
+        const long long check_actual = (long long)(actual);                                          \
+        const long long check_expected = (long long)(expected);                                      \
+        if (check_actual != check_expected) {                                                        \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %s == %lld\n", __FILE__, __LINE__, #actual, \
+                    check_actual, #expected, check_expected);                                        \
+            exit(1);                                                                                 \
+        }                                                                                            \
+    } while (0)
+
+// Воспроизводимые случайные данные и шум: линейный конгруэнтный генератор, 24 старших бита состояния.
+// Каждый тест - отдельная программа со своим состоянием, test_seed() задаёт начало последовательности
+static uint32_t test_rng_state = 1;
+
+static inline void test_seed(const uint32_t seed) {
+    test_rng_state = seed;
+}
+
+static inline uint32_t test_rng(void) {
+    test_rng_state = test_rng_state * 1103515245u + 12345u;
+    return test_rng_state >> 8;
+}
+
+// Равномерное число в (0, 1)
+static inline double test_uniform(void) {
+    return ((test_rng() & 0xFFFFFF) + 0.5) / 16777216.0;
+}
+
+// Нормальное число с нулевым средним и единичным отклонением (преобразование Бокса - Мюллера)
+static inline double test_gaussian(void) {
+    return sqrt(-2.0 * log(test_uniform())) * cos(2.0 * M_PI * test_uniform());
+}
+
+#endif //TEST_H
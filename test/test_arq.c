@@ -0,0 +1,186 @@
+#include <string.h>
+
+#include "arq.h"
+#include "test.h"
+
+// Полудуплексный канал с потерями: общая очередь кадров в обе стороны, виртуальное время.
+// Приёмник обрабатывает кадры данных, пока отправитель ждёт подтверждения
+#define QUEUE_SIZE 64
+#define FRAME_AIRTIME_US 20000
+
+static uint8_t queue[QUEUE_SIZE][ARQ_MAX_FRAME];
+static int queue_len[QUEUE_SIZE];
+static int queue_head;
+static int queue_tail;
+static int64_t sim_time;
+static int loss_pct;    // Потерянные кадры
+static int corrupt_pct; // Кадры с искажённым байтом
+static int dead;        // Канал не пропускает ничего
+
+static uint8_t delivered[16384];
+static int delivered_len;
+
+static void channel_reset(const int loss, const int corrupt, const uint32_t seed) {
+    queue_head = queue_tail = 0;
+    loss_pct = loss;
+    corrupt_pct = corrupt;
+    test_seed(seed);
+    dead = 0;
+}
+
+static void channel_send(const uint8_t* frame, const int len) {
+    sim_time += FRAME_AIRTIME_US;
+    if (dead || (int)(test_rng() % 100) < loss_pct) {
+        return;
+    }
+    CHECK(queue_tail - queue_head < QUEUE_SIZE);
+    uint8_t* slot = queue[queue_tail % QUEUE_SIZE];
+    memcpy(slot, frame, len);
+    if ((int)(test_rng() % 100) < corrupt_pct) {
+        slot[test_rng() % len] ^= 1 << (test_rng() % 8);
+    }
+    queue_len[queue_tail % QUEUE_SIZE] = len;
+    ++queue_tail;
+}
+
+static int channel_receive(uint8_t* frame, const int max_len, const int64_t timeout_us) {
+    if (queue_head == queue_tail) {
+        sim_time += timeout_us;
+        return -1;
+    }
+    const int len = queue_len[queue_head % QUEUE_SIZE];
+    CHECK(len <= max_len);
+    memcpy(frame, queue[queue_head % QUEUE_SIZE], len);
+    ++queue_head;
+    return len;
+}
+
+static int64_t channel_now(void) {
+    return sim_time;
+}
+
+static void deliver(const uint8_t* data, const int len) {
+    CHECK(delivered_len + len <= (int)sizeof(delivered));
+    memcpy(delivered + delivered_len, data, len);
+    delivered_len += len;
+}
+
+static arq_config_t config = {8, 20, 200000, 50000, 2000000};
+static const arq_link_t receiver_link = {
+    .send = channel_send, .receive = channel_receive, .now_us = channel_now, .deliver = deliver,
+};
+
+// Кадры данных в очереди обрабатывает приёмник, подтверждение остаётся отправителю
+static void run_receiver(void) {
+    while (queue_head != queue_tail && queue[queue_head % QUEUE_SIZE][0] != ARQ_TYPE_ACK) {
+        arq_receive_step(&receiver_link, &config, 0);
+    }
+}
+
+static int sender_receive(uint8_t* frame, const int max_len, const int64_t timeout_us) {
+    run_receiver();
+    return channel_receive(frame, max_len, timeout_us);
+}
+
+static const arq_link_t sender_link = {
+    .send = channel_send, .receive = sender_receive, .now_us = channel_now, .deliver = deliver,
+};
+
+static int transfer(const uint8_t* data, const int len, arq_stats_t* stats) {
+    delivered_len = 0;
+    const int result = arq_send(&sender_link, &config, data, len, stats);
+    // Остаток очереди после отказа или последнего подтверждения
+    run_receiver();
+    queue_head = queue_tail;
+    return result;
+}
+
+static uint8_t data[4000];
+
+static void fill_data(const uint32_t seed) {
+    test_seed(seed);
+    for (int i = 0; i < (int)sizeof(data); ++i) {
+        data[i] = test_rng();
+    }
+}
+
+static void test_lossless(void) {
+    channel_reset(0, 0, 1);
+    arq_stats_t stats;
+    CHECK_EQ(transfer(data, 1000, &stats), 0);
+    CHECK_EQ(delivered_len, 1000);
+    CHECK(memcmp(delivered, data, 1000) == 0);
+    CHECK_EQ(stats.retransmissions, 0);
+    CHECK_EQ(stats.timeouts, 0);
+    CHECK_EQ(stats.frames_sent, (1000 + ARQ_MAX_PAYLOAD - 1) / ARQ_MAX_PAYLOAD);
+}
+
+// Потери и искажения в обе стороны: данные доходят целиком, по порядку и без дублей
+static void test_lossy_channel(void) {
+    static const int windows[] = {1, 4, 8, 32};
+    static const int losses[] = {10, 20, 30};
+    for (int w = 0; w < 4; ++w) {
+        for (int l = 0; l < 3; ++l) {
+            config.window = windows[w];
+            channel_reset(losses[l], 5, 100 + w * 10 + l);
+            arq_stats_t stats;
+            CHECK_EQ(transfer(data, sizeof(data), &stats), 0);
+            CHECK_EQ(delivered_len, sizeof(data));
+            CHECK(memcmp(delivered, data, sizeof(data)) == 0);
+            CHECK(stats.retransmissions > 0);
+        }
+    }
+    config.window = 8;
+}
+
+// Передача, которая не дошла совсем, возвращает -1 и не мешает следующим
+static void test_failed_transfers_do_not_alias(void) {
+    channel_reset(0, 0, 7);
+    arq_stats_t stats;
+    // Короткая передача: номер ожидаемого кадра приёмника остаётся около начала
+    CHECK_EQ(transfer(data, 10, &stats), 0);
+    CHECK_EQ(delivered_len, 10);
+
+    for (int lost = 0; lost < 3; ++lost) {
+        dead = 1;
+        CHECK_EQ(transfer(data + 100, 200, &stats), -1);
+        CHECK_EQ(delivered_len, 0);
+        dead = 0;
+        CHECK_EQ(transfer(data + 500, 300, &stats), 0);
+        CHECK_EQ(delivered_len, 300);
+        CHECK(memcmp(delivered, data + 500, 300) == 0);
+    }
+
+    // Две потерянные передачи подряд: у третьей однобитный номер совпал бы с последней увиденной
+    CHECK_EQ(transfer(data, 10, &stats), 0);
+    dead = 1;
+    CHECK_EQ(transfer(data + 100, 200, &stats), -1);
+    CHECK_EQ(transfer(data + 100, 200, &stats), -1);
+    dead = 0;
+    CHECK_EQ(transfer(data + 1000, 500, &stats), 0);
+    CHECK_EQ(delivered_len, 500);
+    CHECK(memcmp(delivered, data + 1000, 500) == 0);
+}
+
+// Номер передачи переполняется без потери кадров
+static void test_transfer_number_wraps(void) {
+    channel_reset(10, 0, 11);
+    for (int i = 0; i < 300; ++i) {
+        arq_stats_t stats;
+        const int len = 1 + i % 150;
+        CHECK_EQ(transfer(data + i, len, &stats), 0);
+        CHECK_EQ(delivered_len, len);
+        CHECK(memcmp(delivered, data + i, len) == 0);
+    }
+}
+
+int main(void) {
+    fill_data(42);
+    arq_receiver_reset();
+    test_lossless();
+    test_lossy_channel();
+    test_failed_transfers_do_not_alias();
+    test_transfer_number_wraps();
+    printf("arq: ok\n");
+    return 0;
+}
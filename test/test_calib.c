@@ -0,0 +1,118 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "calib.h"
+#include "test.h"
+
+// Середина корзины отсчёта raw, в отсчётах АЦП
+static int bucket_center(const int raw) {
+    return (raw >> CALIB_BUCKET_SHIFT << CALIB_BUCKET_SHIFT) + (1 << CALIB_BUCKET_SHIFT) / 2;
+}
+
+// Выборка калибровки: доля high_pct отсчётов на уровне high, остальные на low, гауссов шум sd
+static void fill(calib_histogram_t* histogram, const int low, const int high, const double sd, const int high_pct) {
+    calib_reset(histogram);
+    for (int i = 0; i < CALIB_SAMPLES; ++i) {
+        const int level = (int)(test_rng() % 100) < high_pct ? high : low;
+        calib_add(histogram, (int)lround(level + sd * test_gaussian()));
+    }
+}
+
+// Мигающий передатчик: порог между уровнями, средние уровни с точностью до корзины
+static void test_bimodal(void) {
+    calib_histogram_t histogram;
+    calib_result_t result;
+    fill(&histogram, 60, 400, 10, 50);
+    CHECK_EQ(calib_otsu(&histogram, &result), 0);
+    CHECK(result.threshold > 60 + 40 && result.threshold < 400 - 40);
+    CHECK(abs(result.low - 60) <= 1 << CALIB_BUCKET_SHIFT);
+    CHECK(abs(result.high - 400) <= 1 << CALIB_BUCKET_SHIFT);
+    CHECK(result.separability_pct >= 95);
+
+    // Неравные доли уровней и широкий шум: порог всё равно в промежутке, где отсчётов почти нет
+    fill(&histogram, 200, 600, 40, 20);
+    CHECK_EQ(calib_otsu(&histogram, &result), 0);
+    CHECK(result.threshold > 200 + 3 * 40 && result.threshold < 600 - 3 * 40);
+}
+
+// Два узких уровня: максимум межклассовой дисперсии на всём пустом промежутке, порог - в его середине
+static void test_gap_midpoint(void) {
+    calib_histogram_t histogram;
+    calib_result_t result;
+    calib_reset(&histogram);
+    for (int i = 0; i < CALIB_SAMPLES; ++i) {
+        calib_add(&histogram, i % 2 ? 900 : 100);
+    }
+    CHECK_EQ(calib_otsu(&histogram, &result), 0);
+    CHECK(abs(result.threshold - 500) <= 1 << CALIB_BUCKET_SHIFT);
+    CHECK_EQ(result.low, bucket_center(100));
+    CHECK_EQ(result.high, bucket_center(900));
+    CHECK_EQ(result.separability_pct, 100);
+}
+
+// Пустая выборка и все отсчёты в одной корзине: порога нет, уровни - середина корзины
+static void test_degenerate(void) {
+    calib_histogram_t histogram;
+    calib_result_t result;
+    calib_reset(&histogram);
+    CHECK_EQ(calib_otsu(&histogram, &result), -1);
+
+    for (int i = 0; i < CALIB_SAMPLES; ++i) {
+        calib_add(&histogram, 1234);
+    }
+    CHECK_EQ(calib_otsu(&histogram, &result), -1);
+    const int center = bucket_center(1234);
+    CHECK_EQ(result.threshold, center);
+    CHECK_EQ(result.low, center);
+    CHECK_EQ(result.high, center);
+}
+
+// Передатчик не мигает: один гауссов уровень делится Оцу с долей около 64%, калибровка отклоняется
+static void test_single_mode(void) {
+    calib_histogram_t histogram;
+    calib_result_t result;
+    const double sds[] = {10, 40, 120};
+    for (int s = 0; s < 3; ++s) {
+        fill(&histogram, 1500, 1500, sds[s], 0);
+        CHECK_EQ(calib_otsu(&histogram, &result), -1);
+        CHECK(result.separability_pct < CALIB_MIN_SEPARABILITY_PCT);
+    }
+}
+
+// Уровни различимы, но ближе CALIB_MIN_SEPARATION: калибровка отклоняется
+static void test_levels_too_close(void) {
+    calib_histogram_t histogram;
+    calib_result_t result;
+    calib_reset(&histogram);
+    for (int i = 0; i < CALIB_SAMPLES; ++i) {
+        calib_add(&histogram, i % 2 ? 708 : 700);
+    }
+    CHECK_EQ(calib_otsu(&histogram, &result), -1);
+    CHECK(result.high - result.low < CALIB_MIN_SEPARATION);
+}
+
+// Отсчёты за шкалой АЦП попадают в крайние корзины, счётчики не переполняются
+static void test_add_clamps(void) {
+    calib_histogram_t histogram;
+    calib_reset(&histogram);
+    calib_add(&histogram, -5);
+    calib_add(&histogram, 5000);
+    CHECK_EQ(histogram.counts[0], 1);
+    CHECK_EQ(histogram.counts[CALIB_BUCKETS - 1], 1);
+    for (int i = 0; i < 70000; ++i) {
+        calib_add(&histogram, 2000);
+    }
+    CHECK_EQ(histogram.total, UINT16_MAX);
+    CHECK_EQ(histogram.counts[2000 >> CALIB_BUCKET_SHIFT], UINT16_MAX - 2);
+}
+
+int main(void) {
+    test_bimodal();
+    test_gap_midpoint();
+    test_degenerate();
+    test_single_mode();
+    test_levels_too_close();
+    test_add_clamps();
+    printf("calib: ok\n");
+    return 0;
+}
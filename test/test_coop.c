@@ -0,0 +1,356 @@
+#include <math.h>
+#include <string.h>
+
+#include "coop.h"
+#include "engines.h"
+#include "test.h"
+
+// Планировщик и движки на модельном времени: часы двигают только шаги (чтение АЦП, переключение светодиода)
+// и проход планировщика, свободное время проматывается до ближайшего пробуждения.
+// Светодиод замкнут на АЦП, как при проверке приёмопередатчика на себя
+
+#define ADC_US 10
+#define LED_US 1
+#define PASS_US 1
+#define THRESHOLD 800
+#define HIGH_RAW 1500
+#define LOW_RAW 100
+#define NOISE_SD 30
+#define FRAME_LEN 32
+#define MAX_LED_EVENTS 16384
+
+static int64_t clock_us;
+
+static int64_t fake_now(void) {
+    return clock_us;
+}
+
+// Переключения светодиода: момент и уровень
+static int64_t led_us[MAX_LED_EVENTS];
+static int led_level[MAX_LED_EVENTS];
+static int led_events;
+static int led;
+
+static int loopback_adc_read(void) {
+    clock_us += ADC_US;
+    return (led ? HIGH_RAW : LOW_RAW) + (int)(NOISE_SD * test_gaussian());
+}
+
+static void record_led_set(const int level) {
+    CHECK(led_events < MAX_LED_EVENTS);
+    led_us[led_events] = clock_us;
+    led_level[led_events] = level;
+    ++led_events;
+    led = level;
+    clock_us += LED_US;
+}
+
+static const engine_io_t io = {loopback_adc_read, record_led_set};
+
+static void reset_world(void) {
+    clock_us = 0;
+    led_events = 0;
+    led = 0;
+}
+
+// Проходы до момента end_us; без готовых шагов часы переводятся на ближайшее пробуждение
+static void run_until(coop_scheduler_t* scheduler, const int64_t end_us) {
+    while (clock_us < end_us) {
+        if (coop_run_once(scheduler) > 0) {
+            clock_us += PASS_US;
+            continue;
+        }
+        int64_t wake = end_us;
+        for (int i = 0; i < scheduler->count; ++i) {
+            const coop_task_t* task = scheduler->tasks[i];
+            if (!task->ended && task->wake_us < wake) {
+                wake = task->wake_us;
+            }
+        }
+        clock_us = wake > clock_us ? wake : clock_us + PASS_US;
+    }
+}
+
+// Протопоток проверки макросов: ожидание условия, уступка, выход
+typedef struct {
+    coop_task_t task;
+    int gate;
+    int stage;
+    int exit_at;
+} probe_t;
+
+static int probe_step(coop_task_t* task, const int64_t now_us) {
+    probe_t* probe = (probe_t*)task;
+    (void)now_us;
+    PT_BEGIN(&task->pt);
+    probe->stage = 1;
+    PT_WAIT_UNTIL(&task->pt, probe->gate);
+    probe->stage = 2;
+    PT_YIELD(&task->pt);
+    probe->stage = 3;
+    if (probe->exit_at == 3) {
+        PT_EXIT(&task->pt);
+    }
+    PT_YIELD(&task->pt);
+    probe->stage = 4;
+    PT_END(&task->pt);
+}
+
+// Коды возврата и точки продолжения протопотока, повторный запуск после конца и выхода
+static void test_protothread(void) {
+    probe_t probe;
+    memset(&probe, 0, sizeof(probe));
+    CHECK_EQ(probe_step(&probe.task, 0), PT_WAITING);
+    CHECK_EQ(probe.stage, 1);
+    CHECK_EQ(probe_step(&probe.task, 0), PT_WAITING);
+    probe.gate = 1;
+    CHECK_EQ(probe_step(&probe.task, 0), PT_YIELDED);
+    CHECK_EQ(probe.stage, 2);
+    CHECK_EQ(probe_step(&probe.task, 0), PT_YIELDED);
+    CHECK_EQ(probe.stage, 3);
+    CHECK_EQ(probe_step(&probe.task, 0), PT_ENDED);
+    CHECK_EQ(probe.stage, 4);
+    CHECK_EQ(probe.task.pt.lc, 0);
+
+    probe.exit_at = 3;
+    CHECK_EQ(probe_step(&probe.task, 0), PT_YIELDED);
+    CHECK_EQ(probe_step(&probe.task, 0), PT_EXITED);
+    CHECK_EQ(probe.stage, 3);
+    CHECK_EQ(probe.task.pt.lc, 0);
+}
+
+// Периодический поток: шаг стоит cost_us, затем сон period_us от момента шага
+typedef struct {
+    coop_task_t task;
+    int64_t period_us;
+    int64_t cost_us;
+    int limit; // 0 - без конца
+    int count;
+    int stop_at;
+    coop_scheduler_t* scheduler;
+} ticker_t;
+
+static int ticker_step(coop_task_t* task, const int64_t now_us) {
+    ticker_t* ticker = (ticker_t*)task;
+    PT_BEGIN(&task->pt);
+    while (ticker->limit == 0 || ticker->count < ticker->limit) {
+        clock_us += ticker->cost_us;
+        if (++ticker->count == ticker->stop_at) {
+            coop_stop(ticker->scheduler);
+        }
+        COOP_SLEEP_UNTIL(task, now_us + ticker->period_us);
+    }
+    PT_END(&task->pt);
+}
+
+// Сон до момента: число шагов по периодам, опоздание не больше самого долгого чужого шага
+static void test_sleep_and_lateness(void) {
+    reset_world();
+    coop_scheduler_t scheduler;
+    ticker_t fast, slow, heavy;
+    memset(&fast, 0, sizeof(fast));
+    memset(&slow, 0, sizeof(slow));
+    memset(&heavy, 0, sizeof(heavy));
+    coop_init(&scheduler, fake_now);
+    CHECK_EQ(coop_add(&scheduler, &fast.task, "fast", ticker_step), 0);
+    CHECK_EQ(coop_add(&scheduler, &slow.task, "slow", ticker_step), 0);
+    CHECK_EQ(coop_add(&scheduler, &heavy.task, "heavy", ticker_step), 0);
+    fast.period_us = 100;
+    fast.cost_us = 2;
+    slow.period_us = 1000;
+    slow.cost_us = 5;
+    heavy.period_us = 3700;
+    heavy.cost_us = 40;
+
+    run_until(&scheduler, 1000000);
+    CHECK(fast.count >= 1000000 / 100 * 9 / 10 && fast.count <= 1000000 / 100 + 1);
+    CHECK(slow.count >= 1000000 / 1000 * 99 / 100 && slow.count <= 1000000 / 1000 + 1);
+    CHECK(heavy.count >= 1000000 / 3700 * 99 / 100 && heavy.count <= 1000000 / 3700 + 1);
+    CHECK_EQ(fast.task.steps, (uint32_t)fast.count);
+    // Поток ждёт не дольше шагов остальных потоков одного прохода
+    CHECK(fast.task.max_late_us <= slow.cost_us + heavy.cost_us + 2 * PASS_US);
+    CHECK(slow.task.max_late_us <= fast.cost_us + heavy.cost_us + 2 * PASS_US);
+    CHECK(heavy.task.max_late_us <= fast.cost_us + slow.cost_us + 2 * PASS_US);
+}
+
+// Завершение: coop_run выходит, когда закончились все потоки или по coop_stop(); лишний поток не подключается
+static void test_run_and_stop(void) {
+    reset_world();
+    coop_scheduler_t scheduler;
+    ticker_t tickers[COOP_MAX_TASKS];
+    memset(tickers, 0, sizeof(tickers));
+    coop_init(&scheduler, fake_now);
+    for (int i = 0; i < COOP_MAX_TASKS; ++i) {
+        CHECK_EQ(coop_add(&scheduler, &tickers[i].task, "ticker", ticker_step), 0);
+        tickers[i].cost_us = 1;
+        tickers[i].limit = i + 1;
+    }
+    ticker_t extra;
+    CHECK_EQ(coop_add(&scheduler, &extra.task, "extra", ticker_step), -1);
+
+    coop_run(&scheduler);
+    for (int i = 0; i < COOP_MAX_TASKS; ++i) {
+        CHECK(tickers[i].task.ended);
+        CHECK_EQ(tickers[i].count, i + 1);
+    }
+
+    memset(tickers, 0, sizeof(tickers));
+    coop_init(&scheduler, fake_now);
+    coop_add(&scheduler, &tickers[0].task, "stopper", ticker_step);
+    tickers[0].cost_us = 1;
+    tickers[0].stop_at = 5;
+    tickers[0].scheduler = &scheduler;
+    coop_run(&scheduler);
+    CHECK_EQ(tickers[0].count, 5);
+    CHECK(!tickers[0].task.ended);
+}
+
+static uint8_t received[FRAME_LEN];
+static int received_len;
+static int received_frames;
+
+static void deliver(const uint8_t* data, const int len) {
+    memcpy(received, data, len < FRAME_LEN ? len : FRAME_LEN);
+    received_len = len;
+    ++received_frames;
+}
+
+static calib_result_t calibrated;
+static int calibrations;
+
+static void apply(const calib_result_t* result) {
+    calibrated = *result;
+    ++calibrations;
+}
+
+// Все движки на одном планировщике, светодиод замкнут на АЦП: мигание до кадра, кадр принимается,
+// фронты передатчика отстают от расписания не больше чем на шаги остальных движков, калибровка находит порог
+static void test_engines_loopback(void) {
+    static const int rates[] = {1000, 5000, 10000};
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        const int frequency = rates[r];
+        reset_world();
+        received_frames = 0;
+        calibrations = 0;
+        static tx_engine_t tx;
+        static rx_engine_t rx;
+        static calib_engine_t calib;
+        static blink_engine_t blink;
+        const rxfsm_config_t config = {THRESHOLD, frequency, 0, 0, NULL};
+        tx_engine_init(&tx, &io);
+        rx_engine_init(&rx, &io, &config, deliver);
+        calib_engine_init(&calib, &io, apply);
+        blink_engine_init(&blink, &io, &tx);
+        coop_scheduler_t scheduler;
+        coop_init(&scheduler, fake_now);
+        coop_add(&scheduler, &tx.task, "tx", tx_engine_step);
+        coop_add(&scheduler, &rx.task, "rx", rx_engine_step);
+        coop_add(&scheduler, &calib.task, "calib", calib_engine_step);
+        coop_add(&scheduler, &blink.task, "blink", blink_engine_step);
+
+        // Мигание 50 Гц: переключение каждые 10 мс
+        blink.frequency = 50;
+        run_until(&scheduler, 200000);
+        CHECK(led_events >= 19 && led_events <= 21);
+        for (int i = 1; i < led_events; ++i) {
+            CHECK(led_us[i] - led_us[i - 1] >= 10000 && led_us[i] - led_us[i - 1] <= 10000 + 4 * ADC_US);
+        }
+
+        // Кадр во время мигания: светодиод отдан передатчику до конца кадра
+        uint8_t data[FRAME_LEN];
+        for (int i = 0; i < FRAME_LEN; ++i) {
+            data[i] = test_rng();
+        }
+        CHECK_EQ(tx_engine_send(&tx, data, FRAME_LEN, frequency), 0);
+        CHECK_EQ(tx_engine_send(&tx, data, FRAME_LEN, frequency), -1);
+        const int first_event = led_events;
+        const int64_t sent_at = clock_us;
+        while (tx_engine_busy(&tx)) {
+            run_until(&scheduler, clock_us + 1000);
+            CHECK(clock_us - sent_at < 2000000);
+        }
+        run_until(&scheduler, clock_us + 2 * get_rate_timing(frequency).max_delay_period_us + 20000);
+
+        CHECK_EQ(tx.frames, 1);
+        CHECK_EQ(received_frames, 1);
+        CHECK_EQ(received_len, FRAME_LEN);
+        CHECK(memcmp(received, data, FRAME_LEN) == 0);
+        CHECK_EQ(rx.fsm.stats.invalid_pairs, 0);
+
+        // Полубиты передатчика: каждое переключение не раньше своего момента и не позже шагов остальных движков.
+        // После кадра светодиод погашен и снова отдан миганию
+        const int tx_end = first_event + tx.total;
+        CHECK(led_events > tx_end);
+        CHECK_EQ(led_level[tx_end], 0);
+        const int64_t start = led_us[first_event];
+        const int64_t data_start = start + (ENGINE_SYNC_HALF_BITS + 2) * ENGINE_SYNC_HALF_PERIOD_US;
+        int64_t worst = 0;
+        for (int i = first_event + 1; i <= tx_end; ++i) {
+            const int64_t t = led_us[i] - (led_us[i] < data_start ? start : data_start);
+            const int64_t period = led_us[i] < data_start ? ENGINE_SYNC_HALF_PERIOD_US : 500000 / frequency;
+            const int64_t late = t % period;
+            if (late > worst) {
+                worst = late;
+            }
+        }
+        CHECK(worst <= 2 * ADC_US + LED_US + 2 * PASS_US);
+        CHECK(tx.task.max_late_us <= 2 * ADC_US + LED_US + 2 * PASS_US);
+
+        // Калибровка по мигающему светодиоду и кадру: порог между уровнями
+        CHECK(calibrations >= 1);
+        CHECK(calibrated.threshold > LOW_RAW + 4 * NOISE_SD && calibrated.threshold < HIGH_RAW - 4 * NOISE_SD);
+    }
+}
+
+// Смена настройки приёма применяется между кадрами и не теряет статистику
+static void test_rx_reconfigure(void) {
+    reset_world();
+    received_frames = 0;
+    static tx_engine_t tx;
+    static rx_engine_t rx;
+    const rxfsm_config_t slow = {THRESHOLD, 1000, 0, 0, NULL};
+    const rxfsm_config_t fast = {THRESHOLD, 5000, 0, 0, NULL};
+    tx_engine_init(&tx, &io);
+    rx_engine_init(&rx, &io, &slow, deliver);
+    coop_scheduler_t scheduler;
+    coop_init(&scheduler, fake_now);
+    coop_add(&scheduler, &tx.task, "tx", tx_engine_step);
+    coop_add(&scheduler, &rx.task, "rx", rx_engine_step);
+
+    uint8_t data[FRAME_LEN];
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        data[i] = test_rng();
+    }
+    tx_engine_send(&tx, data, FRAME_LEN, 1000);
+    // Настройка приходит посреди кадра
+    run_until(&scheduler, 500000);
+    CHECK(rx.fsm.state == RXFSM_DATA);
+    rx_engine_configure(&rx, &fast);
+    while (tx_engine_busy(&tx)) {
+        run_until(&scheduler, clock_us + 1000);
+    }
+    run_until(&scheduler, clock_us + 100000);
+    CHECK_EQ(received_frames, 1);
+    CHECK(memcmp(received, data, FRAME_LEN) == 0);
+    CHECK_EQ(rx.fsm.config.frequency, 5000);
+
+    tx_engine_send(&tx, data, FRAME_LEN, 5000);
+    while (tx_engine_busy(&tx)) {
+        run_until(&scheduler, clock_us + 1000);
+    }
+    run_until(&scheduler, clock_us + 100000);
+    CHECK_EQ(received_frames, 2);
+    CHECK(memcmp(received, data, FRAME_LEN) == 0);
+    CHECK_EQ(rx.fsm.stats.frames, 2);
+}
+
+int main(void) {
+    test_seed(5);
+    test_protothread();
+    test_sleep_and_lateness();
+    test_run_and_stop();
+    test_engines_loopback();
+    test_rx_reconfigure();
+    printf("coop: ok\n");
+    return 0;
+}
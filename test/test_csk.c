@@ -0,0 +1,153 @@
+#include <string.h>
+
+#include "csk.h"
+#include "test.h"
+
+static const csk_mode_t modes[] = {CSK_MODE_RGB, CSK_MODE_RGBW, CSK_MODE_CSK4, CSK_MODE_CSK8};
+#define MODE_COUNT (int)(sizeof(modes) / sizeof(modes[0]))
+
+static int clamp_channel(const int value) {
+    return value < 0 ? 0 : value > CSK_FULL ? CSK_FULL : value;
+}
+
+// Каждый символ переходит в свой цвет и обратно
+static void test_map_demap_round_trip(void) {
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        const int count = 1 << csk_bits_per_symbol(modes[m]);
+        for (int symbol = 0; symbol < count; ++symbol) {
+            const csk_color_t color = csk_map_symbol(modes[m], symbol);
+            CHECK_EQ(csk_demap_color(modes[m], color), symbol);
+        }
+    }
+}
+
+// Все точки созвездия различны
+static void test_colors_distinct(void) {
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        const int count = 1 << csk_bits_per_symbol(modes[m]);
+        for (int a = 0; a < count; ++a) {
+            for (int b = a + 1; b < count; ++b) {
+                const csk_color_t ca = csk_map_symbol(modes[m], a);
+                const csk_color_t cb = csk_map_symbol(modes[m], b);
+                CHECK(ca.red != cb.red || ca.green != cb.green || ca.blue != cb.blue || ca.white != cb.white);
+            }
+        }
+    }
+}
+
+// CSK не меняет суммарную яркость и не использует белый канал
+static void test_csk_constant_brightness(void) {
+    const csk_mode_t csk_modes[] = {CSK_MODE_CSK4, CSK_MODE_CSK8};
+    for (int m = 0; m < 2; ++m) {
+        const int count = 1 << csk_bits_per_symbol(csk_modes[m]);
+        for (int symbol = 0; symbol < count; ++symbol) {
+            const csk_color_t color = csk_map_symbol(csk_modes[m], symbol);
+            CHECK_EQ(color.red + color.green + color.blue, CSK_FULL);
+            CHECK_EQ(color.white, 0);
+        }
+    }
+}
+
+// Обратное отображение выбирает ближайшую точку: отклонение каналов до 30 не меняет символ
+static void test_demap_tolerates_noise(void) {
+    static const int offsets[][4] = {
+        {30, -30, 30, 0}, {-30, 30, -30, 0}, {30, 30, 30, 30}, {-30, -30, -30, -30}, {0, 25, -25, 10},
+    };
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        const int count = 1 << csk_bits_per_symbol(modes[m]);
+        for (int symbol = 0; symbol < count; ++symbol) {
+            const csk_color_t color = csk_map_symbol(modes[m], symbol);
+            for (int o = 0; o < (int)(sizeof(offsets) / sizeof(offsets[0])); ++o) {
+                const csk_color_t noisy = {
+                    clamp_channel(color.red + offsets[o][0]),
+                    clamp_channel(color.green + offsets[o][1]),
+                    clamp_channel(color.blue + offsets[o][2]),
+                    clamp_channel(color.white + offsets[o][3]),
+                };
+                CHECK_EQ(csk_demap_color(modes[m], noisy), symbol);
+            }
+        }
+    }
+}
+
+// Старшие биты первыми, хвост дополняется нулями
+static void test_pack_symbols(void) {
+    const uint8_t data[] = {0xB4, 0x5F};
+    uint8_t symbols[16];
+
+    CHECK_EQ(csk_pack_symbols(CSK_MODE_CSK4, data, 2, symbols, 16), 8);
+    const uint8_t csk4[] = {2, 3, 1, 0, 1, 1, 3, 3};
+    CHECK(memcmp(symbols, csk4, sizeof(csk4)) == 0);
+
+    // 16 бит по 3: пять полных символов и один с двумя битами нулевого дополнения
+    CHECK_EQ(csk_pack_symbols(CSK_MODE_RGB, data, 2, symbols, 16), 6);
+    const uint8_t rgb[] = {5, 5, 0, 5, 7, 4};
+    CHECK(memcmp(symbols, rgb, sizeof(rgb)) == 0);
+
+    CHECK_EQ(csk_pack_symbols(CSK_MODE_RGBW, data, 2, symbols, 16), 4);
+    const uint8_t rgbw[] = {0xB, 0x4, 0x5, 0xF};
+    CHECK(memcmp(symbols, rgbw, sizeof(rgbw)) == 0);
+
+    // Предел буфера символов
+    CHECK_EQ(csk_pack_symbols(CSK_MODE_CSK4, data, 2, symbols, 3), 3);
+    CHECK_EQ(csk_pack_symbols(CSK_MODE_OFF, data, 2, symbols, 16), 0);
+}
+
+// Байты через символы и цвета восстанавливаются без потерь
+static void test_bytes_through_colors(void) {
+    uint8_t data[48];
+    for (int i = 0; i < (int)sizeof(data); ++i) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        const int bits = csk_bits_per_symbol(modes[m]);
+        uint8_t symbols[48 * 8 / 2];
+        const int count = csk_pack_symbols(modes[m], data, sizeof(data), symbols, sizeof(symbols));
+        CHECK_EQ(count, ((int)sizeof(data) * 8 + bits - 1) / bits);
+
+        uint8_t decoded[sizeof(data)];
+        memset(decoded, 0, sizeof(decoded));
+        int bit = 0;
+        for (int i = 0; i < count; ++i) {
+            const uint8_t symbol = csk_demap_color(modes[m], csk_map_symbol(modes[m], symbols[i]));
+            for (int b = bits - 1; b >= 0 && bit < (int)sizeof(data) * 8; --b, ++bit) {
+                decoded[bit / 8] |= ((symbol >> b) & 1) << (7 - bit % 8);
+            }
+        }
+        CHECK(memcmp(decoded, data, sizeof(data)) == 0);
+    }
+}
+
+static void test_mode_names(void) {
+    CHECK_EQ(csk_mode_from_name("OFF"), CSK_MODE_OFF);
+    CHECK_EQ(csk_mode_from_name("RGB"), CSK_MODE_RGB);
+    CHECK_EQ(csk_mode_from_name("RGBW"), CSK_MODE_RGBW);
+    CHECK_EQ(csk_mode_from_name("CSK4"), CSK_MODE_CSK4);
+    CHECK_EQ(csk_mode_from_name("CSK8"), CSK_MODE_CSK8);
+    CHECK_EQ(csk_mode_from_name("CSK16"), -1);
+    CHECK_EQ(csk_mode_from_name(""), -1);
+    // Префикс известного имени - не режим
+    CHECK_EQ(csk_mode_from_name("RGBX"), -1);
+    CHECK_EQ(csk_mode_from_name("OFFSET"), -1);
+    CHECK_EQ(csk_mode_from_name("CSK42"), -1);
+    CHECK_EQ(csk_mode_from_name("RGB W"), -1);
+    CHECK_EQ(csk_mode_from_name("RG"), -1);
+    // Пробелы и перевод строки из UART вокруг имени допускаются
+    CHECK_EQ(csk_mode_from_name(" CSK4 \r\n"), CSK_MODE_CSK4);
+    CHECK_EQ(csk_mode_from_name("RGBW\n"), CSK_MODE_RGBW);
+    for (int m = 0; m < MODE_COUNT; ++m) {
+        CHECK_EQ(csk_mode_from_name(csk_mode_name(modes[m])), modes[m]);
+    }
+}
+
+int main(void) {
+    test_map_demap_round_trip();
+    test_colors_distinct();
+    test_csk_constant_brightness();
+    test_demap_tolerates_noise();
+    test_pack_symbols();
+    test_bytes_through_colors();
+    test_mode_names();
+    printf("csk: ok\n");
+    return 0;
+}
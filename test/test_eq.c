@@ -0,0 +1,122 @@
+#include <stdlib.h>
+
+#include "eq.h"
+#include "manchester.h"
+#include "test.h"
+
+// Модель канала: светодиод и фотодиод - однополюсный ФНЧ с разными полюсами нарастания и спада
+// (спад медленнее), плюс шум АЦП. Отсчёты идут с шагом одного отсчёта эквалайзера
+
+#define THRESHOLD 800
+#define HIGH_RAW 1500
+#define LOW_RAW 100
+#define SAMPLES_PER_HALF 2
+#define FRAME_LEN 64
+#define TRAIN_SAMPLES 256
+
+typedef struct {
+    double rise;
+    double fall;
+    double noise_sd;
+    double level;
+} channel_t;
+
+static int channel_sample(channel_t* channel, const int high) {
+    const double target = high ? HIGH_RAW : LOW_RAW;
+    const double pole = target > channel->level ? channel->rise : channel->fall;
+    channel->level = target + pole * (channel->level - target);
+    return (int)(channel->level + channel->noise_sd * test_gaussian());
+}
+
+// Обучение как в паузе после синхропоследовательности: установившийся высокий уровень, затем спад
+static void train(eq_t* eq, channel_t* channel) {
+    for (int i = 0; i < TRAIN_SAMPLES; ++i) {
+        channel_sample(channel, 1);
+    }
+    int samples[TRAIN_SAMPLES];
+    for (int i = 0; i < TRAIN_SAMPLES; ++i) {
+        samples[i] = channel_sample(channel, 0);
+    }
+    eq_train(eq, samples, TRAIN_SAMPLES);
+    eq_start(eq, samples[TRAIN_SAMPLES - 1]);
+}
+
+// Оценка полюса спада не зависит от более быстрого нарастания; полюс медленнее EQ_MAX_POLE_Q ограничивается
+static void test_pole_estimate(void) {
+    static const double poles[] = {0.3, 0.5, 0.7, 0.8};
+    for (unsigned i = 0; i < sizeof(poles) / sizeof(poles[0]); ++i) {
+        for (int trial = 0; trial < 16; ++trial) {
+            channel_t channel = {0.2, poles[i], 4, LOW_RAW};
+            eq_t eq;
+            train(&eq, &channel);
+            CHECK(abs(eq.pole - (int)(poles[i] * EQ_ONE)) <= EQ_ONE / 32);
+        }
+    }
+    channel_t slow = {0.2, 0.92, 0, LOW_RAW};
+    eq_t eq;
+    train(&eq, &slow);
+    CHECK_EQ(eq.pole, EQ_MAX_POLE_Q);
+}
+
+// Сильный шум: полюс компенсируется частично, чтобы шум после эквалайзера не превысил EQ_MAX_NOISE
+static void test_noise_limit(void) {
+    channel_t channel = {0.2, 0.8, 30, LOW_RAW};
+    eq_t eq;
+    train(&eq, &channel);
+    CHECK(eq.pole > 0);
+    CHECK(eq.pole < (int)(0.8 * EQ_ONE) - EQ_ONE / 16);
+    const double a = (double)eq.pole / EQ_ONE;
+    CHECK(30 * sqrt(1 + a * a) / (1 - a) <= EQ_MAX_NOISE * 1.1);
+}
+
+// Ошибочные биты кадра при решении по порогу последнего отсчёта каждого полубита; пары 00 и 11 - ошибка
+static int frame_errors(channel_t* channel, eq_t* eq) {
+    int errors = 0;
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        const uint8_t byte = test_rng();
+        const uint16_t halves = manchester_encode_byte(byte);
+        int sliced[16];
+        for (int bit = 15; bit >= 0; --bit) {
+            int value = 0;
+            for (int s = 0; s < SAMPLES_PER_HALF; ++s) {
+                value = channel_sample(channel, halves >> bit & 1);
+                if (eq) {
+                    value = eq_apply(eq, value);
+                }
+            }
+            sliced[15 - bit] = value >= THRESHOLD;
+        }
+        for (int pair = 0; pair < 8; ++pair) {
+            const int first = sliced[2 * pair];
+            const int second = sliced[2 * pair + 1];
+            const int expected = byte >> (7 - pair) & 1;
+            errors += first == second || second != expected;
+        }
+    }
+    return errors;
+}
+
+// Медленный спад не успевает опуститься ниже порога за полубит: без эквалайзера пары сливаются,
+// обученный эквалайзер восстанавливает кадр без ошибок
+static void test_decode(void) {
+    static const double poles[] = {0.8, 0.85};
+    for (unsigned i = 0; i < sizeof(poles) / sizeof(poles[0]); ++i) {
+        channel_t plain_channel = {0.3, poles[i], 10, LOW_RAW};
+        CHECK(frame_errors(&plain_channel, NULL) > FRAME_LEN);
+
+        channel_t channel = {0.3, poles[i], 10, LOW_RAW};
+        eq_t eq;
+        train(&eq, &channel);
+        CHECK(eq.pole > 0);
+        CHECK_EQ(frame_errors(&channel, &eq), 0);
+    }
+}
+
+int main(void) {
+    test_seed(13);
+    test_pole_estimate();
+    test_noise_limit();
+    test_decode();
+    printf("eq: ok\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <math.h>
+#include <string.h>
+
+#include "fec.h"
+#include "test.h"
+
+#define CODED_BITS(len) (FEC_CODED_SIZE(len) * 8)
+
+static void random_bytes(uint8_t* data, const int len) {
+    for (int i = 0; i < len; ++i) {
+        data[i] = test_rng();
+    }
+}
+
+// Жёсткие решения полной уверенности по кодированным битам
+static void to_soft(const uint8_t* coded, const int bits, int8_t* soft) {
+    for (int i = 0; i < bits; ++i) {
+        soft[i] = (coded[i / 8] >> (7 - i % 8)) & 1 ? FEC_SOFT_MAX : -FEC_SOFT_MAX;
+    }
+}
+
+static int bit_errors(const uint8_t* a, const uint8_t* b, const int len) {
+    int errors = 0;
+    for (int i = 0; i < len; ++i) {
+        errors += __builtin_popcount(a[i] ^ b[i]);
+    }
+    return errors;
+}
+
+static void test_round_trip(void) {
+    uint8_t data[FEC_MAX_DATA];
+    uint8_t coded[FEC_CODED_SIZE(FEC_MAX_DATA)];
+    int8_t soft[CODED_BITS(FEC_MAX_DATA)];
+    uint8_t decoded[FEC_MAX_DATA];
+    for (int len = 1; len <= FEC_MAX_DATA; len += 7) {
+        random_bytes(data, len);
+        CHECK_EQ(fec_encode(data, len, coded), FEC_CODED_SIZE(len));
+        to_soft(coded, CODED_BITS(len), soft);
+        CHECK_EQ(fec_decode(soft, CODED_BITS(len), decoded, FEC_MAX_DATA), len);
+        CHECK(memcmp(decoded, data, len) == 0);
+    }
+}
+
+// Инвертированные кодированные биты: по одному на каждые spacing бит, затем пары соседних
+static void test_corrects_injected_errors(void) {
+    uint8_t data[FEC_MAX_DATA];
+    uint8_t coded[FEC_CODED_SIZE(FEC_MAX_DATA)];
+    int8_t soft[CODED_BITS(FEC_MAX_DATA)];
+    uint8_t decoded[FEC_MAX_DATA];
+    const int bits = CODED_BITS(FEC_MAX_DATA);
+
+    static const int spacings[] = {40, 24, 16};
+    for (int s = 0; s < 3; ++s) {
+        for (int trial = 0; trial < 20; ++trial) {
+            random_bytes(data, FEC_MAX_DATA);
+            fec_encode(data, FEC_MAX_DATA, coded);
+            to_soft(coded, bits, soft);
+            int flipped = 0;
+            for (int i = (int)(test_rng() % spacings[s]); i < bits - 16; i += spacings[s]) {
+                soft[i] = -soft[i];
+                ++flipped;
+            }
+            CHECK(flipped >= bits / spacings[s] - 2);
+            CHECK_EQ(fec_decode(soft, bits, decoded, FEC_MAX_DATA), FEC_MAX_DATA);
+            CHECK_EQ(bit_errors(decoded, data, FEC_MAX_DATA), 0);
+        }
+    }
+
+    // Пара ошибок в соседних битах раз в 48 бит
+    for (int trial = 0; trial < 20; ++trial) {
+        random_bytes(data, FEC_MAX_DATA);
+        fec_encode(data, FEC_MAX_DATA, coded);
+        to_soft(coded, bits, soft);
+        for (int i = (int)(test_rng() % 48); i + 1 < bits - 16; i += 48) {
+            soft[i] = -soft[i];
+            soft[i + 1] = -soft[i + 1];
+        }
+        fec_decode(soft, bits, decoded, FEC_MAX_DATA);
+        CHECK_EQ(bit_errors(decoded, data, FEC_MAX_DATA), 0);
+    }
+}
+
+// Стёртые биты (нулевая уверенность) восстанавливаются по соседям
+static void test_recovers_erasures(void) {
+    uint8_t data[FEC_MAX_DATA];
+    uint8_t coded[FEC_CODED_SIZE(FEC_MAX_DATA)];
+    int8_t soft[CODED_BITS(FEC_MAX_DATA)];
+    uint8_t decoded[FEC_MAX_DATA];
+    const int bits = CODED_BITS(FEC_MAX_DATA);
+    random_bytes(data, FEC_MAX_DATA);
+    fec_encode(data, FEC_MAX_DATA, coded);
+    to_soft(coded, bits, soft);
+    for (int i = 0; i < bits; i += 4) {
+        soft[i] = 0;
+    }
+    fec_decode(soft, bits, decoded, FEC_MAX_DATA);
+    CHECK_EQ(bit_errors(decoded, data, FEC_MAX_DATA), 0);
+}
+
+// Мягкое решение с гауссовым шумом: ошибок после декодера намного меньше, чем у некодированного сигнала
+static void test_coding_gain(void) {
+    uint8_t data[FEC_MAX_DATA];
+    uint8_t coded[FEC_CODED_SIZE(FEC_MAX_DATA)];
+    int8_t soft[CODED_BITS(FEC_MAX_DATA)];
+    uint8_t decoded[FEC_MAX_DATA];
+    const int bits = CODED_BITS(FEC_MAX_DATA);
+    const double sigma = 0.6;
+    long coded_errors = 0;
+    long uncoded_errors = 0;
+    for (int trial = 0; trial < 40; ++trial) {
+        random_bytes(data, FEC_MAX_DATA);
+        fec_encode(data, FEC_MAX_DATA, coded);
+        for (int i = 0; i < bits; ++i) {
+            const int bit = (coded[i / 8] >> (7 - i % 8)) & 1;
+            const double value = (bit ? 1.0 : -1.0) + sigma * test_gaussian();
+            const double scaled = value * FEC_SOFT_MAX / 2;
+            soft[i] = scaled > FEC_SOFT_MAX ? FEC_SOFT_MAX : scaled < -FEC_SOFT_MAX ? -FEC_SOFT_MAX : (int8_t)scaled;
+        }
+        fec_decode(soft, bits, decoded, FEC_MAX_DATA);
+        coded_errors += bit_errors(decoded, data, FEC_MAX_DATA);
+        for (int i = 0; i < FEC_MAX_DATA * 8; ++i) {
+            uncoded_errors += 1.0 + sigma * test_gaussian() < 0;
+        }
+    }
+    // Некодированный BER при sigma 0.6 около 5%
+    CHECK(uncoded_errors > 1000);
+    CHECK(coded_errors * 50 < uncoded_errors);
+}
+
+static void test_decode_limits(void) {
+    uint8_t data[16];
+    uint8_t coded[FEC_CODED_SIZE(16)];
+    int8_t soft[CODED_BITS(16)];
+    uint8_t decoded[16];
+    random_bytes(data, 16);
+    fec_encode(data, 16, coded);
+    to_soft(coded, CODED_BITS(16), soft);
+    // Обрезка по max_len и слишком короткий вход
+    CHECK_EQ(fec_decode(soft, CODED_BITS(16), decoded, 4), 4);
+    CHECK_EQ(fec_decode(soft, 2 * FEC_TAIL_BITS + 8, decoded, 16), 0);
+}
+
+int main(void) {
+    test_round_trip();
+    test_corrects_injected_errors();
+    test_recovers_erasures();
+    test_coding_gain();
+    test_decode_limits();
+    printf("fec: ok\n");
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <string.h>
+
+#include "led_strip_spi_encoder.h"
+#include "led_strip_spi_reference.h"
+#include "test.h"
+
+// Каждое значение байта цвета кодируется так же, как побитовой функцией
+static void test_every_byte_matches_reference(void) {
+    for (int value = 0; value < 256; ++value) {
+        const uint8_t color = value;
+        uint8_t expected[LED_STRIP_SPI_BYTES_PER_COLOR_BYTE];
+        uint8_t actual[LED_STRIP_SPI_BYTES_PER_COLOR_BYTE];
+        reference_spi_bit(color, expected);
+        led_strip_spi_encode(actual, &color, 1);
+        CHECK(memcmp(actual, expected, sizeof(expected)) == 0);
+    }
+}
+
+// Развёрнутый по четыре байта цикл и хвост: все длины до 3 пикселей RGBW, буфер за концом не тронут
+static void test_runs_match_reference(void) {
+    uint8_t colors[12];
+    for (int i = 0; i < (int)sizeof(colors); ++i) {
+        colors[i] = (uint8_t)(i * 71 + 5);
+    }
+    for (uint32_t len = 0; len <= sizeof(colors); ++len) {
+        uint8_t expected[sizeof(colors) * LED_STRIP_SPI_BYTES_PER_COLOR_BYTE + 1];
+        uint8_t actual[sizeof(expected)];
+        memset(expected, 0xEE, sizeof(expected));
+        memset(actual, 0xEE, sizeof(actual));
+        for (uint32_t i = 0; i < len; ++i) {
+            reference_spi_bit(colors[i], expected + i * LED_STRIP_SPI_BYTES_PER_COLOR_BYTE);
+        }
+        led_strip_spi_encode(actual, colors, len);
+        CHECK(memcmp(actual, expected, sizeof(expected)) == 0);
+    }
+}
+
+int main(void) {
+    test_every_byte_matches_reference();
+    test_runs_match_reference();
+    printf("led_strip_spi: ok\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <string.h>
+
+#include "lzss.h"
+#include "test.h"
+
+#define MAX_DATA 4096
+
+// Кадр lzss_pack_frame() через потоковый распаковщик по байту, как на приёме. Возвращает размер кадра
+static int round_trip(const uint8_t* data, const int len) {
+    static uint8_t frame[MAX_DATA + LZSS_HEADER_SIZE];
+    static uint8_t decoded[MAX_DATA + LZSS_MAX_MATCH];
+    const int frame_len = lzss_pack_frame(data, len, frame);
+    CHECK(frame_len >= LZSS_HEADER_SIZE);
+    CHECK(frame_len <= len + LZSS_HEADER_SIZE);
+
+    lzss_decoder_t decoder;
+    lzss_decoder_reset(&decoder, frame[0]);
+    int decoded_len = 0;
+    for (int i = LZSS_HEADER_SIZE; i < frame_len; ++i) {
+        decoded_len += lzss_decoder_feed(&decoder, frame[i], decoded + decoded_len);
+        CHECK(decoded_len <= len);
+    }
+    CHECK_EQ(decoded_len, len);
+    CHECK(memcmp(decoded, data, len) == 0);
+    return frame_len;
+}
+
+static void test_short_inputs(void) {
+    const uint8_t data[] = {'a', 'a', 'a', 'a'};
+    CHECK_EQ(round_trip(data, 0), LZSS_HEADER_SIZE);
+    CHECK_EQ(round_trip(data, 1), 1 + LZSS_HEADER_SIZE);
+    CHECK_EQ(round_trip(data, 2), 2 + LZSS_HEADER_SIZE);
+    CHECK_EQ(round_trip(data, 4), 4 + LZSS_HEADER_SIZE);
+}
+
+// Случайные данные не сжимаются: кадр уходит как есть с одним байтом заголовка
+static void test_incompressible(void) {
+    static uint8_t data[MAX_DATA];
+    for (int i = 0; i < MAX_DATA; ++i) {
+        data[i] = test_rng();
+    }
+    for (int len = 3; len <= MAX_DATA; len *= 3) {
+        CHECK_EQ(round_trip(data, len), len + LZSS_HEADER_SIZE);
+    }
+}
+
+// Серии длиннее LZSS_MAX_MATCH разбиваются на несколько ссылок
+static void test_long_runs(void) {
+    static uint8_t data[MAX_DATA];
+    memset(data, 'x', sizeof(data));
+    const int size = round_trip(data, 3 * LZSS_MAX_MATCH + 7);
+    CHECK(size < 32);
+    CHECK(round_trip(data, MAX_DATA) < 64);
+
+    // Повтор короткой последовательности заходит на ещё не выданные байты
+    for (int i = 0; i < MAX_DATA; ++i) {
+        data[i] = "abc"[i % 3];
+    }
+    CHECK(round_trip(data, LZSS_MAX_MATCH + 1) < 16);
+    CHECK(round_trip(data, 2 * LZSS_MAX_MATCH + 2) < 16);
+}
+
+// Совпадение ровно на краю окна: смещение 256 - самое дальнее, 257 уже не находится
+static void test_window_edge(void) {
+    static uint8_t data[2 * LZSS_WINDOW + 2];
+    for (int distance = LZSS_WINDOW - 1; distance <= LZSS_WINDOW + 1; ++distance) {
+        for (int i = 0; i < distance; ++i) {
+            data[i] = test_rng();
+        }
+        memcpy(data + distance, data, LZSS_WINDOW / 2);
+        const int len = distance + LZSS_WINDOW / 2;
+        const int size = round_trip(data, len);
+        if (distance <= LZSS_WINDOW) {
+            CHECK(size < len);
+        } else {
+            CHECK_EQ(size, len + LZSS_HEADER_SIZE);
+        }
+    }
+
+    // Много ссылок подряд на самый старый байт окна
+    static uint8_t data2[MAX_DATA];
+    for (int i = 0; i < LZSS_WINDOW; ++i) {
+        data2[i] = test_rng();
+    }
+    for (int i = LZSS_WINDOW; i < MAX_DATA; ++i) {
+        data2[i] = data2[i - LZSS_WINDOW];
+    }
+    CHECK(round_trip(data2, MAX_DATA) < MAX_DATA / 4);
+}
+
+// Текст с повторами и переполнение буфера сжатия
+static void test_text_and_limits(void) {
+    static uint8_t data[MAX_DATA];
+    static const char* words[] = {"light ", "fidelity ", "manchester ", "frame ", "sync ", "\r\n"};
+    int len = 0;
+    while (len < MAX_DATA - 16) {
+        const char* word = words[test_rng() % 6];
+        memcpy(data + len, word, strlen(word));
+        len += strlen(word);
+    }
+    CHECK(round_trip(data, len) < len / 2);
+
+    uint8_t out[16];
+    CHECK_EQ(lzss_compress(data, len, out, sizeof(out)), -1);
+}
+
+int main(void) {
+    test_short_inputs();
+    test_incompressible();
+    test_long_runs();
+    test_window_edge();
+    test_text_and_limits();
+    printf("lzss: ok\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "manchester.h"
+#include "test.h"
+
+// Уровни полубитов относительно порога
+#define LOW 0.5f
+#define HIGH 1.5f
+
+// Кодирование по битам, как до словных ядер: бит 1 - пара 01, бит 0 - пара 10, старший бит первым
+static uint16_t reference_encode(const uint8_t byte) {
+    uint16_t halves = 0;
+    for (int bit = 7; bit >= 0; --bit) {
+        halves = halves << 2 | ((byte >> bit) & 1 ? 0x1 : 0x2);
+    }
+    return halves;
+}
+
+// Декодирование по парам, как до словных ядер: каждая пара решается decode_manchester_pair(),
+// неразличимая пара принимается по разности половин
+static uint16_t reference_decode(const float* half_bits, const int count, uint16_t* invalid, uint16_t* undecided) {
+    uint16_t word = 0;
+    *invalid = 0;
+    *undecided = 0;
+    for (int pair = 0; pair < 16; ++pair) {
+        const uint16_t mask = 1u << (15 - pair);
+        if (2 * pair + 1 >= count) {
+            *invalid |= mask;
+            *undecided |= mask;
+            continue;
+        }
+        const float first = half_bits[2 * pair];
+        const float second = half_bits[2 * pair + 1];
+        const char decision = decode_manchester_pair(first, second);
+        if ((first >= 1) == (second >= 1)) {
+            *invalid |= mask;
+        }
+        if (decision == 2) {
+            *undecided |= mask;
+        }
+        if (decision == 2 ? second > first : decision) {
+            word |= mask;
+        }
+    }
+    return word;
+}
+
+// Полубиты двух байтов уровнями LOW/HIGH
+static void halves_of(const uint8_t first, const uint8_t second, float* half_bits) {
+    const uint32_t halves = (uint32_t)reference_encode(first) << 16 | reference_encode(second);
+    for (int i = 0; i < 32; ++i) {
+        half_bits[i] = (halves >> (31 - i)) & 1 ? HIGH : LOW;
+    }
+}
+
+static void check_word(const float* half_bits, const int count) {
+    uint16_t invalid;
+    uint16_t undecided;
+    uint16_t expected_invalid;
+    uint16_t expected_undecided;
+    const uint16_t expected = reference_decode(half_bits, count, &expected_invalid, &expected_undecided);
+    CHECK_EQ(decode_manchester_word(half_bits, count, &invalid, &undecided), expected);
+    CHECK_EQ(invalid, expected_invalid);
+    CHECK_EQ(undecided, expected_undecided);
+}
+
+// Кодирование словом совпадает с побитовым для каждого значения байта
+static void test_encode_every_byte(void) {
+    for (int value = 0; value < 256; ++value) {
+        CHECK_EQ(manchester_encode_byte(value), reference_encode(value));
+    }
+}
+
+// Все пары байтов: масочное декодирование слова и полный путь от полубитов возвращают оба байта без ошибок
+static void test_decode_every_byte_pair(void) {
+    for (int first = 0; first < 256; ++first) {
+        for (int second = 0; second < 256; ++second) {
+            const uint16_t expected = first << 8 | second;
+            uint16_t valid;
+            const uint32_t halves = (uint32_t)manchester_encode_byte(first) << 16 | manchester_encode_byte(second);
+            CHECK_EQ(manchester_decode_word(halves, &valid), expected);
+            CHECK_EQ(valid, 0xFFFF);
+
+            float half_bits[32];
+            halves_of(first, second, half_bits);
+            CHECK_EQ(manchester_pack_halves(half_bits, 32), halves);
+            uint16_t invalid;
+            uint16_t undecided;
+            CHECK_EQ(decode_manchester_word(half_bits, 32, &invalid, &undecided), expected);
+            CHECK_EQ(invalid, 0);
+            CHECK_EQ(undecided, 0);
+        }
+    }
+}
+
+// Пары без пересечения порога в каждой позиции каждого байта: решение и флаги как у decode_manchester_pair()
+static void test_invalid_pairs(void) {
+    static const float invalid_pairs[][2] = {
+        {0.4f, 0.6f},   // Обе низкие, вторая выше: 1
+        {0.6f, 0.4f},   // Обе низкие, первая выше: 0
+        {1.2f, 1.6f},   // Обе высокие
+        {1.6f, 1.2f},
+        {0.50f, 0.51f}, // Неразличимые
+        {1.30f, 1.30f},
+        {0.0f, 0.0f},   // Полубиты, которых не было в буфере
+    };
+    for (int value = 0; value < 256; ++value) {
+        for (int pair = 0; pair < 16; ++pair) {
+            for (int v = 0; v < (int)(sizeof(invalid_pairs) / sizeof(invalid_pairs[0])); ++v) {
+                float half_bits[32];
+                halves_of(value, value ^ 0xA5, half_bits);
+                half_bits[2 * pair] = invalid_pairs[v][0];
+                half_bits[2 * pair + 1] = invalid_pairs[v][1];
+                check_word(half_bits, 32);
+
+                uint16_t invalid;
+                uint16_t undecided;
+                decode_manchester_word(half_bits, 32, &invalid, &undecided);
+                CHECK_EQ(invalid, 1u << (15 - pair));
+            }
+        }
+    }
+}
+
+// Неполное слово в конце кадра: пары за count неверны и не решены
+static void test_short_word(void) {
+    float half_bits[32];
+    halves_of(0x3C, 0xE1, half_bits);
+    for (int count = 0; count <= 32; ++count) {
+        check_word(half_bits, count);
+    }
+}
+
+// Произвольные уровни у порога и вдали от него
+static void test_random_levels(void) {
+    for (int trial = 0; trial < 200000; ++trial) {
+        float half_bits[32];
+        for (int i = 0; i < 32; ++i) {
+            const int kind = test_rng() % 10;
+            half_bits[i] = kind < 4 ? 0.5f + (test_rng() % 40) * 0.01f
+                         : kind < 8 ? 1.0f + (test_rng() % 40) * 0.01f
+                                    : 0.99f + (test_rng() % 3) * 0.01f;
+        }
+        check_word(half_bits, test_rng() % 4 == 0 ? test_rng() % 33 : 32);
+    }
+}
+
+int main(void) {
+    test_seed(3);
+    test_encode_every_byte();
+    test_decode_every_byte_pair();
+    test_invalid_pairs();
+    test_short_word();
+    test_random_levels();
+    printf("manchester: ok\n");
+    return 0;
+}
@@ -0,0 +1,262 @@
+#include <math.h>
+#include <string.h>
+
+#include "fft.h"
+#include "ofdm.h"
+#include "test.h"
+
+static int bit_errors(const uint8_t* a, const uint8_t* b, const int len) {
+    int errors = 0;
+    for (int i = 0; i < len; ++i) {
+        errors += __builtin_popcount(a[i] ^ b[i]);
+    }
+    return errors;
+}
+
+// Отношение мощности эталона к мощности ошибки, дБ
+static double snr_db(const double* re, const double* im, const fft_complex_t* actual, const int n) {
+    double signal = 0;
+    double error = 0;
+    for (int i = 0; i < n; ++i) {
+        signal += re[i] * re[i] + im[i] * im[i];
+        error += (re[i] - actual[i].re) * (re[i] - actual[i].re) + (im[i] - actual[i].im) * (im[i] - actual[i].im);
+    }
+    return 10 * log10(signal / error);
+}
+
+// Прямое БПФ всех размеров совпадает с DFT / n в плавающей точке
+static void test_fft_matches_dft(void) {
+    fft_init();
+    for (int log2n = 2; log2n <= FFT_MAX_LOG2; ++log2n) {
+        const int n = 1 << log2n;
+        fft_complex_t data[FFT_MAX_SIZE];
+        double x_re[FFT_MAX_SIZE];
+        double x_im[FFT_MAX_SIZE];
+        for (int i = 0; i < n; ++i) {
+            x_re[i] = (int)(test_rng() % 20001) - 10000;
+            x_im[i] = (int)(test_rng() % 20001) - 10000;
+            data[i].re = (int16_t)x_re[i];
+            data[i].im = (int16_t)x_im[i];
+        }
+        fft_q15(data, log2n, 0);
+        double dft_re[FFT_MAX_SIZE];
+        double dft_im[FFT_MAX_SIZE];
+        for (int k = 0; k < n; ++k) {
+            dft_re[k] = dft_im[k] = 0;
+            for (int i = 0; i < n; ++i) {
+                const double angle = -2 * M_PI * i * k / n;
+                dft_re[k] += x_re[i] * cos(angle) - x_im[i] * sin(angle);
+                dft_im[k] += x_re[i] * sin(angle) + x_im[i] * cos(angle);
+            }
+            dft_re[k] /= n;
+            dft_im[k] /= n;
+        }
+        // Каждый каскад теряет около 3 дБ на округлении: 256 точек дают около 52 дБ
+        CHECK(snr_db(dft_re, dft_im, data, n) > 45);
+    }
+}
+
+// Обратное БПФ эрмитово-симметричного спектра символа OFDM: ровно IDFT, мнимая часть остаётся шумом округления
+static void test_inverse_fft_of_hermitian_spectrum(void) {
+    fft_init();
+    fft_complex_t data[OFDM_N];
+    double spectrum_re[OFDM_N] = {0};
+    double spectrum_im[OFDM_N] = {0};
+    for (int k = 1; k < OFDM_N / 2; ++k) {
+        spectrum_re[k] = test_rng() % 2 ? 1000 : -1000;
+        spectrum_im[k] = test_rng() % 2 ? 1000 : -1000;
+        spectrum_re[OFDM_N - k] = spectrum_re[k];
+        spectrum_im[OFDM_N - k] = -spectrum_im[k];
+    }
+    for (int k = 0; k < OFDM_N; ++k) {
+        data[k].re = (int16_t)spectrum_re[k];
+        data[k].im = (int16_t)spectrum_im[k];
+    }
+    fft_q15(data, OFDM_LOG2_N, 1);
+    double signal_re[OFDM_N];
+    double signal_im[OFDM_N] = {0};
+    double residue = 0;
+    for (int i = 0; i < OFDM_N; ++i) {
+        signal_re[i] = 0;
+        for (int k = 0; k < OFDM_N; ++k) {
+            const double angle = 2 * M_PI * i * k / OFDM_N;
+            signal_re[i] += spectrum_re[k] * cos(angle) - spectrum_im[k] * sin(angle);
+        }
+        signal_re[i] /= OFDM_N;
+        residue += (double)data[i].im * data[i].im;
+    }
+    fft_complex_t real_part[OFDM_N];
+    for (int i = 0; i < OFDM_N; ++i) {
+        real_part[i].re = data[i].re;
+        real_part[i].im = 0;
+    }
+    CHECK(snr_db(signal_re, signal_im, real_part, OFDM_N) > 40);
+    CHECK(sqrt(residue / OFDM_N) < 2);
+}
+
+// Ёмкость кадра по распределению бит и её предел
+static void test_loading_capacity(void) {
+    ofdm_loading_t loading;
+    ofdm_loading_uniform(&loading, 1);
+    CHECK_EQ(ofdm_symbol_bits(&loading), OFDM_CARRIERS);
+    CHECK_EQ(ofdm_frame_capacity(&loading), OFDM_CARRIERS * OFDM_MAX_DATA_SYMBOLS / 8);
+    ofdm_loading_uniform(&loading, 4);
+    CHECK_EQ(ofdm_symbol_bits(&loading), 4 * OFDM_CARRIERS);
+    CHECK_EQ(ofdm_frame_capacity(&loading), OFDM_MAX_DATA);
+    ofdm_loading_uniform(&loading, 0);
+    CHECK_EQ(ofdm_frame_capacity(&loading), 0);
+}
+
+// Канал: ЦАП -> спад светодиода (однополюсный ФНЧ) -> отражение через 2 отсчёта -> 12-битный АЦП с шумом.
+// Такт АЦП отличается на ppm, запись начинается на early отсчётов раньше кадра. Возвращает число отсчётов
+static int channel(
+    const uint8_t* tx, const int count, int16_t* rx, const double alpha, const double echo, const double noise,
+    const double ppm, const int early
+) {
+    static double led[OFDM_MAX_SAMPLES];
+    double level = 0;
+    for (int i = 0; i < count; ++i) {
+        level += alpha * (tx[i] - level);
+        led[i] = level;
+    }
+    for (int i = count - 1; i >= 2; --i) {
+        led[i] += echo * led[i - 2];
+    }
+    for (int m = 0; m < count; ++m) {
+        const double t = m - early + m * ppm * 1e-6;
+        const int i = (int)floor(t);
+        const double fraction = t - i;
+        double value;
+        if (i < 0) {
+            value = 0;
+        } else if (i + 1 >= count) {
+            value = led[count - 1];
+        } else {
+            value = led[i] * (1 - fraction) + led[i + 1] * fraction;
+        }
+        const long raw = lround(value * 8 + 200 + noise * test_gaussian());
+        rx[m] = raw < 0 ? 0 : raw > 4095 ? 4095 : raw;
+    }
+    return count;
+}
+
+// Без искажений кадр любой длины возвращается без ошибок при любом числе бит на поднесущую
+static void test_clean_round_trip(void) {
+    static uint8_t samples[OFDM_MAX_SAMPLES];
+    static int16_t rx[OFDM_MAX_SAMPLES];
+    uint8_t data[OFDM_MAX_DATA];
+    uint8_t out[OFDM_MAX_DATA];
+    for (int i = 0; i < OFDM_MAX_DATA; ++i) {
+        data[i] = test_rng();
+    }
+    const int bits[] = {1, 2, 4};
+    for (int b = 0; b < 3; ++b) {
+        ofdm_loading_t loading;
+        ofdm_loading_uniform(&loading, bits[b]);
+        const int capacity = ofdm_frame_capacity(&loading);
+        const int lengths[] = {1, 17, capacity / 2, capacity};
+        for (int l = 0; l < 4; ++l) {
+            const int count = ofdm_modulate(&loading, data, lengths[l], samples);
+            CHECK(count > 0 && count <= OFDM_MAX_SAMPLES);
+            CHECK_EQ(count % OFDM_SYMBOL_SAMPLES, 0);
+            for (int i = 0; i < count; ++i) {
+                rx[i] = samples[i] * 8 + 200;
+            }
+            ofdm_channel_t estimate;
+            CHECK_EQ(ofdm_demodulate(rx, count, out, OFDM_MAX_DATA, &estimate), lengths[l]);
+            CHECK(memcmp(out, data, lengths[l]) == 0);
+            CHECK(memcmp(&estimate.loading, &loading, sizeof(loading)) == 0);
+        }
+    }
+}
+
+// Спад светодиода и отражение короче префикса, уход такта АЦП и раннее начало записи: BPSK и QPSK без ошибок
+static void test_lowpass_multipath_round_trip(void) {
+    static uint8_t samples[OFDM_MAX_SAMPLES];
+    static int16_t rx[OFDM_MAX_SAMPLES];
+    uint8_t data[OFDM_MAX_DATA];
+    uint8_t out[OFDM_MAX_DATA];
+    const int bits[] = {1, 2};
+    for (int b = 0; b < 2; ++b) {
+        ofdm_loading_t loading;
+        ofdm_loading_uniform(&loading, bits[b]);
+        const int capacity = ofdm_frame_capacity(&loading);
+        for (int trial = 0; trial < 10; ++trial) {
+            for (int i = 0; i < capacity; ++i) {
+                data[i] = test_rng();
+            }
+            const int count = ofdm_modulate(&loading, data, capacity, samples);
+            channel(samples, count, rx, 0.5, 0.3, 8, 50, trial % (OFDM_CP / 2 + 1));
+            ofdm_channel_t estimate;
+            CHECK_EQ(ofdm_demodulate(rx, count, out, OFDM_MAX_DATA, &estimate), capacity);
+            CHECK_EQ(bit_errors(out, data, capacity), 0);
+        }
+    }
+}
+
+// Оценка канала: на спаде АЧХ SNR верхних поднесущих ниже нижних, предложенное распределение
+// снимает с них биты и проходит тот же канал с долей ошибок не выше 1e-3, на которую рассчитаны пороги SNR
+static void test_suggested_loading(void) {
+    static uint8_t samples[OFDM_MAX_SAMPLES];
+    static int16_t rx[OFDM_MAX_SAMPLES];
+    uint8_t data[OFDM_MAX_DATA];
+    uint8_t out[OFDM_MAX_DATA];
+    for (int i = 0; i < OFDM_MAX_DATA; ++i) {
+        data[i] = test_rng();
+    }
+    ofdm_loading_t loading;
+    ofdm_loading_uniform(&loading, 1);
+    int count = ofdm_modulate(&loading, data, 16, samples);
+    channel(samples, count, rx, 0.3, 0, 4, 0, 0);
+    ofdm_channel_t estimate;
+    CHECK_EQ(ofdm_demodulate(rx, count, out, OFDM_MAX_DATA, &estimate), 16);
+    // Оценка по одному кадру разбросана, сравниваются средние по восьми поднесущим с каждого края
+    double low_db = 0;
+    double high_db = 0;
+    int low_bits = 0;
+    int high_bits = 0;
+    for (int k = 0; k < 8; ++k) {
+        low_db += estimate.snr_db[k] / 8;
+        high_db += estimate.snr_db[OFDM_CARRIERS - 1 - k] / 8;
+        low_bits += estimate.suggested.bits[k];
+        high_bits += estimate.suggested.bits[OFDM_CARRIERS - 1 - k];
+    }
+    CHECK(low_db > high_db + 3);
+    CHECK(low_bits > high_bits);
+    CHECK(ofdm_symbol_bits(&estimate.suggested) < 4 * OFDM_CARRIERS);
+
+    const ofdm_loading_t suggested = estimate.suggested;
+    const int capacity = ofdm_frame_capacity(&suggested);
+    CHECK(capacity > 0);
+    count = ofdm_modulate(&suggested, data, capacity, samples);
+    channel(samples, count, rx, 0.3, 0, 4, 0, 0);
+    CHECK_EQ(ofdm_demodulate(rx, count, out, OFDM_MAX_DATA, &estimate), capacity);
+    CHECK(bit_errors(out, data, capacity) * 1000 <= capacity * 8);
+}
+
+// Без кадра (постоянный уровень или шум) заголовок не проходит проверку
+static void test_rejects_noise(void) {
+    static int16_t rx[OFDM_MAX_SAMPLES];
+    uint8_t out[OFDM_MAX_DATA];
+    ofdm_channel_t estimate;
+    for (int i = 0; i < OFDM_MAX_SAMPLES; ++i) {
+        rx[i] = 1224;
+    }
+    CHECK_EQ(ofdm_demodulate(rx, OFDM_MAX_SAMPLES, out, OFDM_MAX_DATA, &estimate), -1);
+    for (int i = 0; i < OFDM_MAX_SAMPLES; ++i) {
+        rx[i] = (int16_t)(1224 + 160 * test_gaussian());
+    }
+    CHECK_EQ(ofdm_demodulate(rx, OFDM_MAX_SAMPLES, out, OFDM_MAX_DATA, &estimate), -1);
+}
+
+int main(void) {
+    test_fft_matches_dft();
+    test_inverse_fft_of_hermitian_spectrum();
+    test_loading_capacity();
+    test_clean_round_trip();
+    test_lowpass_multipath_round_trip();
+    test_suggested_loading();
+    test_rejects_noise();
+    printf("ofdm: ok\n");
+    return 0;
+}
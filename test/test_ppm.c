@@ -0,0 +1,182 @@
+#include <string.h>
+
+#include "ppm.h"
+#include "test.h"
+
+#define SLOT_US 200
+
+static const int orders[] = {4, 8, 16};
+
+// Импульсы кадра: опорный в момент 0, символ k начинается через (k + 1) * order слотов,
+// offset_us - сдвиг каждого импульса от начала его слота
+static int frame_pulses(
+    const int order, const uint8_t* symbols, const int count, const int offset_us, int64_t* pulses
+) {
+    pulses[0] = 0;
+    for (int k = 0; k < count; ++k) {
+        pulses[k + 1] = (int64_t)(k + 1) * order * SLOT_US + symbols[k] * SLOT_US + offset_us;
+    }
+    return count + 1;
+}
+
+// Число бит на символ и отказ от неподдерживаемого порядка
+static void test_bits_per_symbol(void) {
+    CHECK_EQ(ppm_bits_per_symbol(4), 2);
+    CHECK_EQ(ppm_bits_per_symbol(8), 3);
+    CHECK_EQ(ppm_bits_per_symbol(16), 4);
+    CHECK_EQ(ppm_bits_per_symbol(2), 0);
+    const uint8_t data[] = {0x5A};
+    uint8_t symbols[8];
+    CHECK_EQ(ppm_pack_symbols(32, data, sizeof(data), symbols, 8), 0);
+}
+
+// Разбиение на слоты и сборка обратно при любой длине, дополнение последнего символа отбрасывается
+static void test_pack_unpack_round_trip(void) {
+    uint8_t data[PPM_FRAME_MAX_DATA];
+    for (int i = 0; i < PPM_FRAME_MAX_DATA; ++i) {
+        data[i] = test_rng();
+    }
+    for (int o = 0; o < 3; ++o) {
+        const int order = orders[o];
+        const int bits = ppm_bits_per_symbol(order);
+        for (int len = 1; len <= PPM_FRAME_MAX_DATA; ++len) {
+            uint8_t symbols[PPM_MAX_SYMBOLS];
+            const int count = ppm_pack_symbols(order, data, len, symbols, PPM_MAX_SYMBOLS);
+            CHECK_EQ(count, (len * 8 + bits - 1) / bits);
+            for (int k = 0; k < count; ++k) {
+                CHECK(symbols[k] < order);
+            }
+            uint8_t out[PPM_FRAME_MAX_DATA];
+            CHECK_EQ(ppm_unpack_symbols(order, symbols, count, out, PPM_FRAME_MAX_DATA), len);
+            CHECK(memcmp(out, data, len) == 0);
+        }
+    }
+    // Старшие биты первыми: 0xB4 = 10 11 01 00
+    const uint8_t byte = 0xB4;
+    uint8_t symbols[4];
+    CHECK_EQ(ppm_pack_symbols(4, &byte, 1, symbols, 4), 4);
+    CHECK_EQ(symbols[0], 2);
+    CHECK_EQ(symbols[1], 3);
+    CHECK_EQ(symbols[2], 1);
+    CHECK_EQ(symbols[3], 0);
+}
+
+// Полный путь: байты -> импульсы с уходом тактов и дрожанием отсчёта -> символы -> байты
+static void test_pulses_round_trip(void) {
+    for (int o = 0; o < 3; ++o) {
+        const int order = orders[o];
+        for (int trial = 0; trial < 500; ++trial) {
+            uint8_t data[PPM_FRAME_MAX_DATA];
+            const int len = 1 + test_rng() % PPM_FRAME_MAX_DATA;
+            for (int i = 0; i < len; ++i) {
+                data[i] = test_rng();
+            }
+            uint8_t symbols[PPM_MAX_SYMBOLS];
+            const int count = ppm_pack_symbols(order, data, len, symbols, PPM_MAX_SYMBOLS);
+            // Такт передатчика отличается до 0.1%, момент импульса дрожит на четверть слота
+            const double skew = 1 + ((int)(test_rng() % 2001) - 1000) * 1e-6;
+            int64_t pulses[PPM_MAX_SYMBOLS + 1];
+            pulses[0] = 1000;
+            for (int k = 0; k < count; ++k) {
+                const double start = 1000 + (k + 1) * order * SLOT_US * skew;
+                const int jitter = (int)(test_rng() % (SLOT_US / 4 + 1)) - SLOT_US / 8;
+                pulses[k + 1] = (int64_t)(start + symbols[k] * SLOT_US * skew) + jitter;
+            }
+            uint8_t decoded[PPM_MAX_SYMBOLS];
+            CHECK_EQ(ppm_decode_pulses(order, SLOT_US, pulses, count + 1, decoded, PPM_MAX_SYMBOLS), count);
+            uint8_t out[PPM_FRAME_MAX_DATA];
+            CHECK_EQ(ppm_unpack_symbols(order, decoded, count, out, PPM_FRAME_MAX_DATA), len);
+            CHECK(memcmp(out, data, len) == 0);
+        }
+    }
+}
+
+// Граница слотов: импульс, опоздавший меньше чем на полслота, остаётся в своём слоте, в том числе в последнем
+// слоте символа; ранний импульс в слоте 0 не уходит в предыдущий символ
+static void test_slot_boundary(void) {
+    for (int o = 0; o < 3; ++o) {
+        const int order = orders[o];
+        uint8_t symbols[2 * PPM_MAX_ORDER];
+        for (int k = 0; k < 2 * order; ++k) {
+            symbols[k] = k % order;
+        }
+        const int count = 2 * order;
+        const int offsets[] = {SLOT_US / 2 - 1, -(SLOT_US / 2 - 1)};
+        for (int i = 0; i < 2; ++i) {
+            int64_t pulses[2 * PPM_MAX_ORDER + 1];
+            const int pulse_count = frame_pulses(order, symbols, count, offsets[i], pulses);
+            uint8_t decoded[2 * PPM_MAX_ORDER];
+            CHECK_EQ(ppm_decode_pulses(order, SLOT_US, pulses, pulse_count, decoded, 2 * PPM_MAX_ORDER), count);
+            CHECK(memcmp(decoded, symbols, count) == 0);
+        }
+    }
+}
+
+// Ошибка на границе: импульс последнего слота опоздал на полслота и попал в слот 0 следующего символа.
+// Портятся только этот символ и следующий, остальные символы кадра на своих местах
+static void test_slot_boundary_error_is_local(void) {
+    for (int o = 0; o < 3; ++o) {
+        const int order = orders[o];
+        uint8_t symbols[32];
+        for (int k = 0; k < 32; ++k) {
+            symbols[k] = (k * 5 + 1) % order;
+        }
+        symbols[10] = order - 1;
+        int64_t pulses[33];
+        const int pulse_count = frame_pulses(order, symbols, 32, 0, pulses);
+        pulses[11] += SLOT_US / 2;
+        uint8_t decoded[32];
+        CHECK_EQ(ppm_decode_pulses(order, SLOT_US, pulses, pulse_count, decoded, 32), 32);
+        for (int k = 0; k < 32; ++k) {
+            if (k == 10 || k == 11) {
+                CHECK_EQ(decoded[k], 0);
+            } else {
+                CHECK_EQ(decoded[k], symbols[k]);
+            }
+        }
+    }
+}
+
+// Потерянный импульс даёт символ 0, лишний импульс в принятом символе отбрасывается, кадр не сдвигается
+static void test_missing_and_extra_pulses(void) {
+    for (int o = 0; o < 3; ++o) {
+        const int order = orders[o];
+        uint8_t symbols[32];
+        for (int k = 0; k < 32; ++k) {
+            symbols[k] = 1 + k % (order - 1);
+        }
+        symbols[20] = 1;
+        int64_t clean[33];
+        frame_pulses(order, symbols, 32, 0, clean);
+        int64_t pulses[34];
+        int count = 0;
+        for (int i = 0; i < 33; ++i) {
+            // Импульс символа 5 потерян
+            if (i == 6) {
+                continue;
+            }
+            pulses[count++] = clean[i];
+            // Помеха в конце символа 20 после его импульса
+            if (i == 21) {
+                pulses[count++] = clean[i] + (order - 1 - symbols[20]) * SLOT_US;
+            }
+        }
+        uint8_t decoded[32];
+        CHECK_EQ(ppm_decode_pulses(order, SLOT_US, pulses, count, decoded, 32), 32);
+        for (int k = 0; k < 32; ++k) {
+            CHECK_EQ(decoded[k], k == 5 ? 0 : symbols[k]);
+        }
+    }
+}
+
+int main(void) {
+    test_seed(7);
+    test_bits_per_symbol();
+    test_pack_unpack_round_trip();
+    test_pulses_round_trip();
+    test_slot_boundary();
+    test_slot_boundary_error_is_local();
+    test_missing_and_extra_pulses();
+    printf("ppm: ok\n");
+    return 0;
+}
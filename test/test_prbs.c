@@ -0,0 +1,197 @@
+#include <string.h>
+
+#include "prbs.h"
+#include "test.h"
+
+#define STREAM_BITS 200000
+
+static uint8_t stream[STREAM_BITS / 8];
+static int stream_bits;
+
+static void put_bit(const int bit) {
+    if (bit) {
+        stream[stream_bits / 8] |= 0x80 >> (stream_bits % 8);
+    } else {
+        stream[stream_bits / 8] &= ~(0x80 >> (stream_bits % 8));
+    }
+    ++stream_bits;
+}
+
+// Последовательность максимальной длины: период 2^n - 1, единиц на период 2^(n-1)
+static void test_period(void) {
+    const prbs_order_t orders[] = {PRBS_7, PRBS_15};
+    for (int o = 0; o < 2; ++o) {
+        prbs_gen_t gen;
+        prbs_init(&gen, orders[o]);
+        const uint32_t initial = gen.state;
+        const uint32_t period = (1u << orders[o]) - 1;
+        uint32_t ones = 0;
+        for (uint32_t i = 1; i <= period; ++i) {
+            ones += prbs_next_bit(&gen);
+            if (i < period) {
+                CHECK(gen.state != initial);
+            }
+        }
+        CHECK_EQ(gen.state, initial);
+        CHECK_EQ(ones, 1u << (orders[o] - 1));
+    }
+
+    // PRBS31: период не проверить целиком, проверяется отсутствие короткого цикла
+    prbs_gen_t gen;
+    prbs_init(&gen, PRBS_31);
+    const uint32_t initial = gen.state;
+    for (int i = 0; i < 1000000; ++i) {
+        prbs_next_bit(&gen);
+        CHECK(gen.state != initial);
+        CHECK(gen.state != 0);
+    }
+}
+
+// Биты подчиняются рекуррентности полинома: b[k] = b[k - n] ^ b[k - tap]
+static void test_recurrence(void) {
+    const prbs_order_t orders[] = {PRBS_7, PRBS_15, PRBS_31};
+    const int taps[] = {6, 14, 28};
+    for (int o = 0; o < 3; ++o) {
+        prbs_gen_t gen;
+        prbs_init(&gen, orders[o]);
+        static uint8_t bits[4096];
+        for (int i = 0; i < 4096; ++i) {
+            bits[i] = prbs_next_bit(&gen);
+        }
+        for (int i = orders[o]; i < 4096; ++i) {
+            CHECK_EQ(bits[i], bits[i - orders[o]] ^ bits[i - taps[o]]);
+        }
+    }
+
+    // prbs_fill - те же биты старшими первыми
+    prbs_gen_t by_bit;
+    prbs_gen_t by_byte;
+    prbs_init(&by_bit, PRBS_15);
+    prbs_init(&by_byte, PRBS_15);
+    uint8_t bytes[64];
+    prbs_fill(&by_byte, bytes, sizeof(bytes));
+    for (int i = 0; i < (int)sizeof(bytes) * 8; ++i) {
+        CHECK_EQ((bytes[i / 8] >> (7 - i % 8)) & 1, prbs_next_bit(&by_bit));
+    }
+}
+
+// Поток с середины последовательности, в errors_at - инвертированные биты
+static void build_stream(const prbs_order_t order, const int skip, const int* errors_at, const int errors) {
+    prbs_gen_t gen;
+    prbs_init(&gen, order);
+    for (int i = 0; i < skip; ++i) {
+        prbs_next_bit(&gen);
+    }
+    stream_bits = 0;
+    int next_error = 0;
+    for (int i = 0; i < STREAM_BITS; ++i) {
+        int bit = prbs_next_bit(&gen);
+        if (next_error < errors && errors_at[next_error] == i) {
+            bit ^= 1;
+            ++next_error;
+        }
+        put_bit(bit);
+    }
+}
+
+static void test_clean_stream_locks(void) {
+    const prbs_order_t orders[] = {PRBS_7, PRBS_15, PRBS_31};
+    for (int o = 0; o < 3; ++o) {
+        build_stream(orders[o], 12345, NULL, 0);
+        prbs_checker_t checker;
+        prbs_checker_init(&checker, orders[o]);
+        prbs_check(&checker, stream, stream_bits / 8);
+        CHECK(checker.locked);
+        CHECK_EQ(checker.stats.errors, 0);
+        CHECK_EQ(checker.stats.sync_losses, 0);
+        // Захват за два регистра бит
+        CHECK(checker.stats.bits >= (uint64_t)(STREAM_BITS - 2 * orders[o]));
+    }
+}
+
+// Одиночные ошибки дальше PRBS_BURST_GAP друг от друга - отдельные пачки длиной 1
+static void test_counts_errors(void) {
+    int errors_at[100];
+    for (int i = 0; i < 100; ++i) {
+        errors_at[i] = 1000 + i * 1500;
+    }
+    build_stream(PRBS_15, 0, errors_at, 100);
+    prbs_checker_t checker;
+    prbs_checker_init(&checker, PRBS_15);
+    prbs_check(&checker, stream, stream_bits / 8);
+    CHECK_EQ(checker.stats.errors, 100);
+    CHECK_EQ(checker.stats.bursts, 100);
+    CHECK_EQ(checker.stats.max_burst, 1);
+    CHECK_EQ(checker.stats.slips, 0);
+    CHECK_EQ(checker.stats.sync_losses, 0);
+}
+
+// Ошибки ближе PRBS_BURST_GAP - одна пачка от первой до последней ошибки
+static void test_counts_bursts(void) {
+    const int errors_at[] = {5000, 5003, 5010, 5020, 9000, 9001};
+    build_stream(PRBS_7, 0, errors_at, 6);
+    prbs_checker_t checker;
+    prbs_checker_init(&checker, PRBS_7);
+    prbs_check(&checker, stream, stream_bits / 8);
+    CHECK_EQ(checker.stats.errors, 6);
+    CHECK_EQ(checker.stats.bursts, 2);
+    CHECK_EQ(checker.stats.max_burst, 21);
+}
+
+// Выпавший бит - проскальзывание, переход на другую последовательность - потеря синхронизма
+static void test_slip_and_loss(void) {
+    prbs_gen_t gen;
+    prbs_init(&gen, PRBS_15);
+    stream_bits = 0;
+    for (int i = 0; i < STREAM_BITS; ++i) {
+        const int bit = prbs_next_bit(&gen);
+        if (i != 50000) {
+            put_bit(bit);
+        }
+    }
+    prbs_checker_t checker;
+    prbs_checker_init(&checker, PRBS_15);
+    prbs_check(&checker, stream, stream_bits / 8);
+    CHECK(checker.locked);
+    CHECK_EQ(checker.stats.slips, 1);
+    CHECK_EQ(checker.stats.sync_losses, 0);
+
+    // Вторая половина - та же последовательность с далёкой фазы
+    prbs_init(&gen, PRBS_15);
+    stream_bits = 0;
+    for (int i = 0; i < STREAM_BITS / 2; ++i) {
+        put_bit(prbs_next_bit(&gen));
+    }
+    for (int i = 0; i < 10000; ++i) {
+        prbs_next_bit(&gen);
+    }
+    while (stream_bits < STREAM_BITS) {
+        put_bit(prbs_next_bit(&gen));
+    }
+    prbs_checker_init(&checker, PRBS_15);
+    prbs_check(&checker, stream, stream_bits / 8);
+    CHECK(checker.locked);
+    CHECK_EQ(checker.stats.slips, 0);
+    CHECK_EQ(checker.stats.sync_losses, 1);
+    // Ошибки окна рассинхронизации не относятся к каналу
+    CHECK(checker.stats.errors <= PRBS_LOSS_WINDOW);
+}
+
+static void test_order_from_value(void) {
+    CHECK_EQ(prbs_order_from_value(7), PRBS_7);
+    CHECK_EQ(prbs_order_from_value(15), PRBS_15);
+    CHECK_EQ(prbs_order_from_value(31), PRBS_31);
+    CHECK_EQ(prbs_order_from_value(9), -1);
+}
+
+int main(void) {
+    test_period();
+    test_recurrence();
+    test_clean_stream_locks();
+    test_counts_errors();
+    test_counts_bursts();
+    test_slip_and_loss();
+    test_order_from_value();
+    printf("prbs: ok\n");
+    return 0;
+}
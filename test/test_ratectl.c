@@ -0,0 +1,125 @@
+#include "ratectl.h"
+#include "test.h"
+
+#define PAIRS 256
+
+// Ступени от 1000 Гц до 10000 Гц: 1000, 2000, 5000, 10000
+static void init_ladder(ratectl_t* ctl) {
+    ratectl_init(ctl, 1000, 10000, RATECTL_DEFAULT_TARGET_PPM);
+    CHECK_EQ(ctl->levels, 4);
+    CHECK_EQ(ratectl_frequency(ctl), 1000);
+}
+
+static void clean_frames(ratectl_t* ctl, const int count) {
+    for (int i = 0; i < count; ++i) {
+        CHECK_EQ(ratectl_observe(ctl, 1, PAIRS, 0), 0);
+    }
+}
+
+// Подъём: ступень предлагается после RATECTL_PROBE_FRAMES чистых кадров и подтверждается на той же ступени
+static void test_climb(void) {
+    ratectl_t ctl;
+    init_ladder(&ctl);
+    static const int frequencies[] = {2000, 5000, 10000};
+    for (int level = 1; level < 4; ++level) {
+        clean_frames(&ctl, RATECTL_PROBE_FRAMES - 1);
+        CHECK_EQ(ratectl_advise(&ctl), level - 1);
+        clean_frames(&ctl, 1);
+        CHECK_EQ(ratectl_advise(&ctl), level);
+        ratectl_set_level(&ctl, level);
+        CHECK_EQ(ratectl_frequency(&ctl), frequencies[level - 1]);
+        CHECK(ctl.probing);
+        ratectl_set_level(&ctl, level);
+        CHECK(!ctl.probing);
+    }
+    // Выше верхней ступени не поднимается
+    clean_frames(&ctl, RATECTL_MAX_PROBE_FRAMES);
+    CHECK_EQ(ratectl_advise(&ctl), 3);
+    // Кадр с долей неразличимых пар выше допустимой - шаг вниз при подтверждении
+    CHECK_EQ(ratectl_observe(&ctl, 1, PAIRS, PAIRS / 8), 0);
+    CHECK_EQ(ratectl_advise(&ctl), 2);
+}
+
+// Проба: непринятый кадр или таймаут на пробной ступени сразу возвращают назад,
+// а каждая следующая неудачная проба той же ступени ждёт вдвое больше чистых кадров
+static void test_probe_failure(void) {
+    ratectl_t ctl;
+    init_ladder(&ctl);
+    clean_frames(&ctl, RATECTL_PROBE_FRAMES);
+    ratectl_set_level(&ctl, ratectl_advise(&ctl));
+    CHECK_EQ(ratectl_observe(&ctl, 0, 0, 0), 1);
+    CHECK_EQ(ctl.level, 0);
+    CHECK(!ctl.probing);
+
+    int required = RATECTL_PROBE_FRAMES;
+    for (int attempt = 0; attempt < 6; ++attempt) {
+        clean_frames(&ctl, required - 1);
+        CHECK_EQ(ratectl_advise(&ctl), 0);
+        clean_frames(&ctl, 1);
+        CHECK_EQ(ratectl_advise(&ctl), 1);
+        ratectl_set_level(&ctl, 1);
+        CHECK_EQ(attempt % 2 ? ratectl_observe(&ctl, 0, 0, 0) : ratectl_timeout(&ctl), 1);
+        CHECK_EQ(ctl.level, 0);
+        if (required < RATECTL_MAX_PROBE_FRAMES) {
+            required *= 2;
+        }
+        CHECK_EQ(ctl.probe_frames, required);
+    }
+
+    // Выдержанная проба сбрасывает ожидание
+    clean_frames(&ctl, required);
+    ratectl_set_level(&ctl, ratectl_advise(&ctl));
+    ratectl_set_level(&ctl, 1);
+    CHECK_EQ(ctl.probe_frames, RATECTL_PROBE_FRAMES);
+    CHECK_EQ(ctl.failed_level, -1);
+}
+
+// Потеря связи на рабочей ступени: RATECTL_FALLBACK_FRAMES непринятых кадров или RATECTL_FALLBACK_TIMEOUTS
+// таймаутов подряд возвращают на базовую скорость
+static void test_fallback(void) {
+    ratectl_t ctl;
+    init_ladder(&ctl);
+    ratectl_set_level(&ctl, 2);
+    ratectl_set_level(&ctl, 2);
+    for (int i = 0; i < RATECTL_FALLBACK_FRAMES - 1; ++i) {
+        CHECK_EQ(ratectl_observe(&ctl, 0, 0, 0), 0);
+    }
+    // Принятый кадр обнуляет счёт
+    clean_frames(&ctl, 1);
+    for (int i = 0; i < RATECTL_FALLBACK_FRAMES - 1; ++i) {
+        CHECK_EQ(ratectl_observe(&ctl, 0, 0, 0), 0);
+    }
+    CHECK_EQ(ctl.level, 2);
+    CHECK_EQ(ratectl_observe(&ctl, 0, 0, 0), 1);
+    CHECK_EQ(ctl.level, 0);
+    CHECK_EQ(ratectl_frequency(&ctl), 1000);
+    // На базовой скорости падать некуда
+    for (int i = 0; i < RATECTL_FALLBACK_FRAMES; ++i) {
+        CHECK_EQ(ratectl_observe(&ctl, 0, 0, 0), 0);
+    }
+
+    ratectl_set_level(&ctl, 3);
+    ratectl_set_level(&ctl, 3);
+    for (int i = 0; i < RATECTL_FALLBACK_TIMEOUTS - 1; ++i) {
+        CHECK_EQ(ratectl_timeout(&ctl), 0);
+    }
+    // Подтверждение обнуляет счёт таймаутов
+    ratectl_set_level(&ctl, 3);
+    for (int i = 0; i < RATECTL_FALLBACK_TIMEOUTS - 1; ++i) {
+        CHECK_EQ(ratectl_timeout(&ctl), 0);
+    }
+    CHECK_EQ(ctl.level, 3);
+    CHECK_EQ(ratectl_timeout(&ctl), 1);
+    CHECK_EQ(ctl.level, 0);
+    // Номер ступени вне диапазона - базовая скорость
+    ratectl_set_level(&ctl, 7);
+    CHECK_EQ(ctl.level, 0);
+}
+
+int main(void) {
+    test_climb();
+    test_probe_failure();
+    test_fallback();
+    printf("ratectl: ok\n");
+    return 0;
+}
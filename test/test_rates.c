@@ -0,0 +1,152 @@
+#include "manchester.h"
+#include "rates.h"
+#include "test.h"
+
+// Метка на линии: пауза после синхропоследовательности, затем полубиты байтов на скорости передатчика.
+// АЦП снимает отсчёты с шумом через неравные промежутки: шаг в долю полупериода плюс случайная добавка до половины шага
+
+#define THRESHOLD 800
+#define HIGH_RAW 1500
+#define LOW_RAW 100
+#define NOISE_SD 60
+#define PAUSE_HALVES 4
+#define MAX_HALVES 64
+
+#define RATE_ENTRY(f) (f),
+static const int standard_rates[] = {STANDARD_RATES(RATE_ENTRY)};
+#define STANDARD_COUNT (int)(sizeof(standard_rates) / sizeof(standard_rates[0]))
+
+typedef struct {
+    int halves[MAX_HALVES];
+    int count;
+    double half_us;
+    // Выброс противоположного уровня во второй четверти полубита glitch_half, -1 - без выброса
+    int glitch_half;
+} trace_t;
+
+static void trace_init(trace_t* trace, const double frequency) {
+    trace->count = 0;
+    trace->half_us = 500000.0 / frequency;
+    trace->glitch_half = -1;
+    for (int i = 0; i < PAUSE_HALVES; ++i) {
+        trace->halves[trace->count++] = 0;
+    }
+}
+
+static void trace_byte(trace_t* trace, const uint8_t byte) {
+    const uint16_t halves = manchester_encode_byte(byte);
+    for (int bit = 15; bit >= 0; --bit) {
+        trace->halves[trace->count++] = halves >> bit & 1;
+    }
+}
+
+static int trace_level(const trace_t* trace, const double t_us) {
+    const int half = (int)(t_us / trace->half_us);
+    if (half >= trace->count) {
+        return 0;
+    }
+    if (half == trace->glitch_half) {
+        const double offset = t_us - half * trace->half_us;
+        if (offset >= trace->half_us / 4 && offset < trace->half_us / 2) {
+            return !trace->halves[half];
+        }
+    }
+    return trace->halves[half];
+}
+
+// Прогон метки через rate_marker_feed() с шагом отсчётов в 1/step_div полупериода и оценка скорости в пределах min..max
+static int trace_estimate(const trace_t* trace, const int step_div, const int min_frequency, const int max_frequency) {
+    const int step_us = trace->half_us / step_div > 1 ? (int)(trace->half_us / step_div) : 1;
+    const int jitter_us = step_us / 2;
+    // Время линии в мкс от начала паузы; отсчёты приёмника идут в его целых микросекундах
+    const int64_t start_us = 1000000;
+    rate_marker_t marker;
+    int64_t now = 0;
+    rate_marker_start(&marker, THRESHOLD, LOW_RAW + (int)(NOISE_SD * test_gaussian()));
+    while (now < (trace->count + PAUSE_HALVES) * trace->half_us) {
+        now += step_us + (jitter_us ? test_rng() % (jitter_us + 1) : 0);
+        const int raw = (trace_level(trace, now) ? HIGH_RAW : LOW_RAW) + (int)(NOISE_SD * test_gaussian());
+        if (rate_marker_feed(&marker, start_us + now, raw)) {
+            break;
+        }
+    }
+    return rate_marker_estimate(&marker, min_frequency, max_frequency);
+}
+
+// Метка на каждой стандартной скорости с уходом часов передатчика до 4%: оценка приводится к стандартной
+static void test_standard_rates(void) {
+    for (int r = 0; r < STANDARD_COUNT; ++r) {
+        for (int trial = 0; trial < 32; ++trial) {
+            const double drift = (test_uniform() - 0.5) * 0.08;
+            trace_t trace;
+            trace_init(&trace, standard_rates[r] * (1 + drift));
+            trace_byte(&trace, RATE_MARKER);
+            trace_byte(&trace, test_rng());
+            CHECK_EQ(trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, standard_rates[STANDARD_COUNT - 1]), standard_rates[r]);
+        }
+    }
+}
+
+// Нестандартная скорость дальше RATE_SNAP_PCT от стандартных возвращается измеренной
+static void test_measured_rate(void) {
+    for (int trial = 0; trial < 16; ++trial) {
+        trace_t trace;
+        trace_init(&trace, 3000);
+        trace_byte(&trace, RATE_MARKER);
+        const int rate = trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, 10000);
+        CHECK(rate >= 2940 && rate <= 3060);
+    }
+}
+
+// Скорость вне min..max больше чем на RATE_SNAP_PCT - не метка
+static void test_out_of_range(void) {
+    trace_t trace;
+    trace_init(&trace, 10000);
+    trace_byte(&trace, RATE_MARKER);
+    CHECK_EQ(trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, 5000), 0);
+    CHECK_EQ(trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, 10000), 10000);
+    trace_init(&trace, 1000);
+    trace_byte(&trace, RATE_MARKER);
+    CHECK_EQ(trace_estimate(&trace, 8, 2000, 10000), 0);
+    CHECK_EQ(trace_estimate(&trace, 8, 1000, 10000), 1000);
+}
+
+// Искажённая метка: другой байт, выброс внутри полубита, оборванная метка. 0xAA и 0x55 не проверяются:
+// их сдвоенные полубиты с данными после них похожи на метку на скорости в 1.4 раза ниже
+static void test_malformed(void) {
+    static const uint8_t bytes[] = {0x00, 0xFF, 0xF8, 0xE0, 0x70, 0xF1, 0x78};
+    for (unsigned i = 0; i < sizeof(bytes) / sizeof(bytes[0]); ++i) {
+        for (int trial = 0; trial < 16; ++trial) {
+            trace_t trace;
+            trace_init(&trace, 2000);
+            trace_byte(&trace, bytes[i]);
+            trace_byte(&trace, test_rng());
+            CHECK_EQ(trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, 500000), 0);
+        }
+    }
+    // Выброс в любом полубите до последнего фронта метки. Отсчёты чаще: выброс, короткий для шага отсчётов,
+    // неотличим от фронта
+    for (int half = 0; half < 15; ++half) {
+        trace_t trace;
+        trace_init(&trace, 2000);
+        trace_byte(&trace, RATE_MARKER);
+        trace_byte(&trace, test_rng());
+        trace.glitch_half = PAUSE_HALVES + half;
+        CHECK_EQ(trace_estimate(&trace, 32, RATE_AUTO_MIN_FREQ, 500000), 0);
+    }
+    trace_t trace;
+    trace_init(&trace, 2000);
+    trace_byte(&trace, RATE_MARKER);
+    trace.count -= 6;
+    CHECK_EQ(trace_estimate(&trace, 8, RATE_AUTO_MIN_FREQ, 500000), 0);
+}
+
+int main(void) {
+    test_seed(17);
+    test_standard_rates();
+    test_measured_rate();
+    test_out_of_range();
+    test_malformed();
+    printf("rates: ok\n");
+    return 0;
+}
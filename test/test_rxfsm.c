@@ -0,0 +1,401 @@
+#include <math.h>
+#include <string.h>
+
+#include "manchester.h"
+#include "rxfsm.h"
+#include "test.h"
+
+// Непрерывный приёмник на модели линии: передатчик - расписание уровней, АЦП - отсчёт уровня с шумом.
+// Отсчёт занимает ADC_US плюс пауза автомата, в покое задача приёма спит тик FreeRTOS, как в receiver.c
+
+#define THRESHOLD 800
+#define HIGH_RAW 1500
+#define LOW_RAW 100
+#define NOISE_SD 30
+#define ADC_US 10
+#define TICK_US 10000
+#define SYNC_HALF_US 20000
+#define FRAME_LEN 32
+#define MAX_EDGES 65536
+#define MAX_FRAMES 32
+#define SPIKE_RAW 800
+#define GLITCH_US 20
+
+static const int rates[] = {500, 1000, 2000, 5000, 10000};
+
+// Расписание передатчика: уровень level с момента edge_us[i]
+static int64_t edge_us[MAX_EDGES];
+static int edge_level[MAX_EDGES];
+static int edge_count;
+static int64_t line_end;
+
+static uint8_t sent[MAX_FRAMES][FRAME_LEN];
+static int sent_count;
+
+// Канал: шум АЦП, постоянная времени фотоприёмника (однополюсный ФНЧ) и импульсные помехи раз в spike_every отсчётов.
+// Помехи идут только по данным последнего кадра: метку оба режима приёма ищут одинаково
+static int noise_sd = NOISE_SD;
+static double tau_us = 0;
+static int spike_every = 0;
+static int64_t data_start;
+
+static void line_channel(const int sd, const double tau, const int spikes) {
+    noise_sd = sd;
+    tau_us = tau;
+    spike_every = spikes;
+}
+
+static void line_reset(void) {
+    edge_count = 0;
+    line_end = 0;
+    sent_count = 0;
+}
+
+static void line_level(const int level, const int64_t duration_us) {
+    CHECK(edge_count < MAX_EDGES);
+    edge_us[edge_count] = line_end;
+    edge_level[edge_count] = level;
+    ++edge_count;
+    line_end += duration_us;
+}
+
+static void line_byte(const uint8_t byte, const int frequency) {
+    const uint16_t halves = manchester_encode_byte(byte);
+    for (int bit = 15; bit >= 0; --bit) {
+        line_level(halves >> bit & 1, 500000 / frequency);
+    }
+}
+
+// Синхропоследовательность 1010101001010101 и пауза SYNC_TAIL_US до метки
+static void line_sync(void) {
+    for (int i = 0; i < 4; ++i) {
+        line_level(1, SYNC_HALF_US);
+        line_level(0, SYNC_HALF_US);
+    }
+    for (int i = 0; i < 4; ++i) {
+        line_level(0, SYNC_HALF_US);
+        line_level(1, SYNC_HALF_US);
+    }
+    line_level(0, 40000);
+}
+
+// Кадр как у передатчика: синхропоследовательность, метка скорости, данные; байты запоминаются для сверки
+static void line_frame(const int frequency) {
+    CHECK(sent_count < MAX_FRAMES);
+    line_sync();
+    line_byte(RATE_MARKER, frequency);
+    data_start = line_end;
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        sent[sent_count][i] = 32 + test_rng() % 95;
+        line_byte(sent[sent_count][i], frequency);
+    }
+    ++sent_count;
+}
+
+static void line_gap(const int64_t duration_us) {
+    line_level(0, duration_us);
+}
+
+// Результат прогона: кадры по порядку и время, проведённое в покое
+typedef struct {
+    uint8_t frames[MAX_FRAMES][FRAME_LEN];
+    int lengths[MAX_FRAMES];
+    int rates[MAX_FRAMES];
+    int count;
+    int64_t idle_us;
+    rxfsm_stats_t stats;
+} run_t;
+
+static run_t run;
+
+static void line_run(const rxfsm_config_t* config, const int with_output) {
+    static uint8_t output[2048];
+    rxfsm_t fsm;
+    rxfsm_init(&fsm, config);
+    rxfsm_set_output(&fsm, with_output ? output : NULL, sizeof(output));
+    memset(&run, 0, sizeof(run));
+
+    int edge = 0;
+    double filtered = LOW_RAW;
+    int64_t previous = 0;
+    const int64_t end = line_end + 200000;
+    for (int64_t now = 0; now < end;) {
+        while (edge + 1 < edge_count && edge_us[edge + 1] <= now) {
+            ++edge;
+        }
+        const int level = now < line_end && edge_level[edge];
+        const double target = level ? HIGH_RAW : LOW_RAW;
+        filtered = tau_us > 0 ? target + (filtered - target) * exp(-(now - previous) / tau_us) : target;
+        previous = now;
+        int raw = (int)(filtered + noise_sd * test_gaussian());
+        if (spike_every && now >= data_start && test_rng() % spike_every == 0) {
+            raw += test_rng() & 1 ? SPIKE_RAW : -SPIKE_RAW;
+        }
+        const int len = rxfsm_feed(&fsm, now, raw);
+        if (len >= 0) {
+            CHECK(run.count < MAX_FRAMES);
+            memcpy(run.frames[run.count], output, len < FRAME_LEN ? len : FRAME_LEN);
+            run.lengths[run.count] = len;
+            run.rates[run.count] = fsm.frame_rate;
+            ++run.count;
+            rxfsm_set_output(&fsm, with_output ? output : NULL, sizeof(output));
+        }
+        if (rxfsm_idle(&fsm, now)) {
+            now += TICK_US;
+            run.idle_us += TICK_US;
+        } else {
+            now += ADC_US + rxfsm_sample_delay_us(&fsm);
+        }
+    }
+    run.stats = fsm.stats;
+}
+
+static void check_all_received(void) {
+    CHECK_EQ(run.count, sent_count);
+    for (int i = 0; i < sent_count; ++i) {
+        CHECK_EQ(run.lengths[i], FRAME_LEN);
+        CHECK(memcmp(run.frames[i], sent[i], FRAME_LEN) == 0);
+    }
+}
+
+static rxfsm_config_t fixed_rate(const int frequency, eq_t* eq) {
+    const rxfsm_config_t config = {THRESHOLD, frequency, 0, 0, eq};
+    return config;
+}
+
+// Ошибочные биты кадров прогона; непринятый кадр - все биты
+static int bit_errors(void) {
+    int errors = 0;
+    for (int i = 0; i < sent_count; ++i) {
+        for (int j = 0; j < FRAME_LEN; ++j) {
+            const uint8_t got = i < run.count && j < run.lengths[i] ? run.frames[i][j] : ~sent[i][j];
+            errors += __builtin_popcount(got ^ sent[i][j]);
+        }
+    }
+    return errors;
+}
+
+// Одиночный кадр на каждой скорости: поиск, метка, данные; с эквалайзером - ещё и обучение в паузе,
+// с интегрированием - полубиты по окнам
+static void test_single_frame(void) {
+    static eq_t eq;
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        for (int mode = 0; mode < 3; ++mode) {
+            line_reset();
+            line_gap(100000);
+            line_frame(rates[r]);
+            eq_reset(&eq);
+            rxfsm_config_t config = fixed_rate(rates[r], mode == 1 ? &eq : NULL);
+            config.integrate = mode == 2;
+            line_run(&config, 1);
+            check_all_received();
+            CHECK_EQ(run.rates[0], rates[r]);
+            CHECK_EQ(run.stats.frames, 1);
+            CHECK_EQ(run.stats.marker_losses, 0);
+            CHECK_EQ(run.stats.invalid_pairs, 0);
+        }
+    }
+}
+
+// Кадры вплотную друг к другу: следующая синхропоследовательность сразу за тишиной, завершившей кадр
+static void test_back_to_back(void) {
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        line_reset();
+        for (int i = 0; i < 8; ++i) {
+            line_frame(rates[r]);
+            line_gap(get_rate_timing(rates[r]).max_delay_period_us + 1000);
+        }
+        const rxfsm_config_t config = fixed_rate(rates[r], NULL);
+        line_run(&config, 1);
+        check_all_received();
+    }
+}
+
+// Паузы между кадрами: задача спит в покое и не теряет начало следующей синхропоследовательности
+static void test_idle_gaps(void) {
+    line_reset();
+    for (int i = 0; i < 16; ++i) {
+        line_gap(RXFSM_IDLE_US + test_rng() % 500000);
+        line_frame(rates[i % 5]);
+    }
+    const rxfsm_config_t config = {THRESHOLD, 0, 10000, 0, NULL};
+    line_run(&config, 1);
+    check_all_received();
+    for (int i = 0; i < sent_count; ++i) {
+        CHECK_EQ(run.rates[i], rates[i % 5]);
+    }
+    // Больше половины пауз проходит во сне
+    CHECK(run.idle_us > 16 * RXFSM_IDLE_US / 2);
+}
+
+// Покой: шум ниже порога не будит задачу, отсчёт выше порога - сразу будит
+static void test_idle_rule(void) {
+    const rxfsm_config_t config = fixed_rate(1000, NULL);
+    rxfsm_t fsm;
+    rxfsm_init(&fsm, &config);
+    CHECK(!rxfsm_idle(&fsm, 0));
+    rxfsm_feed(&fsm, 0, LOW_RAW);
+    CHECK(rxfsm_idle(&fsm, 10));
+    rxfsm_feed(&fsm, 10, HIGH_RAW);
+    CHECK(!rxfsm_idle(&fsm, 20));
+    // Смена уровня: до RXFSM_IDLE_US ждётся следующий бит синхропоследовательности
+    int64_t now = 20;
+    while (fsm.sync_level != 1) {
+        now += ADC_US;
+        rxfsm_feed(&fsm, now, HIGH_RAW);
+    }
+    rxfsm_feed(&fsm, now + ADC_US, HIGH_RAW);
+    CHECK(!rxfsm_idle(&fsm, now + RXFSM_SYNC_MAX_STABLE_US));
+    CHECK(rxfsm_idle(&fsm, now + RXFSM_IDLE_US + 1));
+    rxfsm_feed(&fsm, now + RXFSM_IDLE_US + 1, LOW_RAW);
+    CHECK(!rxfsm_idle(&fsm, now + RXFSM_IDLE_US + 2));
+}
+
+// Ложная синхронизация: случайные переключения и синхропоследовательность без метки не дают кадра,
+// а следующий нормальный кадр принимается
+static void test_false_sync(void) {
+    for (int autorate = 0; autorate <= 1; ++autorate) {
+        line_reset();
+        for (int i = 0; i < 200; ++i) {
+            line_level(test_rng() & 1, SYNC_HALF_US * (1 + test_rng() % 2));
+        }
+        line_gap(1000000);
+        // Синхропоследовательность, за которой линия молчит
+        line_sync();
+        line_gap(1000000);
+        // Синхропоследовательность с оборванной меткой
+        line_sync();
+        for (int i = 0; i < 3; ++i) {
+            line_level(1, 500);
+            line_level(0, 500);
+        }
+        line_gap(1000000);
+        line_frame(2000);
+        const rxfsm_config_t config = {THRESHOLD, 2000, autorate ? 10000 : 0, 0, NULL};
+        line_run(&config, 1);
+        check_all_received();
+        CHECK(run.stats.marker_losses >= 2);
+    }
+}
+
+// Синхропоследовательность без двойного низкого полубита или с недостающим битом не принимается:
+// автомат остаётся в поиске и ловит следующий кадр
+static void test_broken_sync(void) {
+    for (int broken = 0; broken < 2; ++broken) {
+        line_reset();
+        line_gap(100000);
+        for (int i = 0; i < 4; ++i) {
+            line_level(1, SYNC_HALF_US);
+            line_level(0, SYNC_HALF_US);
+        }
+        line_level(1, SYNC_HALF_US);
+        for (int i = 0; i < 3 - broken; ++i) {
+            line_level(0, SYNC_HALF_US);
+            line_level(1, SYNC_HALF_US);
+        }
+        line_gap(1000000);
+        line_frame(1000);
+        const rxfsm_config_t config = fixed_rate(1000, NULL);
+        line_run(&config, 1);
+        check_all_received();
+        CHECK_EQ(run.stats.marker_losses, 0);
+    }
+}
+
+// Без буфера кадр демодулируется до конца, байты отбрасываются
+static void test_no_output(void) {
+    line_reset();
+    line_frame(5000);
+    const rxfsm_config_t config = fixed_rate(5000, NULL);
+    line_run(&config, 0);
+    CHECK_EQ(run.count, 1);
+    CHECK_EQ(run.lengths[0], 0);
+    CHECK_EQ(run.stats.frames, 1);
+    CHECK_EQ(run.stats.pairs, FRAME_LEN * 8);
+}
+
+// Короткая помеха посреди каждого полубита данных, в том числе в обеих половинах сдвоенных участков 0x33
+static void line_glitched_frame(const int frequency) {
+    const int half_us = 500000 / frequency;
+    line_sync();
+    line_byte(RATE_MARKER, frequency);
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        sent[sent_count][i] = 0x33;
+        const uint16_t halves = manchester_encode_byte(0x33);
+        for (int bit = 15; bit >= 0; --bit) {
+            const int level = halves >> bit & 1;
+            line_level(level, half_us / 2 - GLITCH_US / 2);
+            line_level(!level, GLITCH_US);
+            line_level(level, half_us - half_us / 2 - GLITCH_US / 2);
+        }
+    }
+    ++sent_count;
+}
+
+// Интегрирование: помеха внутри окна не добавляет полубитов, сдвоенный участок делится по полупериоду.
+// Без интегрирования каждая помеха - два лишних фронта
+static void test_integrate_glitches(void) {
+    for (int frequency = 1000; frequency <= 2000; frequency += 1000) {
+        for (int integrate = 0; integrate <= 1; ++integrate) {
+            line_reset();
+            line_gap(100000);
+            line_glitched_frame(frequency);
+            const rxfsm_config_t config = {THRESHOLD, frequency, 0, integrate, NULL};
+            line_run(&config, 1);
+            if (integrate) {
+                check_all_received();
+                CHECK_EQ(run.stats.invalid_pairs, 0);
+            } else {
+                CHECK(bit_errors() > 0);
+            }
+        }
+    }
+}
+
+// Один и тот же зашумлённый сигнал с интегрированием и без: интегрирование даёт меньше ошибочных бит
+static void test_integrate_ber(void) {
+    static const struct {
+        int frequency;
+        int sd;
+        double tau;
+        int spikes;
+    } channels[] = {
+        {1000, 150, 30, 0},
+        {5000, 150, 30, 0},
+        {1000, 100, 0, 1000},
+        {5000, 100, 0, 1000},
+    };
+    for (unsigned c = 0; c < sizeof(channels) / sizeof(channels[0]); ++c) {
+        line_channel(channels[c].sd, channels[c].tau, channels[c].spikes);
+        int errors[2] = {0, 0};
+        for (int trial = 0; trial < 24; ++trial) {
+            line_reset();
+            line_gap(100000);
+            line_frame(channels[c].frequency);
+            for (int integrate = 0; integrate <= 1; ++integrate) {
+                test_seed(1000 + c * 100 + trial);
+                const rxfsm_config_t config = {THRESHOLD, channels[c].frequency, 0, integrate, NULL};
+                line_run(&config, 1);
+                errors[integrate] += bit_errors();
+            }
+        }
+        CHECK(errors[0] > 0);
+        CHECK(errors[1] * 4 < errors[0] * 3);
+    }
+    line_channel(NOISE_SD, 0, 0);
+}
+
+int main(void) {
+    test_seed(11);
+    test_single_frame();
+    test_back_to_back();
+    test_idle_gaps();
+    test_idle_rule();
+    test_false_sync();
+    test_broken_sync();
+    test_no_output();
+    test_integrate_glitches();
+    test_integrate_ber();
+    printf("rxfsm: ok\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include "tdma.h"
+#include "test.h"
+#include "utils.h"
+
+static void test_frame_round_trip(void) {
+    uint8_t payload[TDMA_MAX_PAYLOAD];
+    for (int i = 0; i < TDMA_MAX_PAYLOAD; ++i) {
+        payload[i] = i * 7;
+    }
+    uint8_t frame[TDMA_MAX_FRAME + 4];
+    for (int len = 0; len <= TDMA_MAX_PAYLOAD; len += 40) {
+        const int frame_len = tdma_build_frame(frame, TDMA_TYPE_DATA, 3, TDMA_BROADCAST, payload, len);
+        CHECK_EQ(frame_len, TDMA_HEADER_SIZE + len + TDMA_CRC_SIZE);
+        tdma_frame_t parsed;
+        CHECK_EQ(tdma_parse_frame(frame, frame_len, &parsed), 1);
+        CHECK_EQ(parsed.type, TDMA_TYPE_DATA);
+        CHECK_EQ(parsed.src, 3);
+        CHECK_EQ(parsed.dst, TDMA_BROADCAST);
+        CHECK_EQ(parsed.len, len);
+        CHECK(memcmp(parsed.payload, payload, len) == 0);
+        // Хвост после CRC (шум до конца приёма) не мешает разбору
+        CHECK_EQ(tdma_parse_frame(frame, frame_len + 3, &parsed), 1);
+    }
+}
+
+static void test_frame_rejects_damage(void) {
+    const uint8_t payload[] = "slot data";
+    uint8_t frame[TDMA_MAX_FRAME];
+    const int frame_len = tdma_build_frame(frame, TDMA_TYPE_DATA, 1, 2, payload, sizeof(payload));
+    tdma_frame_t parsed;
+
+    // Любой искажённый бит, в том числе в CRC
+    for (int bit = 0; bit < frame_len * 8; ++bit) {
+        frame[bit / 8] ^= 1 << (bit % 8);
+        CHECK_EQ(tdma_parse_frame(frame, frame_len, &parsed), 0);
+        frame[bit / 8] ^= 1 << (bit % 8);
+    }
+    CHECK_EQ(tdma_parse_frame(frame, frame_len, &parsed), 1);
+
+    // Обрезанный кадр: длина из заголовка больше принятого
+    for (int len = 0; len < frame_len; ++len) {
+        CHECK_EQ(tdma_parse_frame(frame, len, &parsed), 0);
+    }
+
+    // Длина в заголовке больше TDMA_MAX_PAYLOAD даже при верном CRC
+    static uint8_t big[TDMA_HEADER_SIZE + 255 + TDMA_CRC_SIZE];
+    big[0] = TDMA_TYPE_DATA;
+    big[3] = TDMA_MAX_PAYLOAD + 1;
+    const uint16_t crc = crc16_ccitt(big, TDMA_HEADER_SIZE + TDMA_MAX_PAYLOAD + 1);
+    big[TDMA_HEADER_SIZE + TDMA_MAX_PAYLOAD + 1] = crc >> 8;
+    big[TDMA_HEADER_SIZE + TDMA_MAX_PAYLOAD + 2] = crc & 0xFF;
+    CHECK_EQ(tdma_parse_frame(big, sizeof(big), &parsed), 0);
+}
+
+static void test_beacon_round_trip(void) {
+    tdma_schedule_t schedule = {.seq = 42, .slot_us = 750000, .slots = 0};
+    for (int node = 10; node < 10 + TDMA_MAX_SLOTS; ++node) {
+        CHECK(tdma_assign(&schedule, node) > 0);
+    }
+    uint8_t frame[TDMA_MAX_FRAME];
+    const int frame_len = tdma_build_beacon(frame, 1, &schedule);
+    tdma_frame_t parsed;
+    CHECK_EQ(tdma_parse_frame(frame, frame_len, &parsed), 1);
+    tdma_schedule_t received;
+    CHECK_EQ(tdma_parse_beacon(&parsed, &received), 1);
+    CHECK_EQ(received.seq, 42);
+    CHECK_EQ(received.slot_us, 750000);
+    CHECK_EQ(received.slots, TDMA_MAX_SLOTS);
+    CHECK(memcmp(received.owners, schedule.owners, TDMA_MAX_SLOTS) == 0);
+}
+
+// Маяк из целого кадра с неверным содержимым
+static int parse_beacon_payload(const uint8_t type, const uint8_t* payload, const int len) {
+    uint8_t frame[TDMA_MAX_FRAME];
+    const int frame_len = tdma_build_frame(frame, type, 1, TDMA_BROADCAST, payload, len);
+    tdma_frame_t parsed;
+    CHECK_EQ(tdma_parse_frame(frame, frame_len, &parsed), 1);
+    tdma_schedule_t schedule;
+    return tdma_parse_beacon(&parsed, &schedule);
+}
+
+static void test_beacon_rejects_bad_payload(void) {
+    uint8_t payload[4 + TDMA_MAX_SLOTS + 1] = {1, 0x01, 0xF4, 2, 5, 6};
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_BEACON, payload, 6), 1);
+    // Не маяк
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_DATA, payload, 6), 0);
+    // Короче фиксированной части и несовпадение длины с числом слотов
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_BEACON, payload, 3), 0);
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_BEACON, payload, 5), 0);
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_BEACON, payload, 7), 0);
+    // Слотов больше TDMA_MAX_SLOTS
+    payload[3] = TDMA_MAX_SLOTS + 1;
+    CHECK_EQ(parse_beacon_payload(TDMA_TYPE_BEACON, payload, 4 + TDMA_MAX_SLOTS + 1), 0);
+}
+
+static void test_assign_and_timing(void) {
+    tdma_schedule_t schedule = {.seq = 0, .slot_us = 400000, .slots = 0};
+    CHECK_EQ(tdma_slot_of(&schedule, 7), -1);
+    CHECK_EQ(tdma_assign(&schedule, 7), 1);
+    CHECK_EQ(tdma_assign(&schedule, 9), 2);
+    // Повторный запрос получает тот же слот
+    CHECK_EQ(tdma_assign(&schedule, 7), 1);
+    CHECK_EQ(tdma_slot_of(&schedule, 9), 2);
+    for (int node = 20; schedule.slots < TDMA_MAX_SLOTS; ++node) {
+        CHECK(tdma_assign(&schedule, node) > 0);
+    }
+    CHECK_EQ(tdma_assign(&schedule, 99), -1);
+    CHECK_EQ(tdma_assign(&schedule, 9), 2);
+
+    CHECK_EQ(tdma_slot_offset_us(&schedule, 0), 0);
+    CHECK_EQ(tdma_slot_offset_us(&schedule, 3), 1200000);
+    CHECK_EQ(tdma_superframe_us(&schedule), (TDMA_MAX_SLOTS + 1) * 400000LL);
+}
+
+static void test_slot_capacity(void) {
+    tdma_schedule_t schedule = {.seq = 0, .slot_us = 500000, .slots = 2};
+    // 460 мс эфира на 1000 бит/с - 57 байт, без заголовка и CRC - 51
+    CHECK_EQ(tdma_slot_capacity(&schedule, 1000, 0, 0), 51);
+
+    // Кадр полной ёмкости укладывается в слот вместе с преамбулой и тишиной
+    static const int frequencies[] = {100, 500, 1000, 2000, 5000};
+    for (int f = 0; f < 5; ++f) {
+        const int64_t preamble_us = 380000 / (frequencies[f] >= 1000 ? 10 : 1);
+        const int64_t silence_us = 10 * 500000 / frequencies[f];
+        schedule.slot_us = 1000000;
+        const int capacity = tdma_slot_capacity(&schedule, frequencies[f], preamble_us, silence_us);
+        CHECK(capacity >= 0);
+        CHECK(capacity <= TDMA_MAX_PAYLOAD);
+        if (capacity > 0 && capacity < TDMA_MAX_PAYLOAD) {
+            const int64_t frame_us = (int64_t)(capacity + TDMA_HEADER_SIZE + TDMA_CRC_SIZE) * 8 * 1000000 / frequencies[f];
+            CHECK(2 * TDMA_GUARD_US + preamble_us + frame_us + silence_us <= schedule.slot_us);
+            // Байтом больше уже не помещается
+            CHECK(2 * TDMA_GUARD_US + preamble_us + frame_us + 8 * 1000000 / frequencies[f] + silence_us >
+                  schedule.slot_us);
+        }
+    }
+
+    // Слот короче защитных интервалов, преамбула на весь слот, заголовок не помещается, потолок нагрузки
+    schedule.slot_us = 2 * TDMA_GUARD_US;
+    CHECK_EQ(tdma_slot_capacity(&schedule, 1000, 0, 0), 0);
+    schedule.slot_us = 500000;
+    CHECK_EQ(tdma_slot_capacity(&schedule, 1000, 500000, 0), 0);
+    CHECK_EQ(tdma_slot_capacity(&schedule, 100, 0, 0), 0);
+    CHECK_EQ(tdma_slot_capacity(&schedule, 1000000, 0, 0), TDMA_MAX_PAYLOAD);
+}
+
+int main(void) {
+    test_frame_round_trip();
+    test_frame_rejects_damage();
+    test_beacon_round_trip();
+    test_beacon_rejects_bad_payload();
+    test_assign_and_timing();
+    test_slot_capacity();
+    printf("tdma: ok\n");
+    return 0;
+}